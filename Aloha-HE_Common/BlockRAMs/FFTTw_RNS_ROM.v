@@ -1,250 +1,92 @@
 `timescale 1ns / 1ps
 
+// Constants cache: twiddle factor cache of FFT and NTT and the RNS constants.
+// It is initialized with TwFctrCache_RNSConsts.mem and port A allows to
+// overwrite it at runtime (64-bit halves of the 128-bit lines, the lower half
+// at the even address), e.g., with the output of Aloha-HE_Host/genConstants.c.
+// The lower half is held in a register until the upper half arrives, so a line
+// is written as a whole and the BRAM has the same width on both ports. This
+// keeps the initialization file in 128-bit lines (an asymmetric BRAM reads it
+// at the narrower width). Both halves of a line must be written in this order.
 module FFTTw_RNS_ROM #(
 //    parameter LOGN = 13,
     parameter WORD_SIZE = 128
   )
   (
     clka,
+    wea,
     addra,
-    douta
+    dina,
+    addrb,
+    doutb
   );
 
   
   localparam LOG_DEPTH = 10;
+  localparam WRITE_WIDTH = 64;
+  localparam LOG_WRITE_DEPTH = LOG_DEPTH + $clog2(WORD_SIZE/WRITE_WIDTH);
 
   input clka;
-  input [LOG_DEPTH-1:0] addra;
-  output [WORD_SIZE-1:0] douta;
+  input wea;
+  input [LOG_WRITE_DEPTH-1:0] addra;
+  input [WRITE_WIDTH-1:0] dina;
+  input [LOG_DEPTH-1:0] addrb;
+  output [WORD_SIZE-1:0] doutb;
 
-  // XPM_MEMORY instantiation template for Single Port ROM configurations
-// Refer to the targeted device family architecture libraries guide for XPM_MEMORY documentation
-// =======================================================================================================================
+  reg [WRITE_WIDTH-1:0] dina_low;
+  always @(posedge clka)
+    if(wea && ~addra[0])
+      dina_low <= dina;
 
-// Parameter usage table, organized as follows:
-// +---------------------------------------------------------------------------------------------------------------------+
-// | Parameter name       | Data type          | Restrictions, if applicable                                             |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Description                                                                                                         |
-// +---------------------------------------------------------------------------------------------------------------------+
-// +---------------------------------------------------------------------------------------------------------------------+
-// | ADDR_WIDTH_A         | Integer            | Range: 1 - 20. Default value = 6.                                       |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify the width of the port A address port addra, in bits.                                                        |
-// | Must be large enough to access the entire memory from port A, i.e. = $clog2(MEMORY_SIZE/READ_DATA_WIDTH_A).         |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | AUTO_SLEEP_TIME      | Integer            | Range: 0 - 15. Default value = 0.                                       |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Must be set to 0                                                                                                    |
-// | 0 - Disable auto-sleep feature                                                                                      |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | CASCADE_HEIGHT       | Integer            | Range: 0 - 64. Default value = 0.                                       |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | 0- No Cascade Height, Allow Vivado Synthesis to choose.                                                             |
-// | 1 or more - Vivado Synthesis sets the specified value as Cascade Height.                                            |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | ECC_MODE             | String             | Allowed values: no_ecc, both_encode_and_decode, decode_only, encode_only. Default value = no_ecc.|
-// |---------------------------------------------------------------------------------------------------------------------|
-// |                                                                                                                     |
-// |   "no_ecc" - Disables ECC                                                                                           |
-// |   "encode_only" - Enables ECC Encoder only                                                                          |
-// |   "decode_only" - Enables ECC Decoder only                                                                          |
-// |   "both_encode_and_decode" - Enables both ECC Encoder and Decoder                                                   |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | MEMORY_INIT_FILE     | String             | Default value = none.                                                   |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify "none" (including quotes) for no memory initialization, or specify the name of a memory initialization file-|
-// | Enter only the name of the file with .mem extension, including quotes but without path (e.g. "my_file.mem").        |
-// | File format must be ASCII and consist of only hexadecimal values organized into the specified depth by              |
-// | narrowest data width generic value of the memory. See the Memory File (MEM) section for more                        |
-// | information on the syntax. Initialization of memory happens through the file name specified only when parameter     |
-// | MEMORY_INIT_PARAM value is equal to "".                                                                             |
-// | When using XPM_MEMORY in a project, add the specified file to the Vivado project as a design source.                |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | MEMORY_INIT_PARAM    | String             | Default value = 0.                                                      |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify "" or "0" (including quotes) for no memory initialization through parameter, or specify the string          |
-// | containing the hex characters. Enter only hex characters with each location separated by delimiter (,).             |
-// | Parameter format must be ASCII and consist of only hexadecimal values organized into the specified depth by         |
-// | narrowest data width generic value of the memory.For example, if the narrowest data width is 8, and the depth of    |
-// | memory is 8 locations, then the parameter value should be passed as shown below.                                    |
-// | parameter MEMORY_INIT_PARAM = "AB,CD,EF,1,2,34,56,78"                                                               |
-// | Where "AB" is the 0th location and "78" is the 7th location.                                                        |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | MEMORY_OPTIMIZATION  | String             | Allowed values: true, false. Default value = true.                      |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify "true" to enable the optimization of unused memory or bits in the memory structure. Specify "false" to      |
-// | disable the optimization of unused memory or bits in the memory structure.                                          |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | MEMORY_PRIMITIVE     | String             | Allowed values: auto, block, distributed, ultra. Default value = auto.  |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Designate the memory primitive (resource type) to use-                                                              |
-// | "auto"- Allow Vivado Synthesis to choose                                                                            |
-// | "distributed"- Distributed memory                                                                                   |
-// | "block"- Block memory                                                                                               |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | MEMORY_SIZE          | Integer            | Range: 2 - 150994944. Default value = 2048.                             |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify the total memory array size, in bits.                                                                       |
-// | For example, enter 65536 for a 2kx32 ROM.                                                                           |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | MESSAGE_CONTROL      | Integer            | Range: 0 - 1. Default value = 0.                                        |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify 1 to enable the dynamic message reporting such as collision warnings, and 0 to disable the message reporting|
-// +---------------------------------------------------------------------------------------------------------------------+
-// | READ_DATA_WIDTH_A    | Integer            | Range: 1 - 4608. Default value = 32.                                    |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify the width of the port A read data output port douta, in bits.                                               |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | READ_LATENCY_A       | Integer            | Range: 0 - 100. Default value = 2.                                      |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify the number of register stages in the port A read data pipeline. Read data output to port douta takes this   |
-// | number of clka cycles.                                                                                              |
-// | To target block memory, a value of 1 or larger is required- 1 causes use of memory latch only; 2 causes use of      |
-// | output register. To target distributed memory, a value of 0 or larger is required- 0 indicates combinatorial output.|
-// | Values larger than 2 synthesize additional flip-flops that are not retimed into memory primitives.                  |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | READ_RESET_VALUE_A   | String             | Default value = 0.                                                      |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify the reset value of the port A final output register stage in response to rsta input port is assertion.      |
-// | For example, to reset the value of port douta to all 0s when READ_DATA_WIDTH_A is 32, specify 32HHHHh0.             |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | RST_MODE_A           | String             | Allowed values: SYNC, ASYNC. Default value = SYNC.                      |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Describes the behaviour of the reset                                                                                |
-// |                                                                                                                     |
-// |   "SYNC" - when reset is applied, synchronously resets output port douta to the value specified by parameter READ_RESET_VALUE_A|
-// |   "ASYNC" - when reset is applied, asynchronously resets output port douta to zero                                  |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | SIM_ASSERT_CHK       | Integer            | Range: 0 - 1. Default value = 0.                                        |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | 0- Disable simulation message reporting. Messages related to potential misuse will not be reported.                 |
-// | 1- Enable simulation message reporting. Messages related to potential misuse will be reported.                      |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | USE_MEM_INIT         | Integer            | Range: 0 - 1. Default value = 1.                                        |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify 1 to enable the generation of below message and 0 to disable generation of the following message completely.|
-// | "INFO - MEMORY_INIT_FILE and MEMORY_INIT_PARAM together specifies no memory initialization.                         |
-// | Initial memory contents will be all 0s."                                                                            |
-// | NOTE: This message gets generated only when there is no Memory Initialization specified either through file or      |
-// | Parameter.                                                                                                          |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | WAKEUP_TIME          | String             | Allowed values: disable_sleep, use_sleep_pin. Default value = disable_sleep.|
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Specify "disable_sleep" to disable dynamic power saving option, and specify "use_sleep_pin" to enable the           |
-// | dynamic power saving option                                                                                         |
-// +---------------------------------------------------------------------------------------------------------------------+
+  wire wea_line;
+  assign wea_line = wea && addra[0];
+  wire [WORD_SIZE-1:0] dina_line;
+  assign dina_line = {dina, dina_low};
 
-// Port usage table, organized as follows:
-// +---------------------------------------------------------------------------------------------------------------------+
-// | Port name      | Direction | Size, in bits                         | Domain  | Sense       | Handling if unused     |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Description                                                                                                         |
-// +---------------------------------------------------------------------------------------------------------------------+
-// +---------------------------------------------------------------------------------------------------------------------+
-// | addra          | Input     | ADDR_WIDTH_A                          | clka    | NA          | Required               |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Address for port A read operations.                                                                                 |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | clka           | Input     | 1                                     | NA      | Rising edge | Required               |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Clock signal for port A.                                                                                            |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | dbiterra       | Output    | 1                                     | clka    | Active-high | DoNotCare              |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Leave open.                                                                                                         |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | douta          | Output    | READ_DATA_WIDTH_A                     | clka    | NA          | Required               |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Data output for port A read operations.                                                                             |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | ena            | Input     | 1                                     | clka    | Active-high | Required               |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Memory enable signal for port A.                                                                                    |
-// | Must be high on clock cycles when read operations are initiated. Pipelined internally.                              |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | injectdbiterra | Input     | 1                                     | clka    | Active-high | Tie to 1'b0            |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Do not change from the provided value.                                                                              |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | injectsbiterra | Input     | 1                                     | clka    | Active-high | Tie to 1'b0            |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Do not change from the provided value.                                                                              |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | regcea         | Input     | 1                                     | clka    | Active-high | Tie to 1'b1            |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Do not change from the provided value.                                                                              |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | rsta           | Input     | 1                                     | clka    | Active-high | Required               |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Reset signal for the final port A output register stage.                                                            |
-// | Synchronously resets output port douta to the value specified by parameter READ_RESET_VALUE_A.                      |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | sbiterra       | Output    | 1                                     | clka    | Active-high | DoNotCare              |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | Leave open.                                                                                                         |
-// +---------------------------------------------------------------------------------------------------------------------+
-// | sleep          | Input     | 1                                     | NA      | Active-high | Tie to 1'b0            |
-// |---------------------------------------------------------------------------------------------------------------------|
-// | sleep signal to enable the dynamic power saving feature.                                                            |
-// +---------------------------------------------------------------------------------------------------------------------+
-
-
-// xpm_memory_sprom : In order to incorporate this function into the design,
-//     Verilog      : the following instance declaration needs to be placed
-//     instance     : in the body of the design code.  The instance name
-//   declaration    : (xpm_memory_sprom_inst) and/or the port declarations within the
-//       code       : parenthesis may be changed to properly reference and
-//                  : connect this function to the design.  All inputs
-//                  : and outputs must be connected.
-
-//  Please reference the appropriate libraries guide for additional information on the XPM modules.
-
-//  <-----Cut code below this line---->
-
-   // xpm_memory_sprom: Single Port ROM
-   // Xilinx Parameterized Macro, version 2019.1
-
-  xpm_memory_sprom #(
-      .ADDR_WIDTH_A(LOG_DEPTH),              // DECIMAL
-      .AUTO_SLEEP_TIME(0),           // DECIMAL
-      .CASCADE_HEIGHT(0),            // DECIMAL
-      .ECC_MODE("no_ecc"),           // String
-      /*.MEMORY_INIT_FILE(LOGN == 14 ? "TwFctrCache_RNSConsts_14.mem" : 
-                        LOGN == 15 ? "TwFctrCache_RNSConsts_15.mem" : 
-                                     "TwFctrCache_RNSConsts_13.mem"),     // String*/
-      .MEMORY_INIT_FILE("TwFctrCache_RNSConsts.mem"),
-      .MEMORY_INIT_PARAM(""),       // String
-      .MEMORY_OPTIMIZATION("true"),  // String
-      .MEMORY_PRIMITIVE("block"),     // String
-      .MEMORY_SIZE((1<<LOG_DEPTH)*WORD_SIZE),            // DECIMAL
-      .MESSAGE_CONTROL(0),           // DECIMAL
-      .READ_DATA_WIDTH_A(WORD_SIZE),        // DECIMAL
-      .READ_LATENCY_A(2),            // DECIMAL
-      .READ_RESET_VALUE_A("0"),      // String
-      .RST_MODE_A("SYNC"),           // String
-      .SIM_ASSERT_CHK(0),            // DECIMAL; 0=disable simulation messages, 1=enable simulation messages
-      .USE_MEM_INIT(1),              // DECIMAL
-      .WAKEUP_TIME("disable_sleep")  // String
+  // For the parameters of xpm_memory_sdpram, see NTTPolyBank.v.
+  xpm_memory_sdpram #(
+      .ADDR_WIDTH_A(LOG_DEPTH),       // DECIMAL
+      .ADDR_WIDTH_B(LOG_DEPTH),       // DECIMAL
+      .AUTO_SLEEP_TIME(0),            // DECIMAL
+      .BYTE_WRITE_WIDTH_A(WORD_SIZE), // DECIMAL
+      .CASCADE_HEIGHT(0),             // DECIMAL
+      .CLOCKING_MODE("common_clock"), // String
+      .ECC_MODE("no_ecc"),            // String
+      .MEMORY_INIT_FILE("TwFctrCache_RNSConsts.mem"), // String
+      .MEMORY_INIT_PARAM(""),        // String
+      .MEMORY_OPTIMIZATION("true"),   // String
+      .MEMORY_PRIMITIVE("block"),      // String
+      .MEMORY_SIZE((1<<LOG_DEPTH)*WORD_SIZE), // DECIMAL
+      .MESSAGE_CONTROL(0),            // DECIMAL
+      .READ_DATA_WIDTH_B(WORD_SIZE),  // DECIMAL
+      .READ_LATENCY_B(2),             // DECIMAL
+      .READ_RESET_VALUE_B("0"),       // String
+      .RST_MODE_A("SYNC"),            // String
+      .RST_MODE_B("SYNC"),            // String
+      .SIM_ASSERT_CHK(0),             // DECIMAL; 0=disable simulation messages, 1=enable simulation messages
+      .USE_EMBEDDED_CONSTRAINT(0),    // DECIMAL
+      .USE_MEM_INIT(1),               // DECIMAL
+      .WAKEUP_TIME("disable_sleep"),  // String
+      .WRITE_DATA_WIDTH_A(WORD_SIZE), // DECIMAL
+      .WRITE_MODE_B("read_first")     // String
    )
-   xpm_memory_sprom_inst (
-      .dbiterra(),             // 1-bit output: Leave open.
-      .douta(douta),                   // READ_DATA_WIDTH_A-bit output: Data output for port A read operations.
-      .sbiterra(),             // 1-bit output: Leave open.
-      .addra(addra),                   // ADDR_WIDTH_A-bit input: Address for port A read operations.
-      .clka(clka),                     // 1-bit input: Clock signal for port A.
-      .ena(1'd1),                       // 1-bit input: Memory enable signal for port A. Must be high on clock
-                                       // cycles when read operations are initiated. Pipelined internally.
-
+   xpm_memory_sdpram_inst (
+      .dbiterrb(),             // 1-bit output: Leave open.
+      .doutb(doutb),                   // READ_DATA_WIDTH_B-bit output: Data output for port B read operations.
+      .sbiterrb(),             // 1-bit output: Leave open.
+      .addra(addra[LOG_WRITE_DEPTH-1:1]), // ADDR_WIDTH_A-bit input: Address for port A write operations.
+      .addrb(addrb),                   // ADDR_WIDTH_B-bit input: Address for port B read operations.
+      .clka(clka),                     // 1-bit input: Clock signal for port A and port B (common_clock).
+      .clkb(clka),                     // 1-bit input: Unused with common_clock.
+      .dina(dina_line),                // WRITE_DATA_WIDTH_A-bit input: Data input for port A write operations.
+      .ena(1'd1),                       // 1-bit input: Memory enable signal for port A.
+      .enb(1'd1),                       // 1-bit input: Memory enable signal for port B.
       .injectdbiterra(1'd0), // 1-bit input: Do not change from the provided value.
       .injectsbiterra(1'd0), // 1-bit input: Do not change from the provided value.
-      .regcea(1'd1),                 // 1-bit input: Do not change from the provided value.
-      .rsta(1'd0),                     // 1-bit input: Reset signal for the final port A output register stage.
-                                       // Synchronously resets output port douta to the value specified by
-                                       // parameter READ_RESET_VALUE_A.
-
-      .sleep(1'd0)                    // 1-bit input: sleep signal to enable the dynamic power saving feature.
+      .regceb(1'd1),                 // 1-bit input: Clock Enable for the last register stage on the output data path.
+      .rstb(1'd0),                     // 1-bit input: Reset signal for the final port B output register stage.
+      .sleep(1'd0),                   // 1-bit input: sleep signal to enable the dynamic power saving feature.
+      .wea(wea_line)                   // WRITE_DATA_WIDTH_A/BYTE_WRITE_WIDTH_A-bit input: Write enable vector for port A.
    );
 
-   // End of xpm_memory_sprom_inst instantiation
-endmodule				
\ No newline at end of file
+endmodule
@@ -1,11 +1,49 @@
-
-// IEEE 754 double precision:
-`define SIGNIFICANT_BITS 52
-`define EXPONENT_BITS 11
-`define OVERALL_BITS 64
-`define EXPONENT_BIAS 11'd1023
-
-// Latencies:
-`define DELAY_FLP_MULT 7
-`define DELAY_FLP_ADDER 7
-`define DELAY_COMPLEX_MULT (`DELAY_FLP_ADDER + `DELAY_FLP_MULT)
\ No newline at end of file
+
+// IEEE 754 double precision:
+`define SIGNIFICANT_BITS 52
+`define EXPONENT_BITS 11
+`define OVERALL_BITS 64
+`define EXPONENT_BIAS 11'd1023
+
+// Plaintext formats of the Complex BRAM DMA (control_low_word[21:20]). Except
+// for double, a 64-bit word holds one complex value {imag[63:32], real[31:0]}.
+`define PT_FORMAT_DOUBLE  2'd0
+`define PT_FORMAT_FLOAT32 2'd1 // IEEE-754 single precision
+`define PT_FORMAT_FIXED32 2'd2 // two's complement with control_low_word[26:22] fractional bits
+
+// The key BRAM (Modular Ring BRAM 3) holds 2^KEY_STORE_LOG_POLYS polynomials
+// of 2^15 coefficients (KEY_STORE_LOG_POLYS at most 2). The regions beyond the first N coefficients
+// keep pk0 residues across encryptions (see pk0_region in ComputeCore.v).
+// It must comply with software (see communication.h).
+`ifndef KEY_STORE_LOG_POLYS
+`define KEY_STORE_LOG_POLYS 0
+`endif
+
+// Additional pipeline stages of the arithmetic units. They are added at the
+// outputs and moved into the logic by register retiming. Define them globally
+// (e.g., verilog_define of the Vivado fileset) to deepen the pipelines.
+`ifndef INT_MULT_EXTRA_STAGES
+`define INT_MULT_EXTRA_STAGES 0  // IntMultiplier_54x54
+`endif
+`ifndef MONT_RED_EXTRA_STAGES
+`define MONT_RED_EXTRA_STAGES 0  // MontRed_Stage chain
+`endif
+`ifndef FLP_MULT_EXTRA_STAGES
+`define FLP_MULT_EXTRA_STAGES 0  // FLPMultiplier without integer multiplier
+`endif
+`ifndef FLP_ADDER_EXTRA_STAGES
+`define FLP_ADDER_EXTRA_STAGES 0 // FLPAdder and FFTButterflyAddStage
+`endif
+
+// Latencies:
+`define DELAY_INT_MULT (5 + `INT_MULT_EXTRA_STAGES)  // result_low is valid one cycle earlier
+`define DELAY_MONT_RED (10 + `MONT_RED_EXTRA_STAGES) // from the full multiplication result
+`define DELAY_MOD_MULT (`DELAY_INT_MULT + `DELAY_MONT_RED)
+`define DELAY_FLP_MULT (2 + `DELAY_INT_MULT + `FLP_MULT_EXTRA_STAGES)
+`define DELAY_FLP_ADDER (7 + `FLP_ADDER_EXTRA_STAGES)
+`define DELAY_COMPLEX_MULT (`DELAY_FLP_ADDER + `DELAY_FLP_MULT)
+// The DIT transformation reads operand a DELAY_TRANSFORM_MULT+1 cycles after
+// operand b for both FFT and NTT. The faster multiplication of both butterflies
+// is padded to this latency (default: complex mult 14, modular mult 15).
+`define DELAY_TRANSFORM_MULT (`DELAY_COMPLEX_MULT > `DELAY_MOD_MULT-1 ? `DELAY_COMPLEX_MULT : `DELAY_MOD_MULT-1)
+`define DELAY_NTT_BF_MULT (`DELAY_TRANSFORM_MULT + 1)
\ No newline at end of file
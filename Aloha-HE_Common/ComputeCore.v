@@ -10,6 +10,12 @@ module ComputeCore(
           bram_sel, 
           current_n_expand, 
           grant_ext_io,
+          plaintext_format,
+          plaintext_frac_bits,
+          sparse_shift,
+          pk0_region,
+          key_page,
+          const_wr,
 
           // command signals:
 					command_in, 
@@ -46,6 +52,9 @@ module ComputeCore(
   localparam FLP_WORDSIZE = `OVERALL_BITS;
   localparam CONSTANTS_ROM_ADDR_WIDTH = 10;
 
+  // The key BRAM holds 2^KEY_STORE_LOG_POLYS polynomials of 2^LOGN coefficients
+  localparam KEY_LOGN = LOGN + `KEY_STORE_LOG_POLYS;
+
   localparam LOGQ = 54; // max bit-width of moduli
   localparam W = 24;    // word size
   localparam M = 17;    // bit-width of q_m
@@ -62,11 +71,14 @@ module ComputeCore(
   localparam FFT_BRAM_EXPAND_ID = 3'd6; // Complex BRAM with expand when writing to it
   localparam FFT_IM_BRAM_ID     = 3'd7; // "Imag BRAM" (imaginary parts of complex BRAM)
 
-  // BRAM IDs for DMA:
-  localparam DMA_MSG_BRAM_ID = 2'd0;
-  localparam DMA_KEY_BRAM_ID = 2'd1;
-  localparam DMA_V_BRAM_ID   = 2'd2;
-  localparam DMA_FFT_BRAM_ID = 2'd3;
+  // BRAM IDs for DMA (window of 2^LOGN words each, E1, Imag and Error are read-only):
+  localparam DMA_MSG_BRAM_ID   = 3'd0;
+  localparam DMA_KEY_BRAM_ID   = 3'd1;
+  localparam DMA_V_BRAM_ID     = 3'd2;
+  localparam DMA_FFT_BRAM_ID   = 3'd3;
+  localparam DMA_E1_BRAM_ID    = 3'd4;
+  localparam DMA_IM_BRAM_ID    = 3'd5;
+  localparam DMA_ERROR_BRAM_ID = 3'd6;
 
 
 
@@ -74,6 +86,12 @@ module ComputeCore(
   input [LOGN:0] address_ext;
   input [2:0] bram_sel;
   input [1:0] current_n_expand; // TODO: OPTIMIZATION: USE THIS TO SAVE DMA TRANSACTIONS
+  input [1:0] plaintext_format; // PT_FORMAT_* of Complex BRAM writes with expand and DMA reads
+  input [4:0] plaintext_frac_bits;
+  input [1:0] sparse_shift; // sparse packing: FFT, Expand and Project run on N>>sparse_shift
+  input [3:0] pk0_region;   // N-coefficient region of the key BRAM the PWM reads pk0 from
+  input [1:0] key_page;     // 2^15-coefficient page of the key BRAM for DMA and debug accesses
+  input const_wr;           // DMA writes go to the constants cache instead of the BRAMs
   input [63:0] dina_ext;
   input wea_ext;
 
@@ -83,16 +101,16 @@ module ComputeCore(
   output done_ins_computation; // This becomes 1 when the instruction has finished. 
 
   input [7:0] dma_bram_byte_wea;
-  input [LOGN+4:0] dma_bram_abs_addr;
+  input [LOGN+5:0] dma_bram_abs_addr;
   input [63:0] dina_dma;
   output [63:0] doutb_dma;
   input dma_bram_en;
 
   // DMA signals:
   wire wea_dma;
-  assign wea_dma = (dma_bram_byte_wea == 8'hff) && dma_bram_en;
-  wire [1:0] dma_bram_sel;
-  assign dma_bram_sel = dma_bram_abs_addr[LOGN+4:LOGN+3];
+  assign wea_dma = (dma_bram_byte_wea == 8'hff) && dma_bram_en && ~const_wr;
+  wire [2:0] dma_bram_sel;
+  assign dma_bram_sel = dma_bram_abs_addr[LOGN+5:LOGN+3];
   wire [LOGN-1:0] dma_rdwr_addr;
   assign dma_rdwr_addr = dma_bram_abs_addr[LOGN+2:3];
   wire grant_ext;
@@ -114,6 +132,14 @@ module ComputeCore(
       command_reg <= command_reg;	
   end
 
+  // command_we is a bit of the instruction word and hence held for the whole
+  // instruction: a new instruction is a rising edge or a changed command
+  reg command_we_1DP;
+  wire command_issue;
+  always @(posedge clk)
+    command_we_1DP <= rst ? 1'b0 : command_we;
+  assign command_issue = command_we && (~command_we_1DP || command_in != command_reg);
+
   // reset signals and instruction decoding:
   assign {OP4, OP3, OP2, OP1, opcode} = command_reg;	
 
@@ -122,23 +148,44 @@ module ComputeCore(
   wire i2f_rst, i2f_done;
   wire pwm_rst, pwm_done;
   wire prj_rst, prj_done;
-  assign prj_rst       = opcode==3'd5 ? 1'b0 : 1'b1;
-  assign pwm_rst       = opcode==3'd4 ? 1'b0 : 1'b1;
+  wire aut_rst, aut_done;
+  wire fuse_pwm, fuse_i2f, fuse_prj;
+  reg fused_pwm_phase;
+  assign prj_rst       = opcode==3'd5 || fuse_prj ? 1'b0 : 1'b1;
+  assign pwm_rst       = opcode==3'd4 || fused_pwm_phase ? 1'b0 : 1'b1;
   assign i2f_rst       = opcode==3'd3 ? 1'b0 : 1'b1;
+  assign aut_rst       = opcode==3'd6 ? 1'b0 : 1'b1;
   assign rns_rst       = opcode==3'd2 ? 1'b0 : 1'b1;
-  assign transform_rst = opcode==3'd1 ? 1'b0 : 1'b1;
+  assign transform_rst = (opcode==3'd1 && ~fused_pwm_phase) || fuse_i2f ? 1'b0 : 1'b1;
+  // fused INTT+I2F: I2F instruction with OP4[6] set, which runs the inverse NTT
+  // (constants {OP4[5], OP1[9:6]}) and converts its results on their write-back
+  assign fuse_i2f = opcode==3'd3 && OP4[6];
   // transform parameters general:
   wire do_fft, is_dif;
-  assign is_dif = OP1[0];
-  assign do_fft = OP1[1];
-  wire [1:0] current_n;
+  assign is_dif = fuse_i2f ? 1'b1 : OP1[0];
+  assign do_fft = fuse_i2f ? 1'b0 : OP1[1];
+  // fused NTT+PWM: the PWM of the encryption directly follows the forward NTT
+  // within the same instruction (saves the instruction turnaround)
+  assign fuse_pwm = opcode==3'd1 && OP4[0] && ~do_fft && ~is_dif;
+  // fused IFFT+Project: the last IFFT stage writes its results to the projected positions
+  assign fuse_prj = opcode==3'd1 && OP4[0] && do_fft && ~is_dif;
+  always @(posedge clk) begin
+    if(rst || command_issue)
+      fused_pwm_phase <= 1'b0;
+    else if(opcode==3'd1 && fuse_pwm && transformation_done)
+      fused_pwm_phase <= 1'b1;
+  end
+  wire [1:0] current_n, fft_current_n;
   assign current_n = OP4[8:7];
+  // sparse packing: the FFTs and Project run on the smaller ring, RNS spreads
+  // and I2F gathers the coefficients
+  assign fft_current_n = current_n - sparse_shift;
   // transform parameters ntt & i2f:
   wire [3:0] current_k;
   wire [M-1:0] qm;
   wire [4:0] constants_sel;
   assign current_k = OP1[5:2];
-  assign constants_sel = {OP3[7], OP1[9:6]}; // TODO: adapt software!
+  assign constants_sel = fuse_i2f ? {OP4[5], OP1[9:6]} : {OP3[7], OP1[9:6]}; // TODO: adapt software!
   assign qm = {OP3[6:0], OP2};
   // rns parameters:
   wire [3:0] modulus_select;
@@ -148,6 +195,12 @@ module ComputeCore(
   // i2f parameter:
   wire [`EXPONENT_BITS:0] scale_i2f;
   assign scale_i2f = {{3{scale[8]}}, scale[8:0]};
+  // automorphism parameters: Galois element k = 2*galois_half+1, OP1[0] selects
+  // the NTT domain (permutation) or the coefficient domain (with signs)
+  wire [LOGN-1:0] galois_half;
+  wire aut_ntt_domain;
+  assign galois_half = {OP4[6:0], OP1[9:6], OP3[9:7], OP1[1]};
+  assign aut_ntt_domain = OP1[0];
   // random sampling signals:
   wire random_sampling_rst;
   wire random_sampling_done;
@@ -157,7 +210,11 @@ module ComputeCore(
   assign random_sampling_seed = dina_ext;
   assign sample_errors = do_fft;
 
-  assign done_ins_computation = transformation_done | rns_done | i2f_done | pwm_done | prj_done;
+  // the error sampling of ring size N can outlast a sparse FFT:
+  wire sampling_busy;
+  assign sampling_busy = ~random_sampling_rst && sample_errors && ~random_sampling_done;
+
+  assign done_ins_computation = (transformation_done & ~fuse_pwm & ~fuse_prj & ~fuse_i2f & ~sampling_busy) | rns_done | i2f_done | pwm_done | prj_done | aut_done;
 
   /******************** HW-SW interfaces ***************/
 
@@ -217,6 +274,35 @@ module ComputeCore(
       real_part_dma <= dina_dma;
   end
 
+  // Packed plaintext formats: each word is one complex value, which is
+  // converted to doubles and expanded one cycle later.
+  wire plaintext_packed;
+  assign plaintext_packed = plaintext_format != `PT_FORMAT_DOUBLE;
+  wire [63:0] packed_in;
+  assign packed_in = grant_ext ? dina_ext : dina_dma;
+  wire packed_wea, packed_wea_1DP;
+  assign packed_wea = grant_ext ? wea_ext && do_expand : wea_dma && dma_bram_sel == DMA_FFT_BRAM_ID;
+  wire [2*FLP_WORDSIZE-1:0] packed_data_1DP;
+  PlaintextToDouble real_to_double (
+      .clk(clk),
+      .format(plaintext_format),
+      .frac_bits(plaintext_frac_bits),
+      .in(packed_in[31:0]),
+      .result(packed_data_1DP[2*FLP_WORDSIZE-1:FLP_WORDSIZE])
+    );
+  PlaintextToDouble imag_to_double (
+      .clk(clk),
+      .format(plaintext_format),
+      .frac_bits(plaintext_frac_bits),
+      .in(packed_in[63:32]),
+      .result(packed_data_1DP[FLP_WORDSIZE-1:0])
+    );
+  DelayRegister #(.CYCLE_COUNT(1), .BITWIDTH(1)) packed_wea_delay (.clk(clk), .in(packed_wea), .out(packed_wea_1DP));
+
+  // DMA reads of the Complex BRAM: word k is value k in packed formats
+  wire [LOGN-2:0] dma_fft_rd_addr;
+  assign dma_fft_rd_addr = plaintext_packed ? {1'd1, dma_rdwr_addr[LOGN-2:1]} : {1'd1, dma_rdwr_addr[LOGN-1:2]};
+
 
   /******************** BRAMs and Local Data Bus ***************/
 
@@ -234,7 +320,7 @@ module ComputeCore(
   wire i2f_wea_bank0, i2f_wea_bank1;
   wire fft_ext_wea_bank0, fft_ext_wea_bank1;
 
-  wire [LOGN-1:0] pwm_b_rd_addr;
+  wire [LOGN-2:0] pwm_b_rd_addr;
   wire [LOGN-1:0] rns_read_addr;
   wire [FLP_WORDSIZE-1:0] rns_read_data;
   wire [LOGQ-1:0] fft_im_rd_data;
@@ -242,6 +328,7 @@ module ComputeCore(
   wire [LOGN-2:0] prj_write_addr, prj_read_addr;
   wire [2*FLP_WORDSIZE-1:0] prj_wr_data;
   wire prj_wea_bank0, prj_wea_bank1;
+  wire prj_last_stage;
 
   wire [LOGN-1:0] fft_im_wr_addr;
   wire [LOGQ-1:0] fft_im_wr_data;
@@ -253,28 +340,29 @@ module ComputeCore(
       .BRAM_RD_LAT(BRAM_RD_LAT)
     ) fft_bram (
       .clk(clk),
-      .is_fft(~pwm_rst || ~rns_rst || (~transform_rst & ~do_fft) || bram_sel == FFT_IM_BRAM_ID ? 1'd0 : 1'd1),
+      .is_fft(~pwm_rst || ~rns_rst || (~transform_rst & ~do_fft & i2f_rst) || bram_sel == FFT_IM_BRAM_ID ||
+              (~grant_ext & dma_bram_en & dma_bram_sel == DMA_IM_BRAM_ID) ? 1'd0 : 1'd1),
 
       // FFT Bank 0: (Complex BRAM)
-      .fft_rd_addr_bank0((~transform_rst) ? fft_read_addr_bank0  : (~prj_rst) ? prj_read_addr  : (grant_ext ? ext_rdwr_addr[LOGN:2]  : {1'd1, dma_rdwr_addr[LOGN-1:2]})),
-      .fft_wr_addr_bank0((~transform_rst) ? fft_write_addr_bank0 : (~prj_rst) ? prj_write_addr : (~i2f_rst) ? i2f_write_addr_bank0 : ext_write_addr_bank0), 
+      .fft_rd_addr_bank0((~transform_rst) ? fft_read_addr_bank0  : (~prj_rst) ? prj_read_addr  : (grant_ext ? ext_rdwr_addr[LOGN:2]  : dma_fft_rd_addr)),
+      .fft_wr_addr_bank0((~i2f_rst) ? i2f_write_addr_bank0 : (~transform_rst & ~prj_last_stage) ? fft_write_addr_bank0 : (~prj_rst) ? prj_write_addr : ext_write_addr_bank0), 
       .fft_rd_data_bank0(fft_rd_data_bank0), 
-      .fft_wr_data_bank0((~transform_rst) ? fft_wr_data_bank0    : (~prj_rst) ? prj_wr_data    : (~i2f_rst) ? i2f_wr_data_bank0    : ext_wr_data_bank0), 
-      .fft_wea_bank0(    (~transform_rst) ? fft_wea_bank0        : (~prj_rst) ? prj_wea_bank0  : (~i2f_rst) ? i2f_wea_bank0        : fft_ext_wea_bank0),
+      .fft_wr_data_bank0((~i2f_rst) ? i2f_wr_data_bank0    : (~transform_rst & ~prj_last_stage) ? fft_wr_data_bank0    : (~prj_rst) ? prj_wr_data    : ext_wr_data_bank0), 
+      .fft_wea_bank0(    (~i2f_rst) ? i2f_wea_bank0        : (~transform_rst & ~prj_last_stage) ? fft_wea_bank0        : (~prj_rst) ? prj_wea_bank0  : fft_ext_wea_bank0),
       
       // FFT Bank 1: (Complex BRAM)
-      .fft_rd_addr_bank1((~transform_rst) ? fft_read_addr_bank1  : (~prj_rst) ? prj_read_addr  : (grant_ext ? ext_rdwr_addr[LOGN:2]  : {1'd1, dma_rdwr_addr[LOGN-1:2]})), 
-      .fft_wr_addr_bank1((~transform_rst) ? fft_write_addr_bank1 : (~prj_rst) ? prj_write_addr : (~i2f_rst) ? i2f_write_addr_bank1 : ext_write_addr_bank1),
+      .fft_rd_addr_bank1((~transform_rst) ? fft_read_addr_bank1  : (~prj_rst) ? prj_read_addr  : (grant_ext ? ext_rdwr_addr[LOGN:2]  : dma_fft_rd_addr)), 
+      .fft_wr_addr_bank1((~i2f_rst) ? i2f_write_addr_bank1 : (~transform_rst & ~prj_last_stage) ? fft_write_addr_bank1 : (~prj_rst) ? prj_write_addr : ext_write_addr_bank1),
       .fft_rd_data_bank1(fft_rd_data_bank1), 
-      .fft_wr_data_bank1((~transform_rst) ? fft_wr_data_bank1    : (~prj_rst) ? prj_wr_data    : (~i2f_rst) ? i2f_wr_data_bank1    : ext_wr_data_bank1),
-      .fft_wea_bank1(    (~transform_rst) ? fft_wea_bank1        : (~prj_rst) ? prj_wea_bank1  : (~i2f_rst) ? i2f_wea_bank1        : fft_ext_wea_bank1),
+      .fft_wr_data_bank1((~i2f_rst) ? i2f_wr_data_bank1    : (~transform_rst & ~prj_last_stage) ? fft_wr_data_bank1    : (~prj_rst) ? prj_wr_data    : ext_wr_data_bank1),
+      .fft_wea_bank1(    (~i2f_rst) ? i2f_wea_bank1        : (~transform_rst & ~prj_last_stage) ? fft_wea_bank1        : (~prj_rst) ? prj_wea_bank1  : fft_ext_wea_bank1),
 
       // RNS port: (Complex BRAM)
       .rns_rd_addr(rns_read_addr),
       .rns_rd_data(rns_read_data), 
       
       // Key port: (Imag BRAM)
-      .key_rd_addr((~pwm_rst             || !PROVIDE_DEBUG_IO) ? pwm_b_rd_addr  : ext_rdwr_addr[LOGN-1:0]), 
+      .key_rd_addr((~pwm_rst) ? {pwm_b_rd_addr, 1'd0} : (grant_ext ? ext_rdwr_addr[LOGN-1:0] : dma_rdwr_addr)), 
       .key_wr_addr((~random_sampling_rst || !PROVIDE_DEBUG_IO) ? fft_im_wr_addr : ext_rdwr_addr[LOGN-1:0]),
       .key_rd_data(fft_im_rd_data), 
       .key_wr_data((~random_sampling_rst || !PROVIDE_DEBUG_IO) ? fft_im_wr_data : dina_ext[LOGQ-1:0]),
@@ -289,8 +377,9 @@ module ComputeCore(
       .current_n(current_n_expand),
       
       .addr_from_sw(grant_ext ? ext_rdwr_addr[LOGN:1]   : {1'd0, dma_rdwr_addr[LOGN-1:1]}),
-      .data_from_sw(grant_ext ? {real_part, dina_ext} : {real_part_dma, dina_dma}),
-      .wea_from_sw( grant_ext ? fft_ext_wea : fft_dma_wea),
+      .data_from_sw(plaintext_packed ? packed_data_1DP : grant_ext ? {real_part, dina_ext} : {real_part_dma, dina_dma}),
+      .wea_from_sw( plaintext_packed ? packed_wea_1DP  : grant_ext ? fft_ext_wea : fft_dma_wea),
+      .wea_is_pulse(~grant_ext),
 
       .wr_addr_bank0(ext_write_addr_bank0),
       .wr_data_bank0(ext_wr_data_bank0),
@@ -307,7 +396,8 @@ module ComputeCore(
     ) project (
       .clk(clk),
       .rst(prj_rst),
-      .current_n(current_n),
+      .current_n(fft_current_n),
+      .fuse_ifft(fuse_prj),
 
       .fft_rd_addr(prj_read_addr),
       .fft_wr_addr(prj_write_addr),
@@ -317,9 +407,24 @@ module ComputeCore(
       .fft_bank1_rd_data(fft_rd_data_bank1),
       .fft_wr_data(prj_wr_data),
 
+      // fused mode: write-back of the IFFT
+      .ifft_wr_addr_bank0(fft_write_addr_bank0),
+      .ifft_wr_addr_bank1(fft_write_addr_bank1),
+      .ifft_wr_data_bank0(fft_wr_data_bank0),
+      .ifft_wr_data_bank1(fft_wr_data_bank1),
+      .ifft_wea_bank0(fft_wea_bank0),
+      .ifft_wea_bank1(fft_wea_bank1),
+      .ifft_done(transformation_done),
+      .ifft_last_stage(prj_last_stage),
+
       .done(prj_done)
     );
 
+  // Automorphism ports (message BRAM -> key BRAM):
+  wire [LOGN-2:0] aut_src_rd_addr, aut_key_write_addr_bank0, aut_key_write_addr_bank1;
+  wire [LOGQ-1:0] aut_key_wr_data_bank0, aut_key_wr_data_bank1;
+  wire aut_key_wea;
+
   // NTT BRAMs Message (Modular Ring BRAM 0):
   wire [LOGN-2:0] ntt_m_write_addr_bank0, ntt_m_write_addr_bank1;
   wire [LOGN-2:0] ntt_m_read_addr_bank0, ntt_m_read_addr_bank1;
@@ -338,7 +443,7 @@ module ComputeCore(
       .clka(clk), 
       .clkb(clk), 
       .addra(~transform_rst ? ntt_m_write_addr_bank0 : (~rns_rst ? rns_m_write_addr_bank0 : (~pwm_rst ? pwm_m_write_addr_bank0 : (grant_ext ? ext_rdwr_addr[LOGN-1:1] : dma_rdwr_addr[LOGN-1:1])))),
-      .addrb(~transform_rst ? ntt_m_read_addr_bank0  : (~pwm_rst ? pwm_m_read_addr_bank0  : (~i2f_rst ? i2f_m_read_addr_bank0  : (grant_ext ? ext_rdwr_addr[LOGN-1:1] : dma_rdwr_addr[LOGN-1:1])))), 
+      .addrb(~transform_rst ? ntt_m_read_addr_bank0  : (~pwm_rst ? pwm_m_read_addr_bank0  : (~i2f_rst ? i2f_m_read_addr_bank0  : (~aut_rst ? aut_src_rd_addr : (grant_ext ? ext_rdwr_addr[LOGN-1:1] : dma_rdwr_addr[LOGN-1:1]))))), 
       .dina( ~transform_rst ? ntt_m_wr_data_bank0    : (~rns_rst ? rns_m_wr_data_bank0    : (~pwm_rst ? pwm_m_wr_data_bank0    : (grant_ext ? dina_ext[LOGQ-1:0]  : dina_dma[LOGQ-1:0])))), 
       .doutb(ntt_m_rd_data_bank0), 
       .wea(  ~transform_rst ? ntt_m_wea_bank0        : (~rns_rst ? rns_m_wea_bank0        : (~pwm_rst ? pwm_m_wea_bank0        : (grant_ext ? ntt_m_ext_wea_bank0 : ntt_m_dma_wea_bank0))))
@@ -347,7 +452,7 @@ module ComputeCore(
       .clka(clk), 
       .clkb(clk), 
       .addra(~transform_rst ? ntt_m_write_addr_bank1 : (~rns_rst ? rns_m_write_addr_bank1 : (~pwm_rst ? pwm_m_write_addr_bank1 : (grant_ext ? ext_rdwr_addr[LOGN-1:1] : dma_rdwr_addr[LOGN-1:1])))), 
-      .addrb(~transform_rst ? ntt_m_read_addr_bank1  : (~pwm_rst ? pwm_m_read_addr_bank1  : (~i2f_rst ? i2f_m_read_addr_bank1  : (grant_ext ? ext_rdwr_addr[LOGN-1:1] : dma_rdwr_addr[LOGN-1:1])))), 
+      .addrb(~transform_rst ? ntt_m_read_addr_bank1  : (~pwm_rst ? pwm_m_read_addr_bank1  : (~i2f_rst ? i2f_m_read_addr_bank1  : (~aut_rst ? aut_src_rd_addr : (grant_ext ? ext_rdwr_addr[LOGN-1:1] : dma_rdwr_addr[LOGN-1:1]))))), 
       .dina( ~transform_rst ? ntt_m_wr_data_bank1    : (~rns_rst ? rns_m_wr_data_bank1    : (~pwm_rst ? pwm_m_wr_data_bank1    : (grant_ext ? dina_ext[LOGQ-1:0]  : dina_dma[LOGQ-1:0])))), 
       .doutb(ntt_m_rd_data_bank1), 
       .wea(  ~transform_rst ? ntt_m_wea_bank1        : (~rns_rst ? rns_m_wea_bank1        : (~pwm_rst ? pwm_m_wea_bank1        : (grant_ext ? ntt_m_ext_wea_bank1 : ntt_m_dma_wea_bank1))))
@@ -398,7 +503,7 @@ module ComputeCore(
       .clka(clk), 
       .clkb(clk), 
       .addra(~transform_rst ? ntt_e1_write_addr_bank0 : (~rns_rst || !PROVIDE_DEBUG_IO ? rns_e1_write_addr_bank0 : ext_rdwr_addr[LOGN-1:1])),
-      .addrb(~transform_rst ? ntt_e1_read_addr_bank0  : (~pwm_rst || !PROVIDE_DEBUG_IO ? pwm_e1_read_addr_bank0  : ext_rdwr_addr[LOGN-1:1])), 
+      .addrb(~transform_rst ? ntt_e1_read_addr_bank0  : (~pwm_rst ? pwm_e1_read_addr_bank0  : (grant_ext ? ext_rdwr_addr[LOGN-1:1] : dma_rdwr_addr[LOGN-1:1]))), 
       .dina( ~transform_rst ? ntt_e1_wr_data_bank0    : (~rns_rst || !PROVIDE_DEBUG_IO ? rns_e1_wr_data_bank0    : dina_ext[LOGQ-1:0])), 
       .doutb(ntt_e1_rd_data_bank0), 
       .wea(  ~transform_rst ? ntt_e1_wea_bank0        : (~rns_rst || !PROVIDE_DEBUG_IO ? rns_e1_wea_bank0        : ntt_e1_ext_wea_bank0))
@@ -407,7 +512,7 @@ module ComputeCore(
       .clka(clk), 
       .clkb(clk), 
       .addra(~transform_rst ? ntt_e1_write_addr_bank1 : (~rns_rst || !PROVIDE_DEBUG_IO ? rns_e1_write_addr_bank1 : ext_rdwr_addr[LOGN-1:1])),
-      .addrb(~transform_rst ? ntt_e1_read_addr_bank1  : (~pwm_rst || !PROVIDE_DEBUG_IO ? pwm_e1_read_addr_bank1  : ext_rdwr_addr[LOGN-1:1])), 
+      .addrb(~transform_rst ? ntt_e1_read_addr_bank1  : (~pwm_rst ? pwm_e1_read_addr_bank1  : (grant_ext ? ext_rdwr_addr[LOGN-1:1] : dma_rdwr_addr[LOGN-1:1]))), 
       .dina( ~transform_rst ? ntt_e1_wr_data_bank1    : (~rns_rst || !PROVIDE_DEBUG_IO ? rns_e1_wr_data_bank1    : dina_ext[LOGQ-1:0])), 
       .doutb(ntt_e1_rd_data_bank1), 
       .wea(  ~transform_rst ? ntt_e1_wea_bank1        : (~rns_rst || !PROVIDE_DEBUG_IO ? rns_e1_wea_bank1        : ntt_e1_ext_wea_bank1))
@@ -415,28 +520,34 @@ module ComputeCore(
 
 
   // NTT BRAMs key (Modular Ring BRAM 3):
-  wire [LOGN-2:0] pwm_key_read_addr_bank0, pwm_key_read_addr_bank1;
+  // The PWM and the automorphism write to the first N coefficients, the other
+  // regions of N coefficients keep pk0 residues (see pk0_region). key_page
+  // selects the 2^LOGN coefficients seen by DMA and the debug interface.
+  wire [KEY_LOGN-2:0] pwm_key_read_addr_bank0, pwm_key_read_addr_bank1;
   wire [LOGN-2:0] pwm_key_write_addr_bank0, pwm_key_write_addr_bank1;
+  wire [KEY_LOGN-2:0] key_ext_addr, key_dma_addr;
+  assign key_ext_addr = (key_page << (LOGN-1)) | ext_rdwr_addr[LOGN-1:1];
+  assign key_dma_addr = (key_page << (LOGN-1)) | dma_rdwr_addr[LOGN-1:1];
   wire [LOGQ-1:0] ntt_key_rd_data_bank0, ntt_key_rd_data_bank1;
   wire [LOGQ-1:0] pwm_key_wr_data_bank0, pwm_key_wr_data_bank1;
   wire pwm_key_wea_bank0, pwm_key_wea_bank1;
-  NTTPolyBank #(.LOGN(LOGN)) ntt_key_bank0(
+  NTTPolyBank #(.LOGN(KEY_LOGN)) ntt_key_bank0(
       .clka(clk), 
       .clkb(clk), 
-      .addra(~pwm_rst ? pwm_key_write_addr_bank0 : (grant_ext ? ext_rdwr_addr[LOGN-1:1]   : dma_rdwr_addr[LOGN-1:1])),
-      .addrb(~pwm_rst ? pwm_key_read_addr_bank0  : (grant_ext ? ext_rdwr_addr[LOGN-1:1]   : dma_rdwr_addr[LOGN-1:1])), 
-      .dina( ~pwm_rst ? pwm_key_wr_data_bank0    : (grant_ext ? dina_ext[LOGQ-1:0]    : dina_dma[LOGQ-1:0])), 
+      .addra(~pwm_rst ? pwm_key_write_addr_bank0 : (~aut_rst ? aut_key_write_addr_bank0 : (grant_ext ? key_ext_addr : key_dma_addr))),
+      .addrb(~pwm_rst ? pwm_key_read_addr_bank0  : (grant_ext ? key_ext_addr : key_dma_addr)), 
+      .dina( ~pwm_rst ? pwm_key_wr_data_bank0    : (~aut_rst ? aut_key_wr_data_bank0    : (grant_ext ? dina_ext[LOGQ-1:0]    : dina_dma[LOGQ-1:0]))), 
       .doutb(ntt_key_rd_data_bank0), 
-      .wea(  ~pwm_rst ? pwm_key_wea_bank0        : (grant_ext ? ntt_key_ext_wea_bank0 : ntt_key_dma_wea_bank0))
+      .wea(  ~pwm_rst ? pwm_key_wea_bank0        : (~aut_rst ? aut_key_wea               : (grant_ext ? ntt_key_ext_wea_bank0 : ntt_key_dma_wea_bank0)))
       );
-  NTTPolyBank #(.LOGN(LOGN)) ntt_key_bank1(
+  NTTPolyBank #(.LOGN(KEY_LOGN)) ntt_key_bank1(
       .clka(clk), 
       .clkb(clk), 
-      .addra(~pwm_rst ? pwm_key_write_addr_bank1 : (grant_ext ? ext_rdwr_addr[LOGN-1:1]   : dma_rdwr_addr[LOGN-1:1])),
-      .addrb(~pwm_rst ? pwm_key_read_addr_bank1  : (grant_ext ? ext_rdwr_addr[LOGN-1:1]   : dma_rdwr_addr[LOGN-1:1])), 
-      .dina( ~pwm_rst ? pwm_key_wr_data_bank1    : (grant_ext ? dina_ext[LOGQ-1:0]    : dina_dma[LOGQ-1:0])), 
+      .addra(~pwm_rst ? pwm_key_write_addr_bank1 : (~aut_rst ? aut_key_write_addr_bank1 : (grant_ext ? key_ext_addr : key_dma_addr))),
+      .addrb(~pwm_rst ? pwm_key_read_addr_bank1  : (grant_ext ? key_ext_addr : key_dma_addr)), 
+      .dina( ~pwm_rst ? pwm_key_wr_data_bank1    : (~aut_rst ? aut_key_wr_data_bank1    : (grant_ext ? dina_ext[LOGQ-1:0]    : dina_dma[LOGQ-1:0]))), 
       .doutb(ntt_key_rd_data_bank1), 
-      .wea(  ~pwm_rst ? pwm_key_wea_bank1        : (grant_ext ? ntt_key_ext_wea_bank1 : ntt_key_dma_wea_bank1))
+      .wea(  ~pwm_rst ? pwm_key_wea_bank1        : (~aut_rst ? aut_key_wea               : (grant_ext ? ntt_key_ext_wea_bank1 : ntt_key_dma_wea_bank1)))
       );
 
 
@@ -451,21 +562,21 @@ module ComputeCore(
   CBDPolyBRAM #(.LOGN(LOGN)) e0_bram(
     .clka(clk),
     .wea(e0_bram_wea),
-    .addra(~random_sampling_rst ? e0_bram_wr_addr : (~rns_rst || !PROVIDE_DEBUG_IO ? e0_bram_rd_addr : ext_rdwr_addr[LOGN-1:0])),
+    .addra(~random_sampling_rst ? e0_bram_wr_addr : (~rns_rst ? e0_bram_rd_addr : (grant_ext ? ext_rdwr_addr[LOGN-1:0] : dma_rdwr_addr))),
     .dina(e0_bram_wr_data),
     .douta(e0_bram_rd_data)
     );
   CBDPolyBRAM #(.LOGN(LOGN)) e1_bram(
     .clka(clk),
     .wea(e1_bram_wea),
-    .addra(~random_sampling_rst ? e1_bram_wr_addr : (~rns_rst || !PROVIDE_DEBUG_IO ? e1_bram_rd_addr : ext_rdwr_addr[LOGN-1:0])),
+    .addra(~random_sampling_rst ? e1_bram_wr_addr : (~rns_rst ? e1_bram_rd_addr : (grant_ext ? ext_rdwr_addr[LOGN-1:0] : dma_rdwr_addr))),
     .dina(e1_bram_wr_data),
     .douta(e1_bram_rd_data)
     );
   TernaryPolyBRAM #(.LOGN(LOGN)) v_bram(
     .clka(clk),
     .wea(v_bram_wea),
-    .addra(~random_sampling_rst ? v_bram_wr_addr : (~rns_rst || !PROVIDE_DEBUG_IO ? v_bram_rd_addr : ext_rdwr_addr[LOGN-1:0])),
+    .addra(~random_sampling_rst ? v_bram_wr_addr : (~rns_rst ? v_bram_rd_addr : (grant_ext ? ext_rdwr_addr[LOGN-1:0] : dma_rdwr_addr))),
     .dina(v_bram_wr_data),
     .douta(v_bram_rd_data)
     );
@@ -474,8 +585,17 @@ module ComputeCore(
   // Constants ROM:
   // contains the "Twiddle factor cache" for FFT and NTT twiddle factor generation and the RNS constants
   wire [CONSTANTS_ROM_ADDR_WIDTH-1:0] transform_tw_rom_addr, rns_constant_rom_addr;
+  // With const_wr, the DMA overwrites it (64-bit word 2*line+i is half i of a line).
   wire [2*FLP_WORDSIZE-1:0] tw_rom_data;
-  FFTTw_RNS_ROM constants_rom(.clka(clk), .addra((~transform_rst) ? transform_tw_rom_addr : rns_constant_rom_addr), .douta(tw_rom_data));
+  wire const_dma_wea;
+  assign const_dma_wea = (dma_bram_byte_wea == 8'hff) && dma_bram_en && const_wr;
+  FFTTw_RNS_ROM constants_rom(
+      .clka(clk),
+      .wea(const_dma_wea),
+      .addra(dma_rdwr_addr[CONSTANTS_ROM_ADDR_WIDTH:0]),
+      .dina(dina_dma),
+      .addrb((~transform_rst) ? transform_tw_rom_addr : rns_constant_rom_addr),
+      .doutb(tw_rom_data));
 
 
   /******************** Unified Transformation Module ***************/
@@ -500,6 +620,7 @@ module ComputeCore(
   end
 
   wire [LOGQ-1:0] pwm_bf0_ina, pwm_bf0_inb, pwm_bf0_tw, pwm_bf0_result, pwm_bf1_ina, pwm_bf1_inb, pwm_bf1_tw, pwm_bf1_result;
+  wire [LOGQ-1:0] pwm_bf2_ina, pwm_bf2_inb, pwm_bf2_tw, pwm_bf2_result, pwm_bf3_ina, pwm_bf3_inb, pwm_bf3_tw, pwm_bf3_result;
   wire [107:0] rns_significant;
   wire [23:0] rns_significant_low;
   wire [LOGQ-1:0] rns_mult_factor, rns_mult_result;
@@ -521,7 +642,7 @@ module ComputeCore(
       .current_k(current_k),
       .qm(qm),
       .constants_sel(constants_sel),
-      .current_n(current_n),
+      .current_n(do_fft ? fft_current_n : current_n),
 
       // fft bram bank 0:
       .data_to_bram_0_fft(fft_wr_data_bank0),
@@ -589,10 +710,18 @@ module ComputeCore(
       .pwm_bf0_inb(pwm_bf0_inb),
       .pwm_bf0_tw(pwm_bf0_tw),
       .pwm_bf0_result(pwm_bf0_result),
-      .pwm_bf2_ina(pwm_bf1_ina),
-      .pwm_bf2_inb(pwm_bf1_inb),
-      .pwm_bf2_tw(pwm_bf1_tw),
-      .pwm_bf2_result(pwm_bf1_result),
+      .pwm_bf1_ina(pwm_bf1_ina),
+      .pwm_bf1_inb(pwm_bf1_inb),
+      .pwm_bf1_tw(pwm_bf1_tw),
+      .pwm_bf1_result(pwm_bf1_result),
+      .pwm_bf2_ina(pwm_bf2_ina),
+      .pwm_bf2_inb(pwm_bf2_inb),
+      .pwm_bf2_tw(pwm_bf2_tw),
+      .pwm_bf2_result(pwm_bf2_result),
+      .pwm_bf3_ina(pwm_bf3_ina),
+      .pwm_bf3_inb(pwm_bf3_inb),
+      .pwm_bf3_tw(pwm_bf3_tw),
+      .pwm_bf3_result(pwm_bf3_result),
       
       // connection to UnifiedTransformation to reuse reduction and multiplier (Shared Arithmetic Unit)
       .rns_significant(rns_significant),
@@ -662,6 +791,7 @@ module ComputeCore(
       .current_k(current_k),
       .qm(qm),
       .current_n(current_n),
+      .sparse_shift(sparse_shift),
 
       // fft bram:
       .bram_rd_addr(rns_read_addr),
@@ -701,37 +831,32 @@ module ComputeCore(
     );
 
   /******************** Point-wise Multiplication Unit ***************/
-  wire [LOGN-1:0] pwm_a_rd_addr;
-  assign pwm_v_read_addr_bank0 = pwm_a_rd_addr[LOGN-1:1];
-  assign pwm_v_read_addr_bank1 = pwm_a_rd_addr[LOGN-1:1]; 
-  wire pwm_a_bank_sel_delayed;
-  DelayRegister #(.CYCLE_COUNT(BRAM_RD_LAT), .BITWIDTH(1)) pwm_a_bank_sel_delay (.clk(clk), .in(pwm_a_rd_addr[0]), .out(pwm_a_bank_sel_delayed));
-  assign pwm_key_read_addr_bank0 = pwm_b_rd_addr[LOGN-1:1];
-  assign pwm_key_read_addr_bank1 = pwm_b_rd_addr[LOGN-1:1]; 
-  wire pwm_b_bank_sel_delayed;
-  DelayRegister #(.CYCLE_COUNT(BRAM_RD_LAT), .BITWIDTH(1)) pwm_b_bank_sel_delay (.clk(clk), .in(pwm_b_rd_addr[0]), .out(pwm_b_bank_sel_delayed));
-  wire [LOGN-1:0] pwm_c_rd_addr;
-  assign pwm_m_read_addr_bank0 = pwm_c_rd_addr[LOGN-1:1];
-  assign pwm_m_read_addr_bank1 = pwm_c_rd_addr[LOGN-1:1];
-  assign pwm_e1_read_addr_bank0 = pwm_c_rd_addr[LOGN-1:1];
-  assign pwm_e1_read_addr_bank1 = pwm_c_rd_addr[LOGN-1:1];
-  wire pwm_c_bank_sel_delayed;
-  DelayRegister #(.CYCLE_COUNT(BRAM_RD_LAT), .BITWIDTH(1)) pwm_c_bank_sel_delay (.clk(clk), .in(pwm_c_rd_addr[0]), .out(pwm_c_bank_sel_delayed));
-  wire [LOGN-1:0] pwm_result_wr_addr;
-  assign pwm_m_write_addr_bank0   = pwm_result_wr_addr[LOGN-1:1];
-  assign pwm_m_write_addr_bank1   = pwm_result_wr_addr[LOGN-1:1];
-  assign pwm_key_write_addr_bank0 = pwm_result_wr_addr[LOGN-1:1];
-  assign pwm_key_write_addr_bank1 = pwm_result_wr_addr[LOGN-1:1];
+  // the PWM reads and writes one coefficient of each bank per cycle
+  wire [LOGN-2:0] pwm_a_rd_addr;
+  assign pwm_v_read_addr_bank0 = pwm_a_rd_addr;
+  assign pwm_v_read_addr_bank1 = pwm_a_rd_addr;
+  // The key BRAM holds 2^(KEY_STORE_LOG_POLYS+LOGN)/N regions of N coefficients.
+  // The PWM writes its result to region 0, so pk0 residues in the other regions
+  // stay resident across encryptions.
+  wire [KEY_LOGN-2:0] pk0_region_offset;
+  assign pk0_region_offset = pk0_region << (LOGN-3+current_n);
+  assign pwm_key_read_addr_bank0 = pwm_b_rd_addr | pk0_region_offset;
+  assign pwm_key_read_addr_bank1 = pwm_b_rd_addr | pk0_region_offset;
+  wire [LOGN-2:0] pwm_c_rd_addr;
+  assign pwm_m_read_addr_bank0 = pwm_c_rd_addr;
+  assign pwm_m_read_addr_bank1 = pwm_c_rd_addr;
+  assign pwm_e1_read_addr_bank0 = pwm_c_rd_addr;
+  assign pwm_e1_read_addr_bank1 = pwm_c_rd_addr;
+  wire [LOGN-2:0] pwm_result_wr_addr;
+  assign pwm_m_write_addr_bank0   = pwm_result_wr_addr;
+  assign pwm_m_write_addr_bank1   = pwm_result_wr_addr;
+  assign pwm_key_write_addr_bank0 = pwm_result_wr_addr;
+  assign pwm_key_write_addr_bank1 = pwm_result_wr_addr;
   wire pwm_r_wea;
-  assign pwm_m_wea_bank0   = pwm_r_wea & ~pwm_result_wr_addr[0];
-  assign pwm_m_wea_bank1   = pwm_r_wea &  pwm_result_wr_addr[0];
-  assign pwm_key_wea_bank0 = pwm_r_wea & ~pwm_result_wr_addr[0];
-  assign pwm_key_wea_bank1 = pwm_r_wea &  pwm_result_wr_addr[0];
-  wire [LOGQ-1:0] pwm_c0_wr_data, pwm_c1_wr_data;
-  assign pwm_m_wr_data_bank0   = pwm_c0_wr_data;
-  assign pwm_m_wr_data_bank1   = pwm_c0_wr_data;
-  assign pwm_key_wr_data_bank0 = pwm_c1_wr_data;
-  assign pwm_key_wr_data_bank1 = pwm_c1_wr_data;
+  assign pwm_m_wea_bank0   = pwm_r_wea;
+  assign pwm_m_wea_bank1   = pwm_r_wea;
+  assign pwm_key_wea_bank0 = pwm_r_wea;
+  assign pwm_key_wea_bank1 = pwm_r_wea;
   PWM #(
       .LOGQ(LOGQ),
       .LOGN(LOGN),
@@ -747,22 +872,29 @@ module ComputeCore(
 
       // a bram read port:
       .a_bram_rd_addr(pwm_a_rd_addr),
-      .a_bram_rd_data(pwm_a_bank_sel_delayed ? ntt_v_rd_data_bank1 : ntt_v_rd_data_bank0),
+      .a_bram_rd_data_bank0(ntt_v_rd_data_bank0),
+      .a_bram_rd_data_bank1(ntt_v_rd_data_bank1),
 
-      // b bram read port:
+      // b bram read port (pk1 is in the lower part of the FFT BRAM):
       .b_bram_rd_addr(pwm_b_rd_addr),
-      .b0_bram_rd_data(pwm_b_bank_sel_delayed ? ntt_key_rd_data_bank1 : ntt_key_rd_data_bank0),
-      .b1_bram_rd_data(fft_im_rd_data),
+      .b0_bram_rd_data_bank0(ntt_key_rd_data_bank0),
+      .b0_bram_rd_data_bank1(ntt_key_rd_data_bank1),
+      .b1_bram_rd_data_bank0(fft_rd_data_bank0[LOGQ-1:0]),
+      .b1_bram_rd_data_bank1(fft_rd_data_bank1[LOGQ-1:0]),
 
       // c bram read port:
       .c_bram_rd_addr(pwm_c_rd_addr),
-      .c0_bram_rd_data(pwm_c_bank_sel_delayed ? ntt_m_rd_data_bank1 : ntt_m_rd_data_bank0),
-      .c1_bram_rd_data(pwm_c_bank_sel_delayed ? ntt_e1_rd_data_bank1 : ntt_e1_rd_data_bank0),
+      .c0_bram_rd_data_bank0(ntt_m_rd_data_bank0),
+      .c0_bram_rd_data_bank1(ntt_m_rd_data_bank1),
+      .c1_bram_rd_data_bank0(ntt_e1_rd_data_bank0),
+      .c1_bram_rd_data_bank1(ntt_e1_rd_data_bank1),
 
       // result bram write port:
       .result_bram_wr_addr(pwm_result_wr_addr),
-      .result0_bram_wr_data(pwm_c0_wr_data),
-      .result1_bram_wr_data(pwm_c1_wr_data),
+      .result0_bram_wr_data_bank0(pwm_m_wr_data_bank0),
+      .result0_bram_wr_data_bank1(pwm_m_wr_data_bank1),
+      .result1_bram_wr_data_bank0(pwm_key_wr_data_bank0),
+      .result1_bram_wr_data_bank1(pwm_key_wr_data_bank1),
       .result_bram_wea(pwm_r_wea),
 
       // connection for NTT BF
@@ -774,10 +906,48 @@ module ComputeCore(
       .pwm_bf1_inb(pwm_bf1_inb),
       .pwm_bf1_tw(pwm_bf1_tw),
       .pwm_bf1_result(pwm_bf1_result),
+      .pwm_bf2_ina(pwm_bf2_ina),
+      .pwm_bf2_inb(pwm_bf2_inb),
+      .pwm_bf2_tw(pwm_bf2_tw),
+      .pwm_bf2_result(pwm_bf2_result),
+      .pwm_bf3_ina(pwm_bf3_ina),
+      .pwm_bf3_inb(pwm_bf3_inb),
+      .pwm_bf3_tw(pwm_bf3_tw),
+      .pwm_bf3_result(pwm_bf3_result),
 
       .done(pwm_done)
     );
 
+  // Automorphism X -> X^k from the message BRAM to the key BRAM, e.g. the
+  // rotation of a ciphertext polynomial before the PWM with a Galois key
+  Automorphism #(
+      .LOGQ(LOGQ),
+      .LOGN(LOGN),
+      .W(W),
+      .M(M)
+    ) automorphism (
+      .clk(clk),
+      .rst(aut_rst),
+
+      .q_m(qm),
+      .current_k(current_k),
+      .current_n(current_n),
+      .galois_half(galois_half),
+      .ntt_domain(aut_ntt_domain),
+
+      .src_rd_addr(aut_src_rd_addr),
+      .src_rd_data_bank0(ntt_m_rd_data_bank0),
+      .src_rd_data_bank1(ntt_m_rd_data_bank1),
+
+      .dst_wr_addr_bank0(aut_key_write_addr_bank0),
+      .dst_wr_addr_bank1(aut_key_write_addr_bank1),
+      .dst_wr_data_bank0(aut_key_wr_data_bank0),
+      .dst_wr_data_bank1(aut_key_wr_data_bank1),
+      .dst_wea(aut_key_wea),
+
+      .done(aut_done)
+    );
+
   /******************** PRNG and Sampling unit ***************/
   wire [LOGN-1:0] sampled_e0_bram_wr_addr,sampled_e1_bram_wr_addr, sampled_v_bram_wr_addr;
   wire [5:0] sampled_e0, sampled_e1;
@@ -845,16 +1015,6 @@ module ComputeCore(
   wire i2f_bank_sel_delayed;
   DelayRegister #(.CYCLE_COUNT(BRAM_RD_LAT), .BITWIDTH(1)) i2f_bank_sel_delay (.clk(clk), .in(i2f_rd_addr[0]), .out(i2f_bank_sel_delayed));
 
-  wire [LOGN-1:0] i2f_write_addr;
-  assign i2f_write_addr_bank0 = i2f_write_addr[LOGN-1:1];
-  assign i2f_write_addr_bank1 = i2f_write_addr[LOGN-1:1];
-  wire [2*FLP_WORDSIZE-1:0] i2f_write_data;
-  assign i2f_wr_data_bank0 = i2f_write_data;
-  assign i2f_wr_data_bank1 = i2f_write_data;
-  wire i2f_wea;
-  assign i2f_wea_bank0 = i2f_wea & ~i2f_write_addr[0];
-  assign i2f_wea_bank1 = i2f_wea &  i2f_write_addr[0];
-
   IntToFlPWrapper #(
       .LOGN(LOGN),
       .LOGQ(LOGQ),
@@ -867,15 +1027,29 @@ module ComputeCore(
       .q_m(qm),
       .scale_power(scale_i2f),
       .current_n(current_n),
+      .fuse_intt(fuse_i2f),
+      .sparse_shift(sparse_shift),
 
       // message read bram:
       .bram_rd_addr(i2f_rd_addr),
       .bram_rd_data(i2f_bank_sel_delayed ? ntt_m_rd_data_bank1 : ntt_m_rd_data_bank0),
 
+      // fused mode: write-back of the inverse NTT
+      .intt_wr_addr_bank0(ntt_m_write_addr_bank0),
+      .intt_wr_addr_bank1(ntt_m_write_addr_bank1),
+      .intt_wr_data_bank0(ntt_m_wr_data_bank0),
+      .intt_wr_data_bank1(ntt_m_wr_data_bank1),
+      .intt_wea_bank0(ntt_m_wea_bank0),
+      .intt_wea_bank1(ntt_m_wea_bank1),
+      .intt_done(transformation_done),
+
       // fft write bram:
-      .bram_wr_addr(i2f_write_addr),
-      .bram_wr_data(i2f_write_data),
-      .bram_wea(i2f_wea),
+      .bram_wr_addr_bank0(i2f_write_addr_bank0),
+      .bram_wr_addr_bank1(i2f_write_addr_bank1),
+      .bram_wr_data_bank0(i2f_wr_data_bank0),
+      .bram_wr_data_bank1(i2f_wr_data_bank1),
+      .bram_wea_bank0(i2f_wea_bank0),
+      .bram_wea_bank1(i2f_wea_bank1),
 
       .done(i2f_done)
     ); 
@@ -895,10 +1069,30 @@ module ComputeCore(
 
   wire dma_rd_bank_sel, dma_rd_bank_sel_fft;
   DelayRegister #(.CYCLE_COUNT(BRAM_RD_LAT), .BITWIDTH(2)) dma_rd_bank_sel_delay (.clk(clk), .in(dma_rdwr_addr[1:0]), .out({dma_rd_bank_sel_fft, dma_rd_bank_sel}));
-  assign doutb_dma = dma_bram_sel == DMA_FFT_BRAM_ID ? (dma_rd_bank_sel_fft == 0 ? (dma_rd_bank_sel == 0 ? fft_rd_data_bank0[2*FLP_WORDSIZE-1:FLP_WORDSIZE] : fft_rd_data_bank0[FLP_WORDSIZE-1:0]) :
+  wire [2*FLP_WORDSIZE-1:0] dma_rd_data_packed_src;
+  wire [63:0] dma_rd_data_packed;
+  assign dma_rd_data_packed_src = dma_rd_bank_sel == 0 ? fft_rd_data_bank0 : fft_rd_data_bank1;
+  DoubleToPlaintext real_to_plaintext (
+      .format(plaintext_format),
+      .frac_bits(plaintext_frac_bits),
+      .in(dma_rd_data_packed_src[2*FLP_WORDSIZE-1:FLP_WORDSIZE]),
+      .result(dma_rd_data_packed[31:0])
+    );
+  DoubleToPlaintext imag_to_plaintext (
+      .format(plaintext_format),
+      .frac_bits(plaintext_frac_bits),
+      .in(dma_rd_data_packed_src[FLP_WORDSIZE-1:0]),
+      .result(dma_rd_data_packed[63:32])
+    );
+  assign doutb_dma = dma_bram_sel == DMA_FFT_BRAM_ID && plaintext_packed ? dma_rd_data_packed :
+                    dma_bram_sel == DMA_FFT_BRAM_ID ? (dma_rd_bank_sel_fft == 0 ? (dma_rd_bank_sel == 0 ? fft_rd_data_bank0[2*FLP_WORDSIZE-1:FLP_WORDSIZE] : fft_rd_data_bank0[FLP_WORDSIZE-1:0]) :
                                                                                   (dma_rd_bank_sel == 0 ? fft_rd_data_bank1[2*FLP_WORDSIZE-1:FLP_WORDSIZE] : fft_rd_data_bank1[FLP_WORDSIZE-1:0])) :
                     dma_bram_sel == DMA_MSG_BRAM_ID ? (dma_rd_bank_sel == 0 ? {10'd0, ntt_m_rd_data_bank0}   : {10'd0, ntt_m_rd_data_bank1}) :  
                     dma_bram_sel == DMA_KEY_BRAM_ID ? (dma_rd_bank_sel == 0 ? {10'd0, ntt_key_rd_data_bank0} : {10'd0, ntt_key_rd_data_bank1}) : 
-                    64'dX; // V BRAM is write-only via dma
+                    dma_bram_sel == DMA_V_BRAM_ID   ? (dma_rd_bank_sel == 0 ? {10'd0, ntt_v_rd_data_bank0}   : {10'd0, ntt_v_rd_data_bank1}) : 
+                    dma_bram_sel == DMA_E1_BRAM_ID  ? (dma_rd_bank_sel == 0 ? {10'd0, ntt_e1_rd_data_bank0}  : {10'd0, ntt_e1_rd_data_bank1}) : 
+                    dma_bram_sel == DMA_IM_BRAM_ID  ? {10'd0, fft_im_rd_data} :
+                    dma_bram_sel == DMA_ERROR_BRAM_ID ? {50'd0, v_bram_rd_data, e0_bram_rd_data, e1_bram_rd_data} : 
+                    64'dX;
 
 endmodule
\ No newline at end of file
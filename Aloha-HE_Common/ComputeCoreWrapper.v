@@ -22,25 +22,36 @@ module ComputeCoreWrapper(
   output [31:0] status;
 
   input [7:0] dma_bram_byte_wea;
-  input [19:0] dma_bram_abs_addr;
+  input [20:0] dma_bram_abs_addr;
   input [63:0] dma_bram_dina;
   output [63:0] dma_bram_doutb;
   input dma_bram_en;
 
   wire [63:0] dina_ext = {dina_ext_high_word,dina_ext_low_word};
-  wire [63:0] dout_ext;
+  wire [63:0] dout_ext, dout_ext_core, trace_rd_data;
   reg [31:0] status;
   wire rst_core;
 
   wire [15:0] address_ext;
   wire [2:0] bram_sel;
   wire [1:0] current_n_expand;
-  wire wea_ext, grant_ext, wea_ext_core, wea_ext_ISA;
+  wire [1:0] plaintext_format;
+  wire [4:0] plaintext_frac_bits;
+  wire [1:0] sparse_shift;
+  wire [3:0] pk0_region;
+  wire [1:0] key_page;
+  wire const_wr;
+  wire ins_wr;
+  wire wea_ext, grant_ext, wea_ext_core, wea_ext_ISA, trace_sel;
 
   wire [41:0] command_in;
   wire command_we;
 
   wire rst_ISA, start_ISA;
+  wire [3:0] ins_address;
+  wire [43:0] ins_data;
+  wire ins_wea;
+  wire [7:0] dma_bram_byte_wea_core;
   wire done_ins_computation; 
   wire done_all_computation; // This becomes 1 when the cryptoprocessor has finished executing all instructions.
 
@@ -50,11 +61,16 @@ module ComputeCoreWrapper(
   assign address_ext = control_low_word[15:0];
   assign wea_ext = control_low_word[16];
   assign grant_ext = control_low_word[18];
+  assign trace_sel = control_low_word[19];
   assign bram_sel = control_low_word[31:29];
   assign current_n_expand = control_low_word[28:27];
+  assign plaintext_format = control_low_word[21:20];
+  assign plaintext_frac_bits = control_low_word[26:22];
 
   assign status_wire = {cycle_count[29:0], 1'd0, done_all_computation};
   assign {dout_ext_high_word,dout_ext_low_word} = dout_ext;
+  // control_low_word[19] selects the execution trace of ISA_control instead of a BRAM.
+  assign dout_ext = trace_sel ? trace_rd_data : dout_ext_core;
   assign wea_ext_core = (wea_ext==1'b1 & control_low_word[17]==1'b0) ? 1'b1 : 1'b0;
 
   always @(posedge clk)
@@ -66,14 +82,20 @@ module ComputeCoreWrapper(
       .address_ext(address_ext), 
       .bram_sel(bram_sel), 
       .current_n_expand(current_n_expand),
+      .plaintext_format(plaintext_format),
+      .plaintext_frac_bits(plaintext_frac_bits),
+      .sparse_shift(sparse_shift),
+      .pk0_region(pk0_region),
+      .key_page(key_page),
+      .const_wr(const_wr),
       .dina_ext(dina_ext), 
-      .doutb_ext(dout_ext),
+      .doutb_ext(dout_ext_core),
       .wea_ext(wea_ext_core),
       .command_in(command_in), 
       .command_we(command_we),
       .done_ins_computation(done_ins_computation),
       .grant_ext_io(grant_ext),
-      .dma_bram_byte_wea(dma_bram_byte_wea), 
+      .dma_bram_byte_wea(dma_bram_byte_wea_core), 
       .dma_bram_abs_addr(dma_bram_abs_addr), 
       .dina_dma(dma_bram_dina), 
       .doutb_dma(dma_bram_doutb), 
@@ -83,12 +105,26 @@ module ComputeCoreWrapper(
   assign rst_core = control_high_word[0];
   assign rst_ISA = control_high_word[0];
   assign start_ISA = control_high_word[1];
+  assign sparse_shift = control_high_word[3:2];
+  assign pk0_region = control_high_word[7:4];
+  assign key_page = control_high_word[9:8];
+  assign const_wr = control_high_word[10];
+  assign ins_wr = control_high_word[11];
   assign wea_ext_ISA = (wea_ext==1'b1 & control_low_word[17]==1'b1) ? 1'b1 : 1'b0;
 
+  // While control_high_word[11] is set, DMA writes go to the instruction
+  // memory instead of the BRAMs (64-bit word i is instruction i), so a whole
+  // program is loaded by a single burst instead of MMIO writes per word.
+  assign dma_bram_byte_wea_core = ins_wr ? 8'd0 : dma_bram_byte_wea;
+  assign ins_address = ins_wr ? dma_bram_abs_addr[6:3] : address_ext[3:0];
+  assign ins_data    = ins_wr ? dma_bram_dina[43:0]    : dina_ext[43:0];
+  assign ins_wea     = ins_wr ? (dma_bram_byte_wea == 8'hff) && dma_bram_en : wea_ext_ISA;
+
   ISA_control ISA_CTRL(clk, rst_ISA, start_ISA, done_ins_computation,
-                    address_ext[3:0], dina_ext[43:0], wea_ext_ISA,
+                    ins_address, ins_data, ins_wea,
                     command_in,	command_we,
                     done_all_computation,
-                    cycle_count);
+                    cycle_count,
+                    address_ext[3:0], trace_rd_data);
 
 endmodule
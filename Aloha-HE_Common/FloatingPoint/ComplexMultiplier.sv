@@ -4,7 +4,12 @@
 // performs a complex multiplication
 // i.e.: (a_real + j*a_imag) * (b_real + j*b_imag) = 
 //       = (a_real*b_real - a_imag*b_imag) + j(a_imag*b_real + a_real*b_imag)
-module ComplexMultiplier(
+module ComplexMultiplier #(
+    parameter INT_MULT_LAT = `DELAY_INT_MULT,
+    parameter FLP_MULT_EXTRA_STAGES = `FLP_MULT_EXTRA_STAGES,
+    parameter FLP_ADDER_EXTRA_STAGES = `FLP_ADDER_EXTRA_STAGES
+  )
+  (
     input clk,
     input start,
     input [`OVERALL_BITS-1:0] a_real,
@@ -26,7 +31,7 @@ module ComplexMultiplier(
   logic mult_done;
   logic [`OVERALL_BITS-1:0] ar_x_br, ar_x_bi, ai_x_br, ai_x_bi;
 
-  FLPMultiplier mult_ar_x_br(
+  FLPMultiplier #(.INT_MULT_LAT(INT_MULT_LAT), .EXTRA_STAGES(FLP_MULT_EXTRA_STAGES)) mult_ar_x_br(
     .clk(clk),
     .start(start),
     .a(a_real),
@@ -38,7 +43,7 @@ module ComplexMultiplier(
     .mult_b(mult_b[0]),
     .int_mult_result(int_mult_result[0])
   );
-  FLPMultiplier mult_ar_x_bi(
+  FLPMultiplier #(.INT_MULT_LAT(INT_MULT_LAT), .EXTRA_STAGES(FLP_MULT_EXTRA_STAGES)) mult_ar_x_bi(
     .clk(clk),
     .a(a_real),
     .b(b_imag),
@@ -50,7 +55,7 @@ module ComplexMultiplier(
     .mult_b(mult_b[1]),
     .int_mult_result(int_mult_result[1])
   );
-  FLPMultiplier mult_ai_x_br(
+  FLPMultiplier #(.INT_MULT_LAT(INT_MULT_LAT), .EXTRA_STAGES(FLP_MULT_EXTRA_STAGES)) mult_ai_x_br(
     .clk(clk),
     .a(a_imag),
     .b(b_real),
@@ -62,7 +67,7 @@ module ComplexMultiplier(
     .mult_b(mult_b[2]),
     .int_mult_result(int_mult_result[2])
   );
-  FLPMultiplier mult_ai_x_bi(
+  FLPMultiplier #(.INT_MULT_LAT(INT_MULT_LAT), .EXTRA_STAGES(FLP_MULT_EXTRA_STAGES)) mult_ai_x_bi(
     .clk(clk),
     .a(a_imag),
     .b(b_imag),
@@ -75,7 +80,7 @@ module ComplexMultiplier(
     .int_mult_result(int_mult_result[3])
   );
 
-  FLPAdder #(.DO_SUBSTRACTION(1)) adder_real_result(
+  FLPAdder #(.DO_SUBSTRACTION(1), .EXTRA_STAGES(FLP_ADDER_EXTRA_STAGES)) adder_real_result(
     .clk(clk),
     .start(mult_done),
     .a(ar_x_br),
@@ -84,7 +89,7 @@ module ComplexMultiplier(
     .done(done)
   );
 
-  FLPAdder #(.DO_SUBSTRACTION(0)) adder_imag_result(
+  FLPAdder #(.DO_SUBSTRACTION(0), .EXTRA_STAGES(FLP_ADDER_EXTRA_STAGES)) adder_imag_result(
     .clk(clk),
     .a(ar_x_bi),
     .b(ai_x_br),
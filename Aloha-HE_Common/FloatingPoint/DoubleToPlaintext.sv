@@ -0,0 +1,42 @@
+`timescale 1ns / 1ps
+`include "CommonDefinitions.vh"
+
+// converts a double to a 32-bit plaintext value (float32 or fixed-point, see
+// PT_FORMAT_*). It is combinational, because it is on the read path of the DMA.
+// Both conversions truncate. Values too small for float32 become zero, values
+// too large become infinity (float32) or saturate (fixed-point).
+module DoubleToPlaintext(
+    input [1:0] format,
+    input [4:0] frac_bits,
+    input [`OVERALL_BITS-1:0] in,
+    output [31:0] result
+  );
+
+  logic sign;
+  logic [`EXPONENT_BITS-1:0] exponent;
+  logic [`SIGNIFICANT_BITS:0] significant;
+  assign sign = in[`OVERALL_BITS-1];
+  assign exponent = in[`SIGNIFICANT_BITS+`EXPONENT_BITS-1:`SIGNIFICANT_BITS];
+  assign significant = {1'b1, in[`SIGNIFICANT_BITS-1:0]};
+
+  // float32:
+  logic [31:0] result_f32;
+  assign result_f32 = exponent <= `EXPONENT_BIAS - 11'd127 ? {sign, 31'd0} :
+                      exponent >= `EXPONENT_BIAS + 11'd128 ? {sign, 8'hff, 23'd0} :
+                      {sign, exponent[7:0] + 8'd128, in[`SIGNIFICANT_BITS-1:`SIGNIFICANT_BITS-23]}; // exponent - 1023 + 127
+
+  // fixed-point: value * 2^frac_bits = significant * 2^int_exponent-52
+  logic signed [`EXPONENT_BITS+1:0] int_exponent;
+  assign int_exponent = $signed({2'd0, exponent}) - $signed({2'd0, `EXPONENT_BIAS}) + $signed({8'd0, frac_bits});
+
+  logic [30:0] magnitude;
+  assign magnitude = int_exponent < 0 || exponent == `EXPONENT_BITS'd0 ? 31'd0 :
+                     int_exponent >= 31 ? 31'h7fffffff :
+                     significant >> (`SIGNIFICANT_BITS - int_exponent[4:0]);
+
+  logic [31:0] result_fixed;
+  assign result_fixed = sign ? -{1'b0, magnitude} : {1'b0, magnitude};
+
+  assign result = format == `PT_FORMAT_FLOAT32 ? result_f32 : result_fixed;
+
+endmodule
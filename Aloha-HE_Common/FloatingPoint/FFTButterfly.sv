@@ -50,7 +50,10 @@ module FFTButterfly(
   );
 
   ///////////////////// Mult stage ///////////////////////////
-  logic [`OVERALL_BITS-1:0] mul_out_real, mul_out_imag;
+  // the complex multiplication is padded to the latency of the NTT butterfly multiplication
+  localparam MULT_PAD = `DELAY_TRANSFORM_MULT - `DELAY_COMPLEX_MULT;
+  logic [`OVERALL_BITS-1:0] mul_out_real, mul_out_imag, mul_out_real_unpadded, mul_out_imag_unpadded;
+  logic mult_done;
   logic add_done_1DP, add_done_2DP;
   always_ff @(posedge clk)begin
     a_m_b_real_1DP <= use_ct ? b_in_real : a_m_b_real;
@@ -69,16 +72,22 @@ module FFTButterfly(
     .b_real(tw_real),
     .b_imag(tw_imag),
 
-    .a_x_b_real(mul_out_real),
-    .a_x_b_imag(mul_out_imag),
+    .a_x_b_real(mul_out_real_unpadded),
+    .a_x_b_imag(mul_out_imag_unpadded),
 
-    .done(done),
+    .done(mult_done),
 
     .mult_a(mult_a),
     .mult_b(mult_b),
     .int_mult_result(int_mult_result)
   );
 
+  DelayRegister #(.BITWIDTH(2*`OVERALL_BITS+1), .CYCLE_COUNT(MULT_PAD)) mult_pad_delay(
+    .clk(clk),
+    .in({mult_done, mul_out_real_unpadded, mul_out_imag_unpadded}),
+    .out({done, mul_out_real, mul_out_imag})
+  );
+
   assign b_out_real = use_ct ? a_m_b_real : mul_out_real;
   assign b_out_imag = use_ct ? a_m_b_imag : mul_out_imag;
 
@@ -3,7 +3,7 @@
 
 // This is the implementation of the IEEE-754 adder without subnormal
 // number support
-module FLPAdder #(DO_SUBSTRACTION = 0) (
+module FLPAdder #(DO_SUBSTRACTION = 0, EXTRA_STAGES = `FLP_ADDER_EXTRA_STAGES) (
     input clk,
     input start,
     input [`OVERALL_BITS-1:0] a,
@@ -32,7 +32,7 @@ module FLPAdder #(DO_SUBSTRACTION = 0) (
     .switched_operands_2DP()
   );
   
-  FLPAdderSigAddNormalize add_and_normalize(
+  FLPAdderSigAddNormalize #(.EXTRA_STAGES(EXTRA_STAGES)) add_and_normalize(
     .clk(clk),
     .sign_result_2DP(sign_result_2DP), 
     .data_valid_2DP(data_valid_2DP), 
@@ -2,7 +2,10 @@
 `include "CommonDefinitions.vh"
 
 // performs the second half of FlP addition containing significant addition and renormalization
-module FLPAdderSigAddNormalize(
+module FLPAdderSigAddNormalize #(
+    parameter EXTRA_STAGES = `FLP_ADDER_EXTRA_STAGES
+  )
+  (
     input logic clk,
     input logic sign_result_2DP, data_valid_2DP, bit_shifted_out_2DP, denorm_underflow_2DP, signs_equal_2DP,
     input logic [`EXPONENT_BITS-1:0] exponent_b_2DP,
@@ -147,6 +150,9 @@ module FLPAdderSigAddNormalize(
     significant_result_6DP <= significant_result;
   end
 
-  assign result = {sign_result_6DP, exponent_result_6DP,  exponent_result_6DP != `EXPONENT_BITS'd0 ? significant_result_6DP : `SIGNIFICANT_BITS'd0};
-  assign done = data_valid_6DP;
+  DelayRegister #(.BITWIDTH(`OVERALL_BITS+1), .CYCLE_COUNT(EXTRA_STAGES)) extra_stages(
+    .clk(clk),
+    .in({data_valid_6DP, sign_result_6DP, exponent_result_6DP,  exponent_result_6DP != `EXPONENT_BITS'd0 ? significant_result_6DP : `SIGNIFICANT_BITS'd0}),
+    .out({done, result})
+  );
 endmodule
\ No newline at end of file
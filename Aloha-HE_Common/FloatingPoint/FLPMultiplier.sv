@@ -1,7 +1,12 @@
 `timescale 1ns / 1ps
+`include "CommonDefinitions.vh"
 
 // This is the implementation of the IEEE-754 multiplier without subnormal
-module FLPMultiplier(
+module FLPMultiplier #(
+    parameter INT_MULT_LAT = `DELAY_INT_MULT,
+    parameter EXTRA_STAGES = `FLP_MULT_EXTRA_STAGES
+  )
+  (
     input clk,
     input start,
     input [`OVERALL_BITS-1:0] a,
@@ -44,9 +49,9 @@ module FLPMultiplier(
   ////////////////////////// Pipeline stage ///////////////////
   logic sign_result_1DP, data_valid_1DP;
   logic [`EXPONENT_BITS:0] exponent_sum_1DP;
-  DelayRegister #(.BITWIDTH(1), .CYCLE_COUNT(1+2)) data_valid_delay(.clk(clk), .in(start), .out(data_valid_1DP));
-  DelayRegister #(.BITWIDTH(1), .CYCLE_COUNT(1+2)) sign_result_delay(.clk(clk), .in(sign_result), .out(sign_result_1DP));
-  DelayRegister #(.BITWIDTH(`EXPONENT_BITS+1), .CYCLE_COUNT(1+2)) exponent_sum_delay(.clk(clk), .in(exponent_sum), .out(exponent_sum_1DP));
+  DelayRegister #(.BITWIDTH(1), .CYCLE_COUNT(INT_MULT_LAT-2)) data_valid_delay(.clk(clk), .in(start), .out(data_valid_1DP));
+  DelayRegister #(.BITWIDTH(1), .CYCLE_COUNT(INT_MULT_LAT-2)) sign_result_delay(.clk(clk), .in(sign_result), .out(sign_result_1DP));
+  DelayRegister #(.BITWIDTH(`EXPONENT_BITS+1), .CYCLE_COUNT(INT_MULT_LAT-2)) exponent_sum_delay(.clk(clk), .in(exponent_sum), .out(exponent_sum_1DP));
 
   logic [`EXPONENT_BITS+1:0] exponent_uncorrected;
   assign exponent_uncorrected = {1'b0, exponent_sum_1DP} - `EXPONENT_BIAS;
@@ -117,7 +122,10 @@ module FLPMultiplier(
     significant_result_5DP <= zero_result_4DP ? `SIGNIFICANT_BITS'd0 : significant_result_4DP;
   end
 
-  assign result = {sign_result_5DP, exponent_result_5DP, significant_result_5DP};
-  assign done = data_valid_5DP;
+  DelayRegister #(.BITWIDTH(`OVERALL_BITS+1), .CYCLE_COUNT(EXTRA_STAGES)) extra_stages(
+    .clk(clk),
+    .in({data_valid_5DP, sign_result_5DP, exponent_result_5DP, significant_result_5DP}),
+    .out({done, result})
+  );
   
 endmodule
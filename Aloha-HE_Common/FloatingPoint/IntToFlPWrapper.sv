@@ -14,15 +14,29 @@ module IntToFlPWrapper #(
     input [3:0] current_k,
     input [M-1:0] q_m,
     input [`EXPONENT_BITS:0] scale_power,
+    input fuse_intt, // 1: converts the INTT results on their write-back
+    input [1:0] sparse_shift, // sparse packing: converts every 2^sparse_shift-th coefficient only
 
     // message read bram:
     output [LOGN-1:0] bram_rd_addr,
     input [LOGQ-1:0] bram_rd_data,
 
+    // INTT write-back to message bram (fused mode):
+    input [LOGN-2:0] intt_wr_addr_bank0,
+    input [LOGN-2:0] intt_wr_addr_bank1,
+    input [LOGQ-1:0] intt_wr_data_bank0,
+    input [LOGQ-1:0] intt_wr_data_bank1,
+    input intt_wea_bank0,
+    input intt_wea_bank1,
+    input intt_done,
+
     // fft write bram:
-    output [LOGN-1:0] bram_wr_addr,
-    output [2*`OVERALL_BITS-1:0] bram_wr_data,
-    output bram_wea,
+    output [LOGN-2:0] bram_wr_addr_bank0,
+    output [LOGN-2:0] bram_wr_addr_bank1,
+    output [2*`OVERALL_BITS-1:0] bram_wr_data_bank0,
+    output [2*`OVERALL_BITS-1:0] bram_wr_data_bank1,
+    output bram_wea_bank0,
+    output bram_wea_bank1,
 
     output done
   );
@@ -33,7 +47,13 @@ module IntToFlPWrapper #(
   logic [LOGQ-1:0] q;
   assign q = {(13'h1fff >> (8-current_k)) , q_m , {(W-1){1'd0}} , 1'd1};
 
+  // size of the FFT that follows (N>>sparse_shift)
+  logic [1:0] fft_n;
+  assign fft_n = current_n - sparse_shift;
+
   //////////// address generation //////////
+  // read_addr_DP is the position in the fft bram, it reads the coefficient
+  // read_addr_DP<<sparse_shift of the message bram
   logic [LOGN-1:0] read_addr_DP;
   logic done_internal;
   always_ff @(posedge clk) begin
@@ -42,21 +62,59 @@ module IntToFlPWrapper #(
     else if(~done_internal)
       read_addr_DP <= read_addr_DP + 1;
   end
-  assign bram_rd_addr = read_addr_DP;
-  assign done_internal = read_addr_DP == (current_n == 2'd0 ? 'h1fff : current_n == 2'd1 ? 'h3fff : 'h7fff);
-  DelayRegisterReset #(.BITWIDTH(1), .CYCLE_COUNT(BRAM_RD_LAT+IntToFlP_LAT)) done_delay (.clk(clk), .rst(rst), .in(done_internal), .out(done));
-  DelayRegister #(.BITWIDTH(1),      .CYCLE_COUNT(BRAM_RD_LAT+IntToFlP_LAT)) wea_delay (.clk(clk), .in(~rst), .out(bram_wea));
-  DelayRegister #(.BITWIDTH(LOGN),   .CYCLE_COUNT(BRAM_RD_LAT+IntToFlP_LAT)) addr_delay (.clk(clk), .in(read_addr_DP), .out(bram_wr_addr));
+  assign bram_rd_addr = read_addr_DP << sparse_shift;
+  assign done_internal = read_addr_DP == (fft_n == 2'd0 ? 'h1fff : fft_n == 2'd1 ? 'h3fff : 'h7fff);
+  logic done_seq, wea_seq;
+  logic [LOGN-1:0] wr_addr_seq;
+  DelayRegisterReset #(.BITWIDTH(1), .CYCLE_COUNT(BRAM_RD_LAT+IntToFlP_LAT)) done_delay (.clk(clk), .rst(rst), .in(done_internal), .out(done_seq));
+  DelayRegister #(.BITWIDTH(1),      .CYCLE_COUNT(BRAM_RD_LAT+IntToFlP_LAT)) wea_delay (.clk(clk), .in(~rst), .out(wea_seq));
+  DelayRegister #(.BITWIDTH(LOGN),   .CYCLE_COUNT(BRAM_RD_LAT+IntToFlP_LAT)) addr_delay (.clk(clk), .in(read_addr_DP), .out(wr_addr_seq));
+
+  //////////// fused mode //////////
+  // Every INTT write to the message bram is converted and mirrored to the same
+  // position of the fft bram. The last stage writes each position last, so the
+  // fft bram holds the converted INTT result when the INTT is done.
+  logic done_fused, wea_fused_bank0, wea_fused_bank1;
+  logic [LOGN-2:0] wr_addr_fused_bank0, wr_addr_fused_bank1;
+  DelayRegisterReset #(.BITWIDTH(1), .CYCLE_COUNT(IntToFlP_LAT)) fused_done_delay (.clk(clk), .rst(rst), .in(intt_done), .out(done_fused));
+  DelayRegisterReset #(.BITWIDTH(2), .CYCLE_COUNT(IntToFlP_LAT)) fused_wea_delay (.clk(clk), .rst(rst), .in({intt_wea_bank1, intt_wea_bank0}), .out({wea_fused_bank1, wea_fused_bank0}));
+  DelayRegister #(.BITWIDTH(2*(LOGN-1)), .CYCLE_COUNT(IntToFlP_LAT)) fused_addr_delay (.clk(clk), .in({intt_wr_addr_bank1, intt_wr_addr_bank0}), .out({wr_addr_fused_bank1, wr_addr_fused_bank0}));
 
-  logic [`OVERALL_BITS-1:0] flp_real_result;
+  // Sparse packing keeps the even coefficients 2a of bank 0 with
+  // 2a % 2^sparse_shift == 0 only. They go to fft position 2a>>sparse_shift.
+  logic sparse_fused_valid, sparse_fused_bank;
+  logic [LOGN-2:0] sparse_fused_addr;
+  assign sparse_fused_valid = sparse_shift == 2'd2 ? wea_fused_bank0 & ~wr_addr_fused_bank0[0] : wea_fused_bank0;
+  assign sparse_fused_bank  = sparse_shift == 2'd2 ? wr_addr_fused_bank0[1] : wr_addr_fused_bank0[0];
+  assign sparse_fused_addr  = wr_addr_fused_bank0 >> sparse_shift;
+
+  logic [`OVERALL_BITS-1:0] flp_real_result_0, flp_real_result_1;
   IntToFlPDouble #(.LOGQ(LOGQ)) int_to_flp (
     .clk(clk),
     .q(q),
     .scale_power(scale_power),
-    .in(bram_rd_data),
-    .result(flp_real_result)
+    .in(fuse_intt ? intt_wr_data_bank0 : bram_rd_data),
+    .result(flp_real_result_0)
+  );
+
+  // second converter for the odd coefficients in fused mode:
+  IntToFlPDouble #(.LOGQ(LOGQ)) int_to_flp_bank1 (
+    .clk(clk),
+    .q(q),
+    .scale_power(scale_power),
+    .in(intt_wr_data_bank1),
+    .result(flp_real_result_1)
   );
 
+  logic sparse;
+  assign sparse = sparse_shift != 2'd0;
+  assign bram_wr_addr_bank0 = fuse_intt ? (sparse ? sparse_fused_addr : wr_addr_fused_bank0) : wr_addr_seq[LOGN-1:1];
+  assign bram_wr_addr_bank1 = fuse_intt ? (sparse ? sparse_fused_addr : wr_addr_fused_bank1) : wr_addr_seq[LOGN-1:1];
+  assign bram_wea_bank0 = fuse_intt ? (sparse ? sparse_fused_valid & ~sparse_fused_bank : wea_fused_bank0) : wea_seq & ~wr_addr_seq[0];
+  assign bram_wea_bank1 = fuse_intt ? (sparse ? sparse_fused_valid &  sparse_fused_bank : wea_fused_bank1) : wea_seq &  wr_addr_seq[0];
+  assign done = fuse_intt ? done_fused : done_seq;
+
   //imaginary part is always zero:
-  assign bram_wr_data = {flp_real_result, `OVERALL_BITS'd0};
+  assign bram_wr_data_bank0 = {flp_real_result_0, `OVERALL_BITS'd0};
+  assign bram_wr_data_bank1 = {fuse_intt && ~sparse ? flp_real_result_1 : flp_real_result_0, `OVERALL_BITS'd0};
 endmodule
@@ -0,0 +1,46 @@
+`timescale 1ns / 1ps
+`include "CommonDefinitions.vh"
+
+// converts a 32-bit plaintext value (float32 or fixed-point, see PT_FORMAT_*)
+// to double precision. Subnormal float32 values become zero.
+module PlaintextToDouble(
+    input clk,
+    input [1:0] format,
+    input [4:0] frac_bits,
+    input [31:0] in,
+    output logic [`OVERALL_BITS-1:0] result
+  );
+
+  // float32:
+  logic [7:0] exponent_f32;
+  assign exponent_f32 = in[30:23];
+
+  logic [`OVERALL_BITS-1:0] result_f32;
+  assign result_f32 = exponent_f32 == 8'd0   ? {in[31], {(`OVERALL_BITS-1){1'b0}}} :
+                      exponent_f32 == 8'hff  ? {in[31], {`EXPONENT_BITS{1'b1}}, in[22:0], 29'd0} :
+                                               {in[31], {3'd0, exponent_f32} + `EXPONENT_BIAS - 11'd127, in[22:0], 29'd0};
+
+  // fixed-point: value = in * 2^-frac_bits
+  logic [31:0] magnitude;
+  assign magnitude = in[31] ? -in : in;
+
+  logic [4:0] leading_zeros;
+  logic input_is_zero;
+  LeadingZeroCount #(.BITWIDTH(32)) leading_zero_count (
+      .in(magnitude),
+      .out(leading_zeros),
+      .input_is_zero(input_is_zero)
+    );
+
+  logic [31:0] magnitude_normalized;
+  assign magnitude_normalized = magnitude << leading_zeros;
+
+  logic [`OVERALL_BITS-1:0] result_fixed;
+  assign result_fixed = input_is_zero ? `OVERALL_BITS'd0 :
+                        {in[31], `EXPONENT_BIAS + 11'd31 - leading_zeros - frac_bits, magnitude_normalized[30:0], 21'd0};
+
+  ////////////////////////// Pipeline stage ///////////////////
+  always_ff @(posedge clk)
+    result <= format == `PT_FORMAT_FLOAT32 ? result_f32 : result_fixed;
+
+endmodule
@@ -2,12 +2,18 @@
 
 /*
   Program controller. It executes a program instruction-by-instruction.
+  Additionally, it records an execution trace with one entry per executed
+  instruction. The trace is cleared when start is raised and kept until the
+  next program is started, i.e., it survives the reset after execution.
+  Layout of a trace entry (trace_rd_data):
+  {IR index[3:0], opcode[2:0], OP1[1:0], valid, start cycle[26:0], end cycle[26:0]}
 */
 module ISA_control(clk, rst, start, done_ins_computation,
                                     address_ext, dina_ext, wea_ext,
 									command_in,	command_we,
 									done_all_computation,
-									cycle_count);
+									cycle_count,
+									trace_rd_addr, trace_rd_data);
 
 input clk;
 input rst;		// 1 is for reseting the FSM
@@ -23,6 +29,9 @@ output command_we;
 output done_all_computation;
 output reg [30:0] cycle_count;
 
+input [3:0] trace_rd_addr;
+output [63:0] trace_rd_data;
+
 wire command_we1;
 
 reg [2:0] state, nextstate;
@@ -32,6 +41,15 @@ reg inc_IR_address;
 wire [43:0] IR_data;
 wire non_instruction, last_instruction;
 
+// Trace buffer. It has as many entries as the instruction memory, hence it cannot overflow.
+reg [62:0] trace_mem [15:0];
+reg [4:0] trace_count = 5'd0;
+reg [3:0] trace_index;
+reg [4:0] trace_ins;
+reg [26:0] trace_start_cycle;
+reg start_1DP;
+wire trace_issue, trace_retire;
+
 
 INS_RAM IR( .clk(clk), .a(address_ext), .d(dina_ext), .we(wea_ext), .dpra(IR_address), .qdpo_clk(clk), .qdpo(IR_data));
 
@@ -60,6 +78,44 @@ begin
         cycle_count <= cycle_count;
 end
                     	
+// An instruction is issued in state 2 (command_we is set) and retires
+// when done_ins_computation is observed in state 5.
+assign trace_issue  = (state==3'd2 && start==1'b1 && non_instruction==1'b0 && last_instruction==1'b0) ? 1'b1 : 1'b0;
+assign trace_retire = (state==3'd5 && start==1'b1 && non_instruction==1'b0 && last_instruction==1'b0 && done_ins_computation==1'b1) ? 1'b1 : 1'b0;
+
+always @(posedge clk)
+	start_1DP <= start;
+
+always @(posedge clk)
+begin
+	if(trace_issue)
+	begin
+		trace_index <= IR_address;
+		trace_ins <= {IR_data[4:3], IR_data[2:0]};
+		trace_start_cycle <= cycle_count[26:0];
+	end
+end
+
+always @(posedge clk)
+begin
+	if(start==1'b1 && start_1DP==1'b0)
+		trace_count <= 5'd0;
+	else if(trace_retire && trace_count != 5'd16)
+		trace_count <= trace_count + 1'b1;
+	else
+		trace_count <= trace_count;
+end
+
+always @(posedge clk)
+begin
+	if(trace_retire && trace_count != 5'd16)
+		trace_mem[trace_count[3:0]] <= {trace_index, trace_ins[2:0], trace_ins[4:3], trace_start_cycle, cycle_count[26:0]};
+end
+
+assign trace_rd_data[63:55] = trace_mem[trace_rd_addr][62:54];
+assign trace_rd_data[54]    = ({1'b0,trace_rd_addr} < trace_count) ? 1'b1 : 1'b0;
+assign trace_rd_data[53:0]  = trace_mem[trace_rd_addr][53:0];
+
 always @(posedge clk)
 begin
 	if(rst)
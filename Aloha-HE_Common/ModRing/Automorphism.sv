@@ -0,0 +1,118 @@
+`timescale 1ns / 1ps
+
+// Automorphism a(X) -> a(X^k) for an odd Galois element k < 2N.
+// In the NTT domain (a^_j = a(psi^(2BR(j)+1)), see ckksReference.c) it is a
+// permutation of the coefficients:
+//   dst[BR(t)] = src[BR((k*(2t+1) mod 2N - 1)/2)]
+// In the coefficient domain, coefficient i moves to i*k mod N and is negated
+// if i*k mod 2N >= N (X^N = -1).
+// A pair of coefficients (one of each bank) is processed per cycle: in the
+// NTT domain, t and t+N/2 are the two banks of one destination address and
+// their sources are the two banks of one source address (k*N = N mod 2N).
+// In the coefficient domain, the sources i and i+1 share an address and
+// their destinations are in different banks (k is odd).
+module Automorphism #(
+    parameter LOGQ = 54,
+    parameter LOGN = 13,
+    parameter W = 24,
+    parameter M = 17
+  )
+  (
+    input clk,
+    input rst,
+
+    input [M-1:0] q_m,
+    input [3:0] current_k,
+    input [1:0] current_n,
+    input [LOGN-1:0] galois_half, // (k-1)/2
+    input ntt_domain,             // 1: permutation of the NTT domain, 0: coefficient domain
+
+    // source bram read port, a pair of coefficients per cycle:
+    output [LOGN-2:0] src_rd_addr,
+    input  [LOGQ-1:0] src_rd_data_bank0,
+    input  [LOGQ-1:0] src_rd_data_bank1,
+
+    // destination bram write ports, one coefficient of each bank per cycle:
+    output [LOGN-2:0] dst_wr_addr_bank0,
+    output [LOGN-2:0] dst_wr_addr_bank1,
+    output [LOGQ-1:0] dst_wr_data_bank0,
+    output [LOGQ-1:0] dst_wr_data_bank1,
+    output dst_wea,
+
+    output done
+  );
+
+  localparam LOGM = LOGN+1;
+  localparam BRAM_RD_LAT = 2;
+  localparam LAT = BRAM_RD_LAT+1; // read and negation
+
+  localparam [LOGQ-M-W-1:0] Q_HIGH_ONES = '1;
+  logic [LOGQ-1:0] q;
+  assign q = {(Q_HIGH_ONES >> (LOGQ-46-current_k)), q_m, {(W-1){1'd0}}, 1'd1};
+
+  logic [LOGM-1:0] k, m_minus_1;
+  logic [LOGN-1:0] n_minus_1;
+  assign k = {galois_half, 1'd1};
+  always_ff @(posedge clk) begin
+    m_minus_1 <= current_n == 2'd0 ? 'h3fff : current_n == 2'd1 ? 'h7fff : 'hffff;
+    n_minus_1 <= current_n == 2'd0 ? 'h1fff : current_n == 2'd1 ? 'h3fff : 'h7fff;
+  end
+
+  //////////// address generation //////////
+  // ctr counts the N/2 pairs, acc = 2k*ctr mod 2N
+  logic [LOGN-2:0] ctr_DP;
+  logic [LOGM-1:0] acc_DP;
+  logic done_internal;
+  always_ff @(posedge clk) begin
+    if(rst) begin
+      ctr_DP <= 0;
+      acc_DP <= 0;
+    end else if(~done_internal) begin
+      ctr_DP <= ctr_DP + 1;
+      acc_DP <= (acc_DP + (k << 1)) & m_minus_1;
+    end
+  end
+  assign done_internal = ctr_DP == (current_n == 2'd0 ? 'hfff : current_n == 2'd1 ? 'h1fff : 'h3fff);
+
+  // NTT domain: t = ctr, k*(2t+1) = acc + k
+  logic [LOGM-1:0] src_exp;
+  logic [LOGN-1:0] src_index, src_index_unshifted, dst_index, dst_index_unshifted, ctr_ext;
+  assign src_exp = (acc_DP + k) & m_minus_1;
+  assign ctr_ext = {1'd0, ctr_DP};
+  BitReverse #(.BITWIDTH(LOGN)) src_reverse (.in(src_exp[LOGM-1:1]), .out(src_index_unshifted));
+  BitReverse #(.BITWIDTH(LOGN)) dst_reverse (.in(ctr_ext), .out(dst_index_unshifted));
+  assign src_index = current_n == 2'd0 ? (src_index_unshifted >> 2) : current_n == 2'd1 ? (src_index_unshifted >> 1) : src_index_unshifted;
+  assign dst_index = current_n == 2'd0 ? (dst_index_unshifted >> 2) : current_n == 2'd1 ? (dst_index_unshifted >> 1) : dst_index_unshifted;
+
+  // coefficient domain: sources 2*ctr and 2*ctr+1 go to acc and acc+k (mod 2N)
+  logic [LOGM-1:0] dst_exp0, dst_exp1;
+  logic neg0, neg1;
+  assign dst_exp0 = acc_DP;
+  assign dst_exp1 = (acc_DP + k) & m_minus_1;
+  assign neg0 = |(dst_exp0 & ~{1'd0, n_minus_1});
+  assign neg1 = |(dst_exp1 & ~{1'd0, n_minus_1});
+
+  logic [LOGN-2:0] wr_addr0, wr_addr1;
+  logic swap, negate0, negate1;
+  assign src_rd_addr = ntt_domain ? src_index[LOGN-1:1] : ctr_DP;
+  assign wr_addr0 = ntt_domain ? dst_index[LOGN-1:1] : dst_exp0[LOGN-1:1] & n_minus_1[LOGN-1:1];
+  assign wr_addr1 = ntt_domain ? dst_index[LOGN-1:1] : dst_exp1[LOGN-1:1] & n_minus_1[LOGN-1:1];
+
+  DelayRegister #(.CYCLE_COUNT(BRAM_RD_LAT), .BITWIDTH(3)) flag_delay (.clk(clk),
+      .in({ntt_domain & src_index[0], ~ntt_domain & neg0, ~ntt_domain & neg1}), .out({swap, negate0, negate1}));
+  DelayRegister #(.CYCLE_COUNT(LAT), .BITWIDTH(2*(LOGN-1))) wr_addr_delay (.clk(clk), .in({wr_addr1, wr_addr0}), .out({dst_wr_addr_bank1, dst_wr_addr_bank0}));
+  DelayRegisterReset #(.CYCLE_COUNT(LAT), .BITWIDTH(1)) wea_delay (.clk(clk), .rst(rst), .in(~rst), .out(dst_wea));
+  DelayRegisterReset #(.CYCLE_COUNT(LAT), .BITWIDTH(1)) done_delay (.clk(clk), .rst(rst), .in(done_internal), .out(done));
+
+  //////////// data path //////////
+  logic [LOGQ-1:0] x0, x1, result0_DP, result1_DP;
+  assign x0 = swap ? src_rd_data_bank1 : src_rd_data_bank0;
+  assign x1 = swap ? src_rd_data_bank0 : src_rd_data_bank1;
+  always_ff @(posedge clk) begin
+    result0_DP <= negate0 && x0 != 0 ? q - x0 : x0;
+    result1_DP <= negate1 && x1 != 0 ? q - x1 : x1;
+  end
+  assign dst_wr_data_bank0 = result0_DP;
+  assign dst_wr_data_bank1 = result1_DP;
+
+endmodule
@@ -1,9 +1,11 @@
 `timescale 1ns / 1ps
+`include "CommonDefinitions.vh"
 
 module ModMul #(
     parameter K = 54,
     parameter W = 24,
-    parameter M = 17
+    parameter M = 17,
+    parameter MONT_RED_EXTRA_STAGES = `MONT_RED_EXTRA_STAGES
   )
   (
     input clk,
@@ -25,7 +27,8 @@ module ModMul #(
   assign mult_b = inb;
 
   MontRed #(
-    .K(54)
+    .K(54),
+    .EXTRA_STAGES(MONT_RED_EXTRA_STAGES)
   ) reduction (
     .clk(clk),
     .in(int_mult_result),
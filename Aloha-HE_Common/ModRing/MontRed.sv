@@ -1,10 +1,12 @@
 `timescale 1ns / 1ps
+`include "CommonDefinitions.vh"
 
 // this module performs the word-level montgomery reduction for the selected parameter set
 module MontRed #(
     parameter K = 54, // bit size of modulus
     parameter W = 24,
-    parameter M = 17
+    parameter M = 17,
+    parameter EXTRA_STAGES = `MONT_RED_EXTRA_STAGES
   )
   (
     input clk,
@@ -62,6 +64,6 @@ module MontRed #(
   always_ff @(posedge clk)
     result_DP <= cond_subtraction[K] ? T_stage3[K-1:0] : cond_subtraction[K-1:0];
 
-  assign result = result_DP;
+  DelayRegister #(.CYCLE_COUNT(EXTRA_STAGES), .BITWIDTH(K)) result_delay (.clk(clk), .in(result_DP), .out(result));
 
 endmodule
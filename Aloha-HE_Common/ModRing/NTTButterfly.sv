@@ -1,4 +1,5 @@
 `timescale 1ns / 1ps
+`include "CommonDefinitions.vh"
 
 // load and store logic needs to make sure to deliver inputs / twiddle factors and consume results in right point in time
 module NTTButterfly #(
@@ -29,7 +30,9 @@ module NTTButterfly #(
   logic [K-1:0] q;
   assign q = {(13'h1fff >> (8-current_k)) , q_m , {(W-1){1'd0}} , 1'd1};
 
-  logic [K-1:0] mul_in, mul_out;
+  // the modular multiplication is padded to the latency of the FFT butterfly multiplication
+  localparam MULT_PAD = `DELAY_NTT_BF_MULT - `DELAY_MOD_MULT;
+  logic [K-1:0] mul_in, mul_out, mul_out_unpadded;
   logic [K-1:0] add_b_in, add_out;
   ModAdd #(.K(K)) adder (.clk(clk), .ina(ina), .inb(add_b_in), .q(q), .out(add_out));
   assign add_b_in = use_ct ? mul_out : inb;
@@ -47,13 +50,14 @@ module NTTButterfly #(
     .inb(twiddle_factor),
     .q_m(q_m),
     .current_k(current_k),
-    .out(mul_out),
+    .out(mul_out_unpadded),
 
     .mult_a(mult_a),
     .mult_b(mult_b),
     .int_mult_result(int_mult_result),
     .int_mult_result_low(int_mult_result_low)
   );
+  DelayRegister #(.BITWIDTH(K), .CYCLE_COUNT(MULT_PAD)) mult_pad_delay (.clk(clk), .in(mul_out_unpadded), .out(mul_out));
   assign mul_in = use_ct ? inb : sub_out;
 
   logic [K-1:0] out_a_scaled, out_b_scaled;
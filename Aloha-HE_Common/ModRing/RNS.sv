@@ -17,6 +17,7 @@ module RNS #(
     input [LOGI-1:0] modulus_select,
     input [`EXPONENT_BITS:0] scale,
     input [1:0] current_n, // 0 -> 2^13, 1 -> 2^14, 2 -> 2^15
+    input [1:0] sparse_shift, // sparse packing: the FFT result has N>>sparse_shift coefficients
 
     input [3:0] current_k,
     input [M-1:0] qm,
@@ -62,8 +63,8 @@ module RNS #(
   localparam NUM_REGIONS = LOGN == 13 ? 4 : LOGN == 14 ? 10 : 22;
 
   localparam BRAM_RD_LAT = 2;
-  localparam ModMul_LAT = 15;
-  localparam MontRed_LAT = 11 + 2; // +2 bc of two additional registers in the UnifiedTwFctGen module
+  localparam ModMul_LAT = `DELAY_NTT_BF_MULT;
+  localparam MontRed_LAT = 11 + 2; // +2 bc of two additional registers in the UnifiedTwFctGen module (always minimum depth)
   localparam ModAdd_LAT = 2;
 
   localparam ENTRIES_PER_MODULUS = 32;
@@ -94,7 +95,12 @@ module RNS #(
     else if(~done_internal)
       read_addr_DP <= read_addr_DP + 1;
   end
-  assign bram_rd_addr = read_addr_DP;
+  // sparse packing: FFT coefficient j becomes coefficient j<<sparse_shift,
+  // the positions in between only receive the error e0
+  logic sparse_hole, sparse_hole_delayed;
+  assign bram_rd_addr = read_addr_DP >> sparse_shift;
+  assign sparse_hole = sparse_shift == 2'd2 ? read_addr_DP[1:0] != 2'd0 : sparse_shift == 2'd1 ? read_addr_DP[0] : 1'd0;
+  DelayRegister #(.BITWIDTH(1), .CYCLE_COUNT(BRAM_RD_LAT+ModMul_LAT+MontRed_LAT+2)) sparse_hole_delay (.clk(clk), .in(sparse_hole), .out(sparse_hole_delayed));
   assign done_internal = read_addr_DP == (current_n == 2'd0 ? 'h1fff : current_n == 2'd1 ? 'h3fff : 'h7fff);
   DelayRegisterReset #(.BITWIDTH(1), .CYCLE_COUNT(ModMul_LAT+MontRed_LAT+BRAM_RD_LAT+ModMul_LAT+3)) done_delay (.clk(clk), .rst(rst), .in(done_internal), .out(done));
 
@@ -216,7 +222,7 @@ module RNS #(
   logic sign_delayed;
   DelayRegister #(.BITWIDTH(1), .CYCLE_COUNT(ModMul_LAT+MontRed_LAT+2)) sign_delay (.clk(clk), .in(sign_in), .out(sign_delayed));
   logic [LOGQ-1:0] m_reduced, m_reduced_DP, e0_value_DP;
-  assign m_reduced = sign_delayed && mult_result != 'd0 ? q-mult_result : mult_result;
+  assign m_reduced = sparse_hole_delayed ? 'd0 : sign_delayed && mult_result != 'd0 ? q-mult_result : mult_result;
 
   ////////// Pipeline stage /////////////
   always_ff @(posedge clk) begin
@@ -1,7 +1,11 @@
 `timescale 1ns / 1ps
 `include "CommonDefinitions.vh"
 
-module IntMultPool(
+module IntMultPool #(
+    parameter EXTRA_STAGES = `INT_MULT_EXTRA_STAGES,
+    parameter EXTRA_STAGES_3 = EXTRA_STAGES // multiplier 3 also serves the twiddle factor generator
+  )
+  (
     input clk,
     input grant_to_fft,
 
@@ -16,7 +20,7 @@ module IntMultPool(
   genvar i;
   generate
     for(i = 0; i < 4; i = i + 1)begin
-      IntMultiplier_54x54 int_mult(
+      IntMultiplier_54x54 #(.EXTRA_STAGES(i == 3 ? EXTRA_STAGES_3 : EXTRA_STAGES)) int_mult(
         .clk(clk),
         .a(grant_to_fft ? a_fft[i] : a_ntt[i]),
         .b(grant_to_fft ? b_fft[i] : b_ntt[i]),
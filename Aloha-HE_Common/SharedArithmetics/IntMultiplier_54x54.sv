@@ -1,7 +1,10 @@
 `timescale 1ns / 1ps
 `include "CommonDefinitions.vh"
 
-module IntMultiplier_54x54(
+module IntMultiplier_54x54 #(
+    parameter EXTRA_STAGES = `INT_MULT_EXTRA_STAGES
+  )
+  (
     input          clk,
     input  [ 53:0] a,
     input  [ 53:0] b,
@@ -102,7 +105,7 @@ module IntMultiplier_54x54(
     out_high_DP <= out4[107:54];
     result_low_DP <= out4[53:0] + (carry4[52:0] << 1);
   end
-  assign result_low = result_low_DP[23:0];
+  DelayRegister #(.CYCLE_COUNT(EXTRA_STAGES), .BITWIDTH(24)) result_low_delay (.clk(clk), .in(result_low_DP[23:0]), .out(result_low));
   
   logic [107:0] result_DP;
   always_ff @(posedge clk) begin
@@ -110,6 +113,6 @@ module IntMultiplier_54x54(
     result_DP[107:54] <= out_high_DP + carry_high_DP + result_low_DP[54];
   end
 
-  assign result = result_DP;
+  DelayRegister #(.CYCLE_COUNT(EXTRA_STAGES), .BITWIDTH(108)) result_delay (.clk(clk), .in(result_DP), .out(result));
 
 endmodule
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 module UnifiedLoadLogic #(
     parameter ADDER_LAT = `DELAY_FLP_ADDER,
-    parameter MULT_LAT = `DELAY_COMPLEX_MULT,
+    parameter MULT_LAT = `DELAY_TRANSFORM_MULT,
     parameter ADDR_WIDTH = 12,
     parameter LOGQ = 54
   )
@@ -4,9 +4,9 @@
 
 module UnifiedStoreLogic #(
     parameter ADDER_LAT = `DELAY_FLP_ADDER,
-    parameter MULT_LAT = `DELAY_COMPLEX_MULT,
+    parameter MULT_LAT = `DELAY_TRANSFORM_MULT,
     parameter MOD_ADDER_LAT = 2,
-    parameter MOD_MULT_LAT = 15,
+    parameter MOD_MULT_LAT = MULT_LAT + 1,
     parameter ADDR_WIDTH = 12,
     parameter LOGQ = 54
   )
@@ -89,16 +89,24 @@ module UnifiedTransformation #(
     output [ADDR_WIDTH_ROM-1:0] tw_rom_addr,
     input [2*`OVERALL_BITS-1:0] tw_rom_data,
 
-    // connection for PWM module using NTT BF 0,2
+    // connection for PWM module using NTT BF 0-3
     input rst_pwm, // if 0: NTT BF is granted to PWM module
     input [LOGQ_MAX-1:0] pwm_bf0_ina,
     input [LOGQ_MAX-1:0] pwm_bf0_inb,
     input [LOGQ_MAX-1:0] pwm_bf0_tw,
     output [LOGQ_MAX-1:0] pwm_bf0_result,
+    input [LOGQ_MAX-1:0] pwm_bf1_ina,
+    input [LOGQ_MAX-1:0] pwm_bf1_inb,
+    input [LOGQ_MAX-1:0] pwm_bf1_tw,
+    output [LOGQ_MAX-1:0] pwm_bf1_result,
     input [LOGQ_MAX-1:0] pwm_bf2_ina,
     input [LOGQ_MAX-1:0] pwm_bf2_inb,
     input [LOGQ_MAX-1:0] pwm_bf2_tw,
     output [LOGQ_MAX-1:0] pwm_bf2_result,
+    input [LOGQ_MAX-1:0] pwm_bf3_ina,
+    input [LOGQ_MAX-1:0] pwm_bf3_inb,
+    input [LOGQ_MAX-1:0] pwm_bf3_tw,
+    output [LOGQ_MAX-1:0] pwm_bf3_result,
 
     // connection to RNS module using NTT TwFctGen and NTT BF 1
     input [107:0] rns_significant,
@@ -110,7 +118,7 @@ module UnifiedTransformation #(
   );
   
   localparam ADDER_LAT = `DELAY_FLP_ADDER;
-  localparam MULT_LAT = `DELAY_COMPLEX_MULT;
+  localparam MULT_LAT = `DELAY_TRANSFORM_MULT;
   localparam BRAM_RD_LAT = 2;
   localparam MOD_ADDER_LAT = 2;
 
@@ -134,7 +142,7 @@ module UnifiedTransformation #(
   logic [`OVERALL_BITS-1:0] tw_real, tw_imag;
 
   assign stall_debug = stall;
-  logic [$clog2(MULT_LAT)-1:0] stall_counter;
+  logic [$clog2(MULT_LAT+2)-1:0] stall_counter;
   assign stall = is_dif ? (stall_counter < MULT_LAT)   && (base_address == dif_base_addr_stall_DP) && (gap == 1) : 
                           (stall_counter < MULT_LAT+1) && (base_address == 'h0)                    && (gap == 1);
   always_ff @(posedge clk) begin
@@ -177,8 +185,9 @@ module UnifiedTransformation #(
   assign offset_br = current_n == 2'd0 ? offset_br_unshifted >> 2 : current_n == 2'd1 ? offset_br_unshifted >> 1 : offset_br_unshifted;
   
 
+  // the last results of the DIF FFT are written BRAM_RD_LAT+ADDER_LAT+MULT_LAT+2 cycles after the control is done
   logic done_dif_fft, done_dif_ntt, done_dit;
-  DelayRegisterReset #(.BITWIDTH(1), .CYCLE_COUNT(25)) done_delayed (.clk(clk), .rst(rst_ctrl_ld_st), .in(m_loop_done), .out(done_dif_fft));
+  DelayRegisterReset #(.BITWIDTH(1), .CYCLE_COUNT(BRAM_RD_LAT+ADDER_LAT+MULT_LAT+2)) done_delayed (.clk(clk), .rst(rst_ctrl_ld_st), .in(m_loop_done), .out(done_dif_fft));
   DelayRegisterReset #(.BITWIDTH(1), .CYCLE_COUNT(2)) done_delayed2 (.clk(clk), .rst(rst_ctrl_ld_st), .in(done_dif_fft), .out(done_dif_ntt));
   DelayRegisterReset #(.BITWIDTH(1), .CYCLE_COUNT(1)) done_delayed1 (.clk(clk), .rst(rst_ctrl_ld_st), .in(done_dif_fft), .out(done_dit));
   assign done = is_dif ? (is_fft ? done_dif_fft : done_dif_ntt) : done_dit;
@@ -200,9 +209,10 @@ module UnifiedTransformation #(
   logic [53:0] int_mult_b_fft [0:3];
   logic [53:0] int_mult_a_ntt [0:3];
   logic [53:0] int_mult_b_ntt [0:3];
-  logic [107:0] int_mult_result [0:3];
-  logic [23:0] int_mult_result_low [0:3];
-  IntMultPool mult_pool(
+  logic [107:0] int_mult_result [0:3], int_mult_result_padded [0:3];
+  logic [23:0] int_mult_result_low [0:3], int_mult_result_low_padded [0:3];
+  // multiplier 3 has the minimum depth for the twiddle factor generator, pad it for FFT and NTT BF 3
+  IntMultPool #(.EXTRA_STAGES_3(0)) mult_pool(
     .clk(clk),
     .grant_to_fft(is_fft & ~rst),
 
@@ -213,11 +223,25 @@ module UnifiedTransformation #(
     .result(int_mult_result),
     .result_low(int_mult_result_low)
   );
+  genvar slot;
+  for(slot = 0; slot < 3; slot = slot + 1) begin
+    assign int_mult_result_padded[slot] = int_mult_result[slot];
+    assign int_mult_result_low_padded[slot] = int_mult_result_low[slot];
+  end
+  DelayRegister #(.BITWIDTH(108+24), .CYCLE_COUNT(`INT_MULT_EXTRA_STAGES)) int_mult_3_pad_delay (
+    .clk(clk),
+    .in({int_mult_result[3], int_mult_result_low[3]}),
+    .out({int_mult_result_padded[3], int_mult_result_low_padded[3]})
+  );
 
   //////// Twiddle factor generation/storage ///////
   logic [`OVERALL_BITS-1:0] tw_real_gen, tw_imag_gen;
   logic [LOGQ_MAX-1:0] tw_ntt;
-  UnifiedTwFctGen #(.ADDR_WIDTH_ROM(ADDR_WIDTH_ROM)) unif_tw_fct_gen
+  logic [53:0] tw_gen_mult_a, tw_gen_mult_b, bf3_mult_a, bf3_mult_b;
+  // multiplier 3 is only used for twiddle factor generation, grant it to NTT BF 3 during PWM
+  assign int_mult_a_ntt[3] = rst_pwm ? tw_gen_mult_a : bf3_mult_a;
+  assign int_mult_b_ntt[3] = rst_pwm ? tw_gen_mult_b : bf3_mult_b;
+  UnifiedTwFctGen #(.COMPLEX_MULT_LAT(MULT_LAT), .ADDR_WIDTH_ROM(ADDR_WIDTH_ROM)) unif_tw_fct_gen
   (
     .clk(clk),
     .rst(rst_tw_fct_gen),
@@ -233,8 +257,8 @@ module UnifiedTransformation #(
     .rom_addr(tw_rom_addr),
     .rom_data(tw_rom_data),
 
-    .mult_a(int_mult_a_ntt[3]),
-    .mult_b(int_mult_b_ntt[3]),
+    .mult_a(tw_gen_mult_a),
+    .mult_b(tw_gen_mult_b),
     .int_mult_result(rst ? rns_significant : int_mult_result[3]), // if unified transform is in reset, grant to RNS
     .int_mult_result_low(rst ? rns_significant_low : int_mult_result_low[3])
   );
@@ -266,7 +290,7 @@ module UnifiedTransformation #(
 
     .mult_a(int_mult_a_fft),
     .mult_b(int_mult_b_fft),
-    .int_mult_result(int_mult_result)
+    .int_mult_result(int_mult_result_padded)
   );
 
   //////// NTT unified Butterfly ///////
@@ -295,9 +319,9 @@ module UnifiedTransformation #(
   NTTButterfly ntt_butterfly_1(
     .clk(clk),
     .use_ct(~is_dif || rst),
-    .ina(a_in_ntt_1),
-    .inb(rst ? rns_mult_factor : b_in_ntt_1),// if unified transform is in reset, grant to RNS
-    .twiddle_factor(tw_ntt),
+    .ina(rst_pwm ? a_in_ntt_1 : pwm_bf1_ina),
+    .inb(~rst_pwm ? pwm_bf1_inb : rst ? rns_mult_factor : b_in_ntt_1),// if unified transform is in reset, grant to RNS
+    .twiddle_factor(rst_pwm ? tw_ntt : pwm_bf1_tw),
     .current_k(current_k),
     .q_m(qm),
     .outa(a_out_ntt_1),
@@ -309,6 +333,7 @@ module UnifiedTransformation #(
     .int_mult_result(int_mult_result[1]),
     .int_mult_result_low(int_mult_result_low[1])
   );
+  assign pwm_bf1_result = a_out_ntt_1;
 
   NTTButterfly ntt_butterfly_2(
     .clk(clk),
@@ -328,6 +353,25 @@ module UnifiedTransformation #(
     .int_mult_result_low(int_mult_result_low[2])
   );
   assign pwm_bf2_result = a_out_ntt_2;
+
+  // NTT BF 3 is only used by the PWM, which processes two coefficients per cycle
+  NTTButterfly ntt_butterfly_3(
+    .clk(clk),
+    .use_ct(1'd1),
+    .ina(pwm_bf3_ina),
+    .inb(pwm_bf3_inb),
+    .twiddle_factor(pwm_bf3_tw),
+    .current_k(current_k),
+    .q_m(qm),
+    .outa(pwm_bf3_result),
+    .outb(),
+    .out_mul(),
+
+    .mult_a(bf3_mult_a),
+    .mult_b(bf3_mult_b),
+    .int_mult_result(int_mult_result_padded[3]),
+    .int_mult_result_low(int_mult_result_low_padded[3])
+  );
   
 
   //////////// Load logic: ///////////////////
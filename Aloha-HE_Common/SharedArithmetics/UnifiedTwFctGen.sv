@@ -2,8 +2,11 @@
 `include "CommonDefinitions.vh"
 
 // generates twiddle factors for FFT and NTT
+// The recurrences of the twiddle factors need a loop latency of 16 cycles (16 start
+// values per stage in the ROM), so the multipliers of this module always have the
+// minimum pipeline depth. COMPLEX_MULT_LAT is the stall of UnifiedTransformation.
 module UnifiedTwFctGen #(
-    parameter COMPLEX_MULT_LAT = 14,
+    parameter COMPLEX_MULT_LAT = `DELAY_TRANSFORM_MULT,
     parameter ADDR_WIDTH_ROM = 10,
     parameter LOGQ_MAX = 54,
     parameter M = 17,
@@ -65,7 +68,7 @@ module UnifiedTwFctGen #(
     end
   end
 
-  logic [$clog2(COMPLEX_MULT_LAT)-1:0] stall_counter;
+  logic [$clog2(COMPLEX_MULT_LAT+2)-1:0] stall_counter;
   assign stall = is_DIF ? (stall_counter < COMPLEX_MULT_LAT)   && (stage_counter == 1) && (butterfly_counter == 0) : 
                           (stall_counter < COMPLEX_MULT_LAT+1) && (butterfly_counter == 14'd0 && stage_counter == 0);
   always_ff @(posedge clk) begin
@@ -232,7 +235,11 @@ module UnifiedTwFctGen #(
   logic [53:0] int_mult_a_gen [0:3];
   logic [53:0] int_mult_b_gen [0:3];
   logic [107:0] int_mult_result_gen [0:3];
-  ComplexMultiplier complex_multiplier(
+  ComplexMultiplier #(
+    .INT_MULT_LAT(`DELAY_INT_MULT - `INT_MULT_EXTRA_STAGES),
+    .FLP_MULT_EXTRA_STAGES(0),
+    .FLP_ADDER_EXTRA_STAGES(0)
+  ) complex_multiplier(
     .clk(clk),
     .a_real(w_c_real_DP),
     .a_imag(w_c_imag_DP),
@@ -250,7 +257,7 @@ module UnifiedTwFctGen #(
     .int_mult_result(int_mult_result_gen)
   );
 
-  IntMultPool int_mult(
+  IntMultPool #(.EXTRA_STAGES(0)) int_mult(
     .clk(clk),
     .grant_to_fft(1'd1),
     .a_fft(int_mult_a_gen),
@@ -262,7 +269,7 @@ module UnifiedTwFctGen #(
     .result_low()
   );
 
-  ModMul modular_multiplier(    
+  ModMul #(.MONT_RED_EXTRA_STAGES(0)) modular_multiplier(
     .clk(clk),
     .ina(w_c_modring_DP),
     .inb(out_modring), // modular multiplier has 1cc more latency than complex mult
@@ -11,20 +11,25 @@ module DelayRegister #(
     output [BITWIDTH-1:0] out
   );
 
-  logic [BITWIDTH-1:0] buffer [CYCLE_COUNT-1:0];
-  always_ff @(posedge clk) begin
-    buffer[0] <= in;
-  end
-  
-  genvar i;
+  // CYCLE_COUNT = 0 passes the input through (used for optional pipeline stages)
   generate
-    for(i = 1; i < CYCLE_COUNT; i = i + 1) begin
+    if(CYCLE_COUNT == 0) begin
+      assign out = in;
+    end else begin
+      logic [BITWIDTH-1:0] buffer [CYCLE_COUNT-1:0];
       always_ff @(posedge clk) begin
-        buffer[i] <= buffer[i-1];
+        buffer[0] <= in;
       end
+
+      genvar i;
+      for(i = 1; i < CYCLE_COUNT; i = i + 1) begin
+        always_ff @(posedge clk) begin
+          buffer[i] <= buffer[i-1];
+        end
+      end
+
+      assign out = buffer[CYCLE_COUNT-1];
     end
   endgenerate
-  
-  assign out = buffer[CYCLE_COUNT-1];
 
 endmodule
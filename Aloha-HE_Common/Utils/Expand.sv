@@ -15,6 +15,7 @@ module Expand #(
     input [LOGN-1:0]            addr_from_sw,
     input [2*`OVERALL_BITS-1:0] data_from_sw,
     input                       wea_from_sw, // this wont stay high for more than 1cc (re and im part are sent separately)
+    input                       wea_is_pulse, // 1: every cycle with wea_from_sw is a write (DMA), 0: rising edges only (MMIO)
 
     // FFT BRAM banks:
     output [LOGN-2:0]            wr_addr_bank0,
@@ -34,22 +35,23 @@ module Expand #(
     pos_ctr_mask <= current_n == 2'd0 ? 2'd0 : current_n == 2'd1 ? 2'd1 : 2'd3;
   end
 
-  logic wea_from_sw_1DP, update_counter, wea_internal;
+  logic wea_from_sw_1DP, wea_internal;
   logic [LOGM-1:0] pos_ctr_DP,pos_ctr_DN;
   assign pos_ctr_DN = (pos_ctr_DP << 1) + pos_ctr_DP;
   always_ff @(posedge clk) begin
     wea_from_sw_1DP <= wea_from_sw;
-    update_counter <= wea_internal;
 
+    // the counter advances right after each write, so packed DMA data can
+    // be expanded in consecutive cycles
     if(rst)
       pos_ctr_DP <= 'd1;
-    else if(update_counter) begin
+    else if(wea_internal) begin
       pos_ctr_DP[LOGM-3:0] <= pos_ctr_DN[LOGM-3:0];
       pos_ctr_DP[LOGM-1:LOGM-2] <= pos_ctr_DN[LOGM-1:LOGM-2] & pos_ctr_mask;
     end
   end
 
-  assign wea_internal = wea_from_sw_1DP == 'd0 && wea_from_sw == 'd1;
+  assign wea_internal = wea_is_pulse ? wea_from_sw : wea_from_sw_1DP == 'd0 && wea_from_sw == 'd1;
   assign wea_bank0 = do_expand ? wea_internal : wea_from_sw && addr_from_sw[0] == 0;
   assign wea_bank1 = do_expand ? wea_internal : wea_from_sw && addr_from_sw[0] == 1;
 
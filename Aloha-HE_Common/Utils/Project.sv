@@ -9,6 +9,7 @@ module Project #(
     input clk,
     input rst,
     input[1:0] current_n,
+    input fuse_ifft, // 1: permutes the results of the last IFFT stage on their write-back
 
     output [LOGN-2:0]           fft_rd_addr,
     output [LOGN-2:0]           fft_wr_addr,
@@ -18,6 +19,16 @@ module Project #(
     input  [2*FLP_WORDSIZE-1:0] fft_bank1_rd_data,
     output [2*FLP_WORDSIZE-1:0] fft_wr_data,
 
+    // IFFT write-back (fused mode):
+    input  [LOGN-2:0]           ifft_wr_addr_bank0,
+    input  [LOGN-2:0]           ifft_wr_addr_bank1,
+    input  [2*FLP_WORDSIZE-1:0] ifft_wr_data_bank0,
+    input  [2*FLP_WORDSIZE-1:0] ifft_wr_data_bank1,
+    input                       ifft_wea_bank0,
+    input                       ifft_wea_bank1,
+    input                       ifft_done,
+    output                      ifft_last_stage, // 1: fft bram write ports are granted to Project
+
     output done
   );
 
@@ -70,14 +81,79 @@ module Project #(
 
   logic [2*FLP_WORDSIZE-1:0] fft_wr_data_tmp;
   assign fft_wr_data_tmp = (rd_bank_sel ? fft_bank1_rd_data : fft_bank0_rd_data);
-  assign fft_wr_data = fft_wr_data_tmp ^ (conjugate<<63);
-  
-  assign fft_wr_addr = {1'd1, dest_addr_DP[LOGN-2:1]};
 
   logic wea_internal;
   DelayRegisterReset #(.CYCLE_COUNT(BRAM_RD_LAT), .BITWIDTH(1)) delay1 (.clk(clk), .rst(rst | done_internal_2DP), .in(~done_internal_2DP), .out(wea_internal));
-  assign done = done_internal_2DP;
 
-  assign fft_bank0_wea = wea_internal && ~dest_addr_DP[0];
-  assign fft_bank1_wea = wea_internal &&  dest_addr_DP[0];
+
+  //////////// fused mode //////////
+  // The last DIT stage computes the butterflies (p, p+1) with p = bitrev(i), so every
+  // second butterfly produces two outputs with index < N/2 (the ones read above) and
+  // the b-output is written one cycle after the a-output. Hence, at most one write per
+  // cycle has to be projected. Its destination j is the inverse of the read index map:
+  // 2*bitrev(p)+1 = +-3^j mod 2N (conjugated if negative), j is computed bit by bit.
+  localparam LOG_LAT = LOGN; // 1 cycle input selection, LOGN-1 cycles discrete logarithm
+  localparam [15:0] INV3_POW [0:13] = '{16'haaab, 16'h8e39, 16'h48b1, 16'h0a61, 16'hb8c1, 16'h0181, 16'h4301,
+                                        16'h8601, 16'h0c01, 16'h1801, 16'h3001, 16'h6001, 16'hc001, 16'h8001}; // 3^(-2^k) mod 2^16
+
+  // the stages are separated by a stall, so the writes of the last stage are the last N ones:
+  logic [LOGN+3:0] ifft_wr_ctr_DP, last_stage_start;
+  always_ff @(posedge clk) begin
+    if(rst)
+      ifft_wr_ctr_DP <= 'd0;
+    else if(~ifft_last_stage)
+      ifft_wr_ctr_DP <= ifft_wr_ctr_DP + ifft_wea_bank0 + ifft_wea_bank1;
+    last_stage_start <= current_n == 2'd0 ? 12*(1<<13) : current_n == 2'd1 ? 13*(1<<14) : 14*(1<<15);
+  end
+  assign ifft_last_stage = fuse_ifft && ifft_wr_ctr_DP >= last_stage_start;
+
+  logic [LOGN-1:0] src_pos_0, src_pos_1, src_pos, src_pos_br, src_pos_br_unshifted;
+  logic src_valid_0, src_valid_1;
+  assign src_pos_0 = {ifft_wr_addr_bank0, 1'd0};
+  assign src_pos_1 = {ifft_wr_addr_bank1, 1'd1};
+  assign src_valid_0 = ifft_last_stage && ifft_wea_bank0 && ~src_pos_0[current_n == 2'd2 ? LOGN-1 : current_n == 2'd1 ? LOGN-2 : LOGN-3];
+  assign src_valid_1 = ifft_last_stage && ifft_wea_bank1 && ~src_pos_1[current_n == 2'd2 ? LOGN-1 : current_n == 2'd1 ? LOGN-2 : LOGN-3];
+  assign src_pos = src_valid_1 ? src_pos_1 : src_pos_0;
+  BitReverse #(.BITWIDTH(LOGN)) src_pos_reverse (.in(src_pos), .out(src_pos_br_unshifted));
+  assign src_pos_br = current_n == 2'd0 ? (src_pos_br_unshifted >> 2) : current_n == 2'd1 ? (src_pos_br_unshifted >> 1) : src_pos_br_unshifted;
+
+  logic [LOGM-1:0] log_y_DP [0:LOGN-1];
+  logic [LOGN-2:0] log_e_DP [0:LOGN-1];
+  logic [LOGM-1:0] log_y_in;
+  assign log_y_in = {src_pos_br, 1'd1};
+  always_ff @(posedge clk) begin
+    log_y_DP[0] <= log_y_in[2:0] == 3'd5 ? -log_y_in : log_y_in;
+    log_e_DP[0] <= 'd0;
+  end
+  genvar k;
+  generate
+    for(k = 0; k < LOGN-1; k = k + 1) begin
+      always_ff @(posedge clk) begin
+        if(log_y_DP[k][k == 0 ? 1 : k+2]) begin
+          log_y_DP[k+1] <= log_y_DP[k] * INV3_POW[k][LOGM-1:0];
+          log_e_DP[k+1] <= log_e_DP[k] | (1 << k);
+        end else begin
+          log_y_DP[k+1] <= log_y_DP[k];
+          log_e_DP[k+1] <= log_e_DP[k];
+        end
+      end
+    end
+  endgenerate
+
+  logic fused_conjugate, fused_wea, fused_done;
+  logic [2*FLP_WORDSIZE-1:0] fused_data;
+  logic [LOGN-2:0] dest_index;
+  DelayRegister #(.CYCLE_COUNT(LOG_LAT), .BITWIDTH(1)) fused_conjugate_delay (.clk(clk), .in(log_y_in[2:0] == 3'd5), .out(fused_conjugate));
+  DelayRegister #(.CYCLE_COUNT(LOG_LAT), .BITWIDTH(2*FLP_WORDSIZE)) fused_data_delay (.clk(clk), .in(src_valid_1 ? ifft_wr_data_bank1 : ifft_wr_data_bank0), .out(fused_data));
+  DelayRegisterReset #(.CYCLE_COUNT(LOG_LAT), .BITWIDTH(1)) fused_wea_delay (.clk(clk), .rst(rst), .in(src_valid_0 | src_valid_1), .out(fused_wea));
+  DelayRegisterReset #(.CYCLE_COUNT(LOG_LAT+1), .BITWIDTH(1)) fused_done_delay (.clk(clk), .rst(rst), .in(ifft_done), .out(fused_done));
+  assign dest_index = log_e_DP[LOGN-1] & (current_n == 2'd0 ? 'hfff : current_n == 2'd1 ? 'h1fff : 'h3fff);
+
+
+  assign fft_wr_data = fuse_ifft ? fused_data ^ (fused_conjugate<<63) : fft_wr_data_tmp ^ (conjugate<<63);
+  assign fft_wr_addr = fuse_ifft ? {1'd1, dest_index[LOGN-2:1]} : {1'd1, dest_addr_DP[LOGN-2:1]};
+  assign done = fuse_ifft ? fused_done : done_internal_2DP;
+
+  assign fft_bank0_wea = fuse_ifft ? fused_wea && ~dest_index[0] : wea_internal && ~dest_addr_DP[0];
+  assign fft_bank1_wea = fuse_ifft ? fused_wea &&  dest_index[0] : wea_internal &&  dest_addr_DP[0];
 endmodule
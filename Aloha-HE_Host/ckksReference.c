@@ -0,0 +1,805 @@
+/*********************************************
+ * Host reference model of the Aloha-HE
+ * pipelines (see ckksReference.h).
+ *
+ * Orderings of the hardware modelled here:
+ * - Expand writes message value k to slot
+ *   BR((3^k mod 2N - 1)/2) and its conjugate
+ *   to slot BR(N-1-(3^k mod 2N - 1)/2).
+ * - The forward FFT computes
+ *   F_i = sum_s A_s zeta^(-i(2BR(s)+1)), zeta = e^(i*pi/N),
+ *   i.e., N times the coefficients in natural order.
+ *   The inverse FFT computes
+ *   A_j = sum_i c_i zeta^(i(2BR(j)+1)) without 1/N.
+ * - The forward NTT computes a^_j = a(psi^(2BR(j)+1)),
+ *   the inverse NTT is its exact inverse.
+ * BR() reverses log_n bits.
+*********************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+#include <pthread.h>
+#include "ckksReference.h"
+
+#define ROM_LINES         1024
+#define ROM_NTT_BASE      256 // first line of the NTT twiddle factors
+#define ROM_NTT_SLOT_SIZE 71  // lines per pair of NTT constant slots
+#define MONT_LOG_R        72  // Montgomery factor R = 2^72 of MontRed/PWM
+#define TRIVIUM_WARMUP    18  // Trivium updates before the first valid word
+
+typedef unsigned __int128 uint128_t;
+
+static uint128_t rom[ROM_LINES];
+
+typedef struct
+{
+	const TvHeader* hdr;
+	uint32_t n;
+	const uint64_t* input;
+	const int8_t* s;
+	const int8_t* e;
+	uint64_t q[TV_MAX_MODULI];
+	uint64_t psi[TV_MAX_MODULI]; // primitive 2N-th root of unity of the NTT
+	double complex* fft_out;     // result of the forward FFT
+	uint64_t* (*out)[TV_MAX_MODULI];
+} Context;
+
+///////////// Modular arithmetic /////////////
+
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t q)
+{
+	return (uint64_t)((uint128_t)a * b % q);
+}
+
+static uint64_t addMod(uint64_t a, uint64_t b, uint64_t q)
+{
+	uint64_t r = a + b;
+	return r >= q ? r - q : r;
+}
+
+static uint64_t subMod(uint64_t a, uint64_t b, uint64_t q)
+{
+	return a >= b ? a - b : a + q - b;
+}
+
+static uint64_t powMod(uint64_t a, uint64_t e, uint64_t q)
+{
+	uint64_t r = 1;
+	for(; e; e >>= 1, a = mulMod(a, a, q))
+		if(e & 1)
+			r = mulMod(r, a, q);
+	return r;
+}
+
+static uint64_t invMod(uint64_t a, uint64_t q)
+{
+	return powMod(a, q-2, q);
+}
+
+// Small signed value modulo q
+static uint64_t smallToMod(int64_t x, uint64_t q)
+{
+	return x < 0 ? q - (uint64_t)(-x) : (uint64_t)x;
+}
+
+static int64_t signMagnitude6(uint64_t x)
+{
+	return (x & (1<<5)) ? -(int64_t)(x & 0x1f) : (int64_t)(x & 0x1f);
+}
+
+static uint32_t bitReverse(uint32_t x, uint32_t bits)
+{
+	uint32_t r = 0;
+	for(uint32_t i = 0; i < bits; ++i)
+		r |= ((x >> i) & 1) << (bits-1-i);
+	return r;
+}
+
+static uint64_t* allocWords(uint64_t num_words)
+{
+	uint64_t* words = calloc(num_words, sizeof(uint64_t));
+	if(!words)
+	{
+		fprintf(stderr, "Out of memory\n");
+		exit(1);
+	}
+	return words;
+}
+
+///////////// Twiddle factor ROM /////////////
+
+int refLoadRom(const char* path)
+{
+	char line[128];
+	uint32_t num_lines = 0;
+	FILE* f = fopen(path, "r");
+	if(!f)
+	{
+		fprintf(stderr, "Cannot open %s\n", path);
+		return 0;
+	}
+	while(fgets(line, sizeof(line), f) && num_lines < ROM_LINES)
+	{
+		uint128_t v = 0;
+		char* p = line;
+		if(line[0] == '@')
+			continue;
+		for(; *p && *p != '\n' && *p != '\r'; ++p)
+		{
+			char c = *p;
+			v = (v << 4) | (uint128_t)(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+		}
+		rom[num_lines++] = v;
+	}
+	fclose(f);
+	if(num_lines != ROM_LINES)
+	{
+		fprintf(stderr, "%s has %u lines, expected %u\n", path, num_lines, ROM_LINES);
+		return 0;
+	}
+	return 1;
+}
+
+// Returns the 54-bit constant at offset of NTT constant slot (constants_sel).
+// Two slots share the ROM lines, odd slots use the upper half.
+static uint64_t romValue(uint32_t slot, uint32_t offset)
+{
+	uint128_t v = rom[ROM_NTT_BASE + (slot >> 1)*ROM_NTT_SLOT_SIZE + offset];
+	if(slot & 1)
+		v >>= 54;
+	return (uint64_t)v & ((1ull << 54) - 1);
+}
+
+uint64_t refRootOfUnity(uint64_t q, uint32_t ntt_rom_index)
+{
+	// the forward NTT remaps index 15 to slot 16 (see ckks_encrypt)
+	uint32_t slot = ntt_rom_index == 15 ? 16 : ntt_rom_index;
+	uint64_t value = romValue(slot, 0);
+	if(value >= q)
+		return 0;
+	uint64_t psi = mulMod(value, invMod(powMod(2, MONT_LOG_R, q), q), q);
+	return powMod(psi, 1u << 15, q) == q - 1 ? psi : 0;
+}
+
+///////////// Transforms /////////////
+
+// Radix-2 DIF on natural order input, result in bit-reversed order. w[k] = omega^k.
+static void nttDif(uint64_t* a, uint32_t n, const uint64_t* w, uint64_t q)
+{
+	for(uint32_t len = n/2, step = 1; len >= 1; len >>= 1, step <<= 1)
+		for(uint32_t start = 0; start < n; start += 2*len)
+			for(uint32_t j = 0; j < len; ++j)
+			{
+				uint64_t u = a[start+j], v = a[start+j+len];
+				a[start+j] = addMod(u, v, q);
+				a[start+j+len] = mulMod(subMod(u, v, q), w[j*step], q);
+			}
+}
+
+// Radix-2 DIT on bit-reversed input, result in natural order. w[k] = omega^k.
+static void nttDit(uint64_t* a, uint32_t n, const uint64_t* w, uint64_t q)
+{
+	for(uint32_t len = 1, step = n/2; len < n; len <<= 1, step >>= 1)
+		for(uint32_t start = 0; start < n; start += 2*len)
+			for(uint32_t j = 0; j < len; ++j)
+			{
+				uint64_t u = a[start+j], v = mulMod(a[start+j+len], w[j*step], q);
+				a[start+j] = addMod(u, v, q);
+				a[start+j+len] = subMod(u, v, q);
+			}
+}
+
+static void fftDif(double complex* a, uint32_t n, const double complex* w)
+{
+	for(uint32_t len = n/2, step = 1; len >= 1; len >>= 1, step <<= 1)
+		for(uint32_t start = 0; start < n; start += 2*len)
+			for(uint32_t j = 0; j < len; ++j)
+			{
+				double complex u = a[start+j], v = a[start+j+len];
+				a[start+j] = u + v;
+				a[start+j+len] = (u - v) * w[j*step];
+			}
+}
+
+static void fftDit(double complex* a, uint32_t n, const double complex* w)
+{
+	for(uint32_t len = 1, step = n/2; len < n; len <<= 1, step >>= 1)
+		for(uint32_t start = 0; start < n; start += 2*len)
+			for(uint32_t j = 0; j < len; ++j)
+			{
+				double complex u = a[start+j], v = a[start+j+len] * w[j*step];
+				a[start+j] = u + v;
+				a[start+j+len] = u - v;
+			}
+}
+
+// zeta^(sign*k) for k < count, zeta = e^(i*pi*step/n)
+static double complex* complexRoots(uint32_t count, uint32_t n, uint32_t step, int sign)
+{
+	double complex* w = malloc(count*sizeof(double complex));
+	if(!w)
+	{
+		fprintf(stderr, "Out of memory\n");
+		exit(1);
+	}
+	for(uint32_t k = 0; k < count; ++k)
+	{
+		double phi = M_PI * (double)((uint64_t)k*step % (2*n)) / n;
+		w[k] = cos(phi) + sign*I*sin(phi);
+	}
+	return w;
+}
+
+void refNttForward(uint64_t* a, uint32_t n, uint64_t psi, uint64_t q)
+{
+	uint64_t* w = allocWords(n/2);
+	uint64_t omega = mulMod(psi, psi, q), t = 1;
+	for(uint32_t i = 0; i < n; ++i, t = mulMod(t, psi, q))
+		a[i] = mulMod(a[i], t, q);
+	w[0] = 1;
+	for(uint32_t k = 1; k < n/2; ++k)
+		w[k] = mulMod(w[k-1], omega, q);
+	nttDif(a, n, w, q);
+	free(w);
+}
+
+void refNttInverse(uint64_t* a, uint32_t n, uint64_t psi, uint64_t q)
+{
+	uint64_t* w = allocWords(n/2);
+	uint64_t psi_inv = invMod(psi, q);
+	uint64_t omega_inv = mulMod(psi_inv, psi_inv, q);
+	w[0] = 1;
+	for(uint32_t k = 1; k < n/2; ++k)
+		w[k] = mulMod(w[k-1], omega_inv, q);
+	nttDit(a, n, w, q);
+	uint64_t t = invMod(n, q);
+	for(uint32_t i = 0; i < n; ++i, t = mulMod(t, psi_inv, q))
+		a[i] = mulMod(a[i], t, q);
+	free(w);
+}
+
+///////////// Trivium (see Trivium64.v) /////////////
+
+typedef struct
+{
+	uint64_t s11, s12, s21, s22, s31, s32;
+} Trivium;
+
+// {a[n-1:0], b[63:n]}
+static uint64_t trvCat(uint64_t a, uint64_t b, uint32_t n)
+{
+	return (a << (64-n)) | (b >> n);
+}
+
+// Returns the output word of the current state and advances the state.
+static uint64_t triviumNext(Trivium* t)
+{
+	uint64_t t1 = trvCat(t->s12, t->s11, 2) ^ trvCat(t->s12, t->s11, 29);
+	uint64_t t2 = trvCat(t->s22, t->s21, 5) ^ trvCat(t->s22, t->s21, 20);
+	uint64_t t3 = trvCat(t->s32, t->s31, 2) ^ trvCat(t->s32, t->s31, 47);
+	uint64_t t1_next = t1 ^ (trvCat(t->s12, t->s11, 27) & trvCat(t->s12, t->s11, 28)) ^ trvCat(t->s22, t->s21, 14);
+	uint64_t t2_next = t2 ^ (trvCat(t->s22, t->s21, 18) & trvCat(t->s22, t->s21, 19)) ^ trvCat(t->s32, t->s31, 23);
+	uint64_t t3_next = t3 ^ (trvCat(t->s32, t->s31, 45) & trvCat(t->s32, t->s31, 46)) ^ trvCat(t->s12, t->s11, 5);
+
+	t->s12 = t->s11;
+	t->s11 = t3_next;
+	t->s22 = t->s21;
+	t->s21 = t1_next;
+	t->s32 = t->s31;
+	t->s31 = t2_next;
+	return t1 ^ t2 ^ t3;
+}
+
+// Loads the seed and skips the warm-up of TriviumAdapter.sv
+static void triviumInit(Trivium* t, uint64_t seed)
+{
+	*t = (Trivium){seed, 0, 0, 0, 0, 0x0000700000000000ull};
+	for(uint32_t i = 0; i < TRIVIUM_WARMUP; ++i)
+		triviumNext(t);
+}
+
+///////////// Pipeline stages /////////////
+
+// Expand and forward FFT, produces TV_EXPANDED_INPUT and TV_FFT_EXPECTED.
+static void encodeTask(Context* ctx)
+{
+	uint32_t n = ctx->n, log_n = ctx->hdr->log_n;
+	uint64_t* expanded = allocWords(2*n);
+	uint64_t* fft = allocWords(2*n);
+	double complex* a = ctx->fft_out;
+	uint32_t pos = 1;
+
+	for(uint32_t k = 0; k < n/2; ++k, pos = pos*3 % (2*n))
+	{
+		uint32_t index0 = bitReverse((pos-1) >> 1, log_n);
+		uint32_t index1 = bitReverse(n-1-((pos-1) >> 1), log_n);
+		expanded[2*index0] = ctx->input[2*k];
+		expanded[2*index0+1] = ctx->input[2*k+1];
+		expanded[2*index1] = ctx->input[2*k];
+		expanded[2*index1+1] = ctx->input[2*k+1] ^ 0x8000000000000000ull;
+	}
+
+	// slot s holds the evaluation at zeta^(2BR(s)+1), so the slots are the
+	// bit-reversed input of a DIT with omega^-1, followed by the twist zeta^-i
+	double complex* w = complexRoots(n/2, n, 2, -1);
+	double complex* twist = complexRoots(n, n, 1, -1);
+	for(uint32_t s = 0; s < n; ++s)
+	{
+		double re, im;
+		memcpy(&re, &expanded[2*s], sizeof(double));
+		memcpy(&im, &expanded[2*s+1], sizeof(double));
+		a[s] = re + I*im;
+	}
+	fftDit(a, n, w);
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		a[i] *= twist[i];
+		double re = ldexp(creal(a[i]), ctx->hdr->log_scale - (int)log_n);
+		double im = ldexp(cimag(a[i]), ctx->hdr->log_scale - (int)log_n);
+		memcpy(&fft[2*i], &re, sizeof(double));
+		memcpy(&fft[2*i+1], &im, sizeof(double));
+	}
+	free(w);
+	free(twist);
+
+	ctx->out[TV_EXPANDED_INPUT][0] = expanded;
+	ctx->out[TV_FFT_EXPECTED][0] = fft;
+}
+
+// Error sampling concurrent to the forward FFT (see RandomSampling.sv),
+// produces TV_V_POLY, TV_E0_POLY and TV_E1_POLY.
+// Samples v (0, 1 or 3 for -1), e0 and e1 (6-bit sign-magnitude) from seed.
+static void sampleErrors(uint64_t seed, uint32_t n, uint64_t* v, uint64_t* e0, uint64_t* e1)
+{
+	uint32_t num_e = 0, num_v = 0;
+	Trivium t;
+
+	triviumInit(&t, seed);
+	while(num_e < 2*n || num_v < n)
+	{
+		uint64_t w = triviumNext(&t);
+		if(num_e < 2*n)
+		{
+			// centered binomial distribution, stored as sign-magnitude
+			int32_t d = __builtin_popcountll(w & 0x1fffff) - __builtin_popcountll((w >> 21) & 0x1fffff);
+			uint64_t sm = d < 0 ? (1u << 5) | (uint64_t)(-d) : (uint64_t)d;
+			if(num_e < n)
+				e0[num_e] = sm;
+			else
+				e1[num_e-n] = sm;
+			num_e++;
+		}
+		uint32_t bits = (w >> 48) & 0xffff;
+		if(num_v < n && bits != 0xffff)
+			v[num_v++] = bits < 0x5555 ? 0 : bits < 0xaaaa ? 1 : 3;
+	}
+}
+
+static void errorTask(Context* ctx)
+{
+	uint32_t n = ctx->n;
+	uint64_t* v = allocWords(n);
+	uint64_t* e0 = allocWords(n);
+	uint64_t* e1 = allocWords(n);
+
+	sampleErrors(ctx->hdr->error_polys_seed, n, v, e0, e1);
+	ctx->out[TV_V_POLY][0] = v;
+	ctx->out[TV_E0_POLY][0] = e0;
+	ctx->out[TV_E1_POLY][0] = e1;
+}
+
+void refSamplePk1(uint64_t seed, uint32_t log_q, uint64_t q, uint32_t n, uint64_t* pk1)
+{
+	uint32_t num = 0;
+	Trivium t;
+
+	triviumInit(&t, seed);
+	while(num < n)
+	{
+		uint64_t candidate = (triviumNext(&t) & ((1ull << 54) - 1)) >> (8 - log_q);
+		if(candidate < q)
+			pk1[num++] = candidate;
+	}
+}
+
+// Uniform sampling of pk1 concurrent to the NTT of the message.
+static void pk1Task(Context* ctx, uint32_t j)
+{
+	uint64_t* pk1 = allocWords(ctx->n);
+	refSamplePk1(ctx->hdr->pk1_seeds[j], ctx->hdr->log_q[j], ctx->q[j], ctx->n, pk1);
+	ctx->out[TV_PK1][j] = pk1;
+}
+
+// RNS conversion of one FFT coefficient (see RNS.sv): the double is scaled
+// by 2^log_scale/N, rounded (half away from zero) and reduced modulo q.
+static uint64_t rnsCoefficient(double x, int32_t log_scale, uint32_t log_n, uint64_t q)
+{
+	uint64_t bits, mag;
+	memcpy(&bits, &x, sizeof(double));
+	uint32_t exponent = (bits >> 52) & 0x7ff;
+	uint64_t significand = (bits & ((1ull << 52) - 1)) | (1ull << 52);
+	int32_t shift = (int32_t)exponent - 1075 + log_scale - (int32_t)log_n;
+
+	if(exponent == 0)
+		return 0;
+	if(shift >= 0)
+		mag = mulMod(significand % q, powMod(2, shift, q), q);
+	else if(-shift - 1 >= 53)
+		mag = 0;
+	else
+	{
+		uint64_t t = significand >> (-shift - 1);
+		mag = ((t >> 1) + (t & 1)) % q;
+	}
+	return (bits >> 63) && mag ? q - mag : mag;
+}
+
+// RNS, NTTs, key pair and PWM of modulus j.
+static void encryptTask(Context* ctx, uint32_t j)
+{
+	uint32_t n = ctx->n;
+	uint64_t q = ctx->q[j], psi = ctx->psi[j];
+	uint64_t* message = allocWords(n);
+	uint64_t* m_ntt = allocWords(n);
+	uint64_t* v_ntt = allocWords(n);
+	uint64_t* e1_ntt = allocWords(n);
+	uint64_t* s_ntt = allocWords(n);
+	uint64_t* e_ntt = allocWords(n);
+	uint64_t* pk0 = allocWords(n);
+	uint64_t* c0 = allocWords(n);
+	uint64_t* c1 = allocWords(n);
+	const uint64_t* pk1 = ctx->out[TV_PK1][j];
+	const uint64_t* v = ctx->out[TV_V_POLY][0];
+	const uint64_t* e0 = ctx->out[TV_E0_POLY][0];
+	const uint64_t* e1 = ctx->out[TV_E1_POLY][0];
+	uint64_t r = powMod(2, MONT_LOG_R, q);
+
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		message[i] = rnsCoefficient(creal(ctx->fft_out[i]), ctx->hdr->log_scale, ctx->hdr->log_n, q);
+		m_ntt[i] = addMod(message[i], smallToMod(signMagnitude6(e0[i]), q), q);
+		v_ntt[i] = v[i] == 3 ? q - 1 : v[i];
+		e1_ntt[i] = smallToMod(signMagnitude6(e1[i]), q);
+		s_ntt[i] = smallToMod(ctx->s[i], q);
+		e_ntt[i] = smallToMod(ctx->e[i], q);
+	}
+	refNttForward(m_ntt, n, psi, q);
+	refNttForward(v_ntt, n, psi, q);
+	refNttForward(e1_ntt, n, psi, q);
+	refNttForward(s_ntt, n, psi, q);
+	refNttForward(e_ntt, n, psi, q);
+
+	// The PWM computes v*pk1*R^-1, so the public polynomial is a = pk1*R^-1.
+	// pk0 = (-a*s + e)*R  =>  c0 + c1*s = m + e0 + v*e + e1*s
+	uint64_t r_inv = invMod(r, q);
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		pk0[i] = subMod(mulMod(e_ntt[i], r, q), mulMod(pk1[i], s_ntt[i], q), q);
+		c0[i] = addMod(m_ntt[i], mulMod(mulMod(v_ntt[i], pk0[i], q), r_inv, q), q);
+		c1[i] = addMod(e1_ntt[i], mulMod(mulMod(v_ntt[i], pk1[i], q), r_inv, q), q);
+	}
+
+	if(j == 0)
+	{
+		// the secret key is stored as s*R, so that the PWM yields c1*s
+		uint64_t* sk = allocWords(n);
+		for(uint32_t i = 0; i < n; ++i)
+			sk[i] = mulMod(s_ntt[i], r, q);
+		ctx->out[TV_SK][0] = sk;
+	}
+
+	free(m_ntt);
+	free(s_ntt);
+	free(e_ntt);
+	ctx->out[TV_MESSAGE_AFTER_RNS][j] = message;
+	ctx->out[TV_V_POLY_NTT][j] = v_ntt;
+	ctx->out[TV_E1_POLY_NTT][j] = e1_ntt;
+	ctx->out[TV_PK0][j] = pk0;
+	ctx->out[TV_EXPECTED_C0][j] = c0;
+	ctx->out[TV_EXPECTED_C1][j] = c1;
+}
+
+// Decryption and decoding with the first modulus: PWM, inverse NTT, I2F,
+// inverse FFT and projection.
+static void decryptTask(Context* ctx)
+{
+	uint32_t n = ctx->n, log_n = ctx->hdr->log_n;
+	uint64_t q = ctx->q[0];
+	uint64_t* c0 = allocWords(n);
+	uint64_t* c1 = allocWords(n);
+	uint64_t* m_ntt = allocWords(n);
+	uint64_t* m = allocWords(n);
+	uint64_t* ifft_input = allocWords(2*n);
+	uint64_t* ifft = allocWords(2*n);
+	uint64_t* projected = allocWords(n);
+	const uint64_t* sk = ctx->out[TV_SK][0];
+	uint64_t r_inv = invMod(powMod(2, MONT_LOG_R, q), q);
+
+	memcpy(c0, ctx->out[TV_EXPECTED_C0][0], n*sizeof(uint64_t));
+	memcpy(c1, ctx->out[TV_EXPECTED_C1][0], n*sizeof(uint64_t));
+	for(uint32_t i = 0; i < n; ++i)
+		m_ntt[i] = addMod(c0[i], mulMod(mulMod(c1[i], sk[i], q), r_inv, q), q);
+	memcpy(m, m_ntt, n*sizeof(uint64_t));
+	refNttInverse(m, n, ctx->psi[0], q);
+
+	// I2F: centered representative times 2^-log_scale, imaginary part 0
+	double complex* a = malloc(n*sizeof(double complex));
+	if(!a)
+	{
+		fprintf(stderr, "Out of memory\n");
+		exit(1);
+	}
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		int64_t centered = m[i] > q/2 ? -(int64_t)(q - m[i]) : (int64_t)m[i];
+		double re = ldexp((double)centered, -ctx->hdr->log_scale);
+		memcpy(&ifft_input[2*i], &re, sizeof(double));
+		a[i] = re;
+	}
+
+	// inverse FFT: twist by zeta^i, then DIF with omega (bit-reversed output)
+	double complex* w = complexRoots(n/2, n, 2, 1);
+	double complex* twist = complexRoots(n, n, 1, 1);
+	for(uint32_t i = 0; i < n; ++i)
+		a[i] *= twist[i];
+	fftDif(a, n, w);
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		double re = creal(a[i]), im = cimag(a[i]);
+		memcpy(&ifft[2*i], &re, sizeof(double));
+		memcpy(&ifft[2*i+1], &im, sizeof(double));
+	}
+
+	// projection (see swProject)
+	uint32_t pos = 1;
+	for(uint32_t k = 0; k < n/2; ++k, pos = pos*3 % (2*n))
+	{
+		uint32_t index = bitReverse((pos-1) >> 1, log_n);
+		if(index < n/2)
+		{
+			projected[2*k] = ifft[2*index];
+			projected[2*k+1] = ifft[2*index+1];
+		}
+		else
+		{
+			index = n - (index+1);
+			projected[2*k] = ifft[2*index];
+			projected[2*k+1] = ifft[2*index+1] ^ 0x8000000000000000ull;
+		}
+	}
+	free(a);
+	free(w);
+	free(twist);
+
+	ctx->out[TV_C0_TO_DECRYPT][0] = c0;
+	ctx->out[TV_C1_TO_DECRYPT][0] = c1;
+	ctx->out[TV_DECRYPTED_M_NTT][0] = m_ntt;
+	ctx->out[TV_INTT_M_REFERENCE][0] = m;
+	ctx->out[TV_IFFT_INPUT][0] = ifft_input;
+	ctx->out[TV_IFFT_REFERENCE][0] = ifft;
+	ctx->out[TV_PROJECTED_REFERENCE][0] = projected;
+}
+
+///////////// Scheduling /////////////
+
+typedef struct
+{
+	Context* ctx;
+	void (*task)(Context*, uint32_t);
+	uint32_t num_tasks;
+	uint32_t next;
+} TaskQueue;
+
+static void* worker(void* arg)
+{
+	TaskQueue* queue = arg;
+	uint32_t i;
+	while((i = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED)) < queue->num_tasks)
+		queue->task(queue->ctx, i);
+	return NULL;
+}
+
+// Runs task(ctx, 0..num_tasks-1) on up to num_threads threads.
+static void runTasks(Context* ctx, void (*task)(Context*, uint32_t), uint32_t num_tasks, uint32_t num_threads)
+{
+	TaskQueue queue = {ctx, task, num_tasks, 0};
+	pthread_t threads[64];
+	uint32_t num_workers = num_threads < num_tasks ? num_threads : num_tasks;
+	if(num_workers > 64)
+		num_workers = 64;
+
+	for(uint32_t i = 1; i < num_workers; ++i)
+		pthread_create(&threads[i], NULL, worker, &queue);
+	worker(&queue);
+	for(uint32_t i = 1; i < num_workers; ++i)
+		pthread_join(threads[i], NULL);
+}
+
+// Stage 1: encoding, error sampling and pk1 sampling are independent.
+static void samplingStage(Context* ctx, uint32_t i)
+{
+	if(i == 0)
+		encodeTask(ctx);
+	else if(i == 1)
+		errorTask(ctx);
+	else
+		pk1Task(ctx, i-2);
+}
+
+static void encryptStage(Context* ctx, uint32_t i)
+{
+	encryptTask(ctx, i);
+}
+
+int refCompute(const TvHeader* hdr, const uint64_t* input, const int8_t* s, const int8_t* e,
+               uint64_t* out[TV_NUM_IDS][TV_MAX_MODULI], uint32_t num_threads)
+{
+	Context ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.hdr = hdr;
+	ctx.n = 1u << hdr->log_n;
+	ctx.input = input;
+	ctx.s = s;
+	ctx.e = e;
+	ctx.out = out;
+
+	for(uint32_t j = 0; j < hdr->num_moduli; ++j)
+	{
+		ctx.q[j] = (1ull << (46+hdr->log_q[j])) - ((uint64_t)hdr->qm[j] << 24) + 1;
+		uint64_t psi = refRootOfUnity(ctx.q[j], hdr->ntt_rom_index[j]);
+		if(!psi)
+		{
+			fprintf(stderr, "NTT ROM index %u does not hold twiddle factors of modulus %u (q = 0x%llx)\n",
+					hdr->ntt_rom_index[j], j, (unsigned long long)ctx.q[j]);
+			return 0;
+		}
+		ctx.psi[j] = powMod(psi, (1u << 15) >> hdr->log_n, ctx.q[j]);
+	}
+
+	// the inverse NTT of the decryption uses slot 17 for index 15 and slot 15
+	// otherwise (see testAloha), warn if these are not the inverse twiddles
+	uint32_t inv_slot = hdr->ntt_rom_index[0] == 15 ? 17 : 15;
+	uint64_t psi_inv = mulMod(romValue(inv_slot, 0), invMod(powMod(2, MONT_LOG_R, ctx.q[0]), ctx.q[0]), ctx.q[0]);
+	if(mulMod(psi_inv, refRootOfUnity(ctx.q[0], hdr->ntt_rom_index[0]), ctx.q[0]) != 1)
+		fprintf(stderr, "Warning: ROM slot %u does not hold the inverse twiddle factors of modulus 0, "
+				"the hardware decryption will not match the reference\n", inv_slot);
+
+	ctx.fft_out = malloc(ctx.n*sizeof(double complex));
+	if(!ctx.fft_out)
+	{
+		fprintf(stderr, "Out of memory\n");
+		return 0;
+	}
+	if(num_threads == 0)
+		num_threads = 1;
+
+	runTasks(&ctx, samplingStage, 2 + hdr->num_moduli, num_threads);
+	runTasks(&ctx, encryptStage, hdr->num_moduli, num_threads);
+	decryptTask(&ctx);
+
+	free(ctx.fft_out);
+	return 1;
+}
+
+///////////// Key generation /////////////
+
+// NTT(v) and NTT(e1) modulo q of the encode program errors v and e1
+static void keyErrorsNtt(const uint64_t* v, const uint64_t* e1, uint32_t n, uint64_t psi, uint64_t q,
+                         uint64_t* v_ntt, uint64_t* e1_ntt)
+{
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		v_ntt[i] = v[i] == 3 ? q - 1 : v[i];
+		e1_ntt[i] = smallToMod(signMagnitude6(e1[i]), q);
+	}
+	refNttForward(v_ntt, n, psi, q);
+	refNttForward(e1_ntt, n, psi, q);
+}
+
+void refKeygen(uint32_t n, uint32_t num_moduli, const uint64_t* q, const uint64_t* psi, const uint32_t* log_q,
+               uint64_t sk_seed, const uint64_t* pk1_seeds, uint64_t** sk, uint64_t** pk0)
+{
+	uint64_t* v = allocWords(n);
+	uint64_t* e0 = allocWords(n);
+	uint64_t* e1 = allocWords(n);
+	uint64_t* v_ntt = allocWords(n);
+	uint64_t* e1_ntt = allocWords(n);
+	uint64_t* pk1 = allocWords(n);
+
+	sampleErrors(sk_seed, n, v, e0, e1);
+	for(uint32_t j = 0; j < num_moduli; ++j)
+	{
+		uint64_t r = powMod(2, MONT_LOG_R, q[j]);
+		uint64_t r_inv = invMod(r, q[j]);
+
+		keyErrorsNtt(v, e1, n, psi[j], q[j], v_ntt, e1_ntt);
+		refSamplePk1(pk1_seeds[j], log_q[j], q[j], n, pk1);
+		for(uint32_t i = 0; i < n; ++i)
+		{
+			uint64_t c1 = addMod(e1_ntt[i], mulMod(mulMod(v_ntt[i], pk1[i], q[j]), r_inv, q[j]), q[j]);
+			sk[j][i] = mulMod(v_ntt[i], r, q[j]);
+			pk0[j][i] = subMod(0, mulMod(c1, r, q[j]), q[j]);
+		}
+	}
+	free(v); free(e0); free(e1);
+	free(v_ntt); free(e1_ntt); free(pk1);
+}
+
+uint32_t refGaloisElement(int32_t steps, uint32_t n)
+{
+	uint32_t order = n/2; // order of 3 modulo 2n
+	uint32_t e = (uint32_t)((steps % (int32_t)order) + (int32_t)order) % order;
+	return (uint32_t)powMod(3, e, 2*n);
+}
+
+void refAutomorphism(uint64_t* out, const uint64_t* in, uint32_t n, uint32_t galois, int ntt_domain, uint64_t q)
+{
+	uint32_t log_n = __builtin_ctz(n);
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		if(ntt_domain)
+		{
+			uint32_t e = (uint32_t)((uint64_t)galois*(2*bitReverse(i, log_n)+1) % (2*n));
+			out[i] = in[bitReverse((e-1) >> 1, log_n)];
+		}
+		else
+		{
+			uint32_t d = (uint32_t)((uint64_t)galois*i % (2*n));
+			out[d % n] = d >= n ? subMod(0, in[i], q) : in[i];
+		}
+	}
+}
+
+// Key switching key of refRlkgen (galois == 0) and refGalkgen
+static void switchKeygen(uint32_t n, uint32_t num_moduli, const uint64_t* q, const uint64_t* psi, const uint32_t* log_q,
+                         const uint64_t* error_seeds, const uint64_t* seeds, uint64_t** sk, uint64_t** ksk,
+                         uint32_t galois)
+{
+	uint64_t* v = allocWords(n);
+	uint64_t* e0 = allocWords(n);
+	uint64_t* e1 = allocWords(n);
+	uint64_t* v_ntt = allocWords(n);
+	uint64_t* e1_ntt = allocWords(n);
+	uint64_t* pk1 = allocWords(n);
+	uint64_t* s_sigma = allocWords(n);
+
+	for(uint32_t i = 0; i < num_moduli; ++i)
+	{
+		sampleErrors(error_seeds[i], n, v, e0, e1);
+		for(uint32_t j = 0; j < num_moduli; ++j)
+		{
+			uint64_t r_inv = invMod(powMod(2, MONT_LOG_R, q[j]), q[j]);
+			uint64_t* b = ksk[i*num_moduli + j];
+
+			keyErrorsNtt(v, e1, n, psi[j], q[j], v_ntt, e1_ntt);
+			refSamplePk1(seeds[i*num_moduli + j], log_q[j], q[j], n, pk1);
+			if(i == j && galois)
+				refAutomorphism(s_sigma, sk[j], n, galois, 1, q[j]);
+			for(uint32_t k = 0; k < n; ++k)
+			{
+				uint64_t s = mulMod(sk[j][k], r_inv, q[j]);
+				b[k] = subMod(e1_ntt[k], mulMod(mulMod(s, pk1[k], q[j]), r_inv, q[j]), q[j]);
+				if(i == j)
+					b[k] = addMod(b[k], galois ? mulMod(s_sigma[k], r_inv, q[j]) : mulMod(s, s, q[j]), q[j]);
+			}
+		}
+	}
+	free(v); free(e0); free(e1);
+	free(v_ntt); free(e1_ntt); free(pk1); free(s_sigma);
+}
+
+void refRlkgen(uint32_t n, uint32_t num_moduli, const uint64_t* q, const uint64_t* psi, const uint32_t* log_q,
+               const uint64_t* rlk_error_seeds, const uint64_t* rlk_seeds, uint64_t** sk, uint64_t** rlk)
+{
+	switchKeygen(n, num_moduli, q, psi, log_q, rlk_error_seeds, rlk_seeds, sk, rlk, 0);
+}
+
+void refGalkgen(uint32_t n, uint32_t num_moduli, const uint64_t* q, const uint64_t* psi, const uint32_t* log_q,
+                const uint64_t* gk_error_seeds, const uint64_t* gk_seeds, uint64_t** sk, uint64_t** gk,
+                uint32_t galois)
+{
+	switchKeygen(n, num_moduli, q, psi, log_q, gk_error_seeds, gk_seeds, sk, gk, galois);
+}
@@ -0,0 +1,67 @@
+#ifndef ALOHA_HOST_CKKSREFERENCE_H_
+#define ALOHA_HOST_CKKSREFERENCE_H_
+
+#include <stdint.h>
+#include "../Aloha-HE_Software/Testing/testVectors.h"
+
+// Bit-exact host model of the Aloha-HE encode+encrypt and decrypt+decode
+// pipelines. It follows the hardware's orderings (expand, DIF FFT, NTT),
+// the 1/N scaling of the RNS step, the log_scale encoding and the
+// Montgomery factor R = 2^72 of the PWM and the twiddle factor ROM.
+
+// Loads the twiddle factor ROM (TwFctrCache_RNSConsts.mem). Returns 0 on error.
+int refLoadRom(const char* path);
+
+// Returns the primitive 2^16-th root of unity modulo q that the NTT of
+// the hardware uses for ntt_rom_index, or 0 if the ROM slot does not
+// hold a root of unity for q.
+uint64_t refRootOfUnity(uint64_t q, uint32_t ntt_rom_index);
+
+// Forward NTT of the hardware: a^_j = a(psi^(2BR(j)+1)) with psi a
+// primitive 2n-th root of unity, n a power of two.
+void refNttForward(uint64_t* a, uint32_t n, uint64_t psi, uint64_t q);
+
+// Inverse NTT of the hardware (including the scaling by 1/n)
+void refNttInverse(uint64_t* a, uint32_t n, uint64_t psi, uint64_t q);
+
+// Computes all entries of the container described by hdr except TV_INPUT:
+// input is the message (N/2 complex values, interleaved re/im), s and e
+// (N coefficients each) are the ternary secret key and the key error.
+// pk0 and sk are derived from s, e and the pk1 sampled by the hardware,
+// so the generated ciphertexts decrypt correctly. out[id][modulus] is
+// allocated with malloc and owned by the caller. Moduli and stages are
+// processed by num_threads threads. Returns 0 on error.
+int refCompute(const TvHeader* hdr, const uint64_t* input, const int8_t* s, const int8_t* e,
+               uint64_t* out[TV_NUM_IDS][TV_MAX_MODULI], uint32_t num_threads);
+
+// Uniform pk1 of the hardware sampled from seed for q = 2^(log_q+46) - (qm << 24) + 1.
+void refSamplePk1(uint64_t seed, uint32_t log_q, uint64_t q, uint32_t n, uint64_t* pk1);
+
+// Key generation of ckks_keygen (see ckksAccelerator.c) for the moduli q[j]
+// with the primitive 2n-th roots of unity psi[j] of the NTT: s is the v and
+// the key error the negated e1 that the encode program samples from sk_seed.
+// sk[j] = NTT(s)*R and pk0[j] = (-a*s + e)*R with a = pk1*R^-1 and pk1
+// sampled from pk1_seeds[j]. sk[j] and pk0[j] hold n words each.
+void refKeygen(uint32_t n, uint32_t num_moduli, const uint64_t* q, const uint64_t* psi, const uint32_t* log_q,
+               uint64_t sk_seed, const uint64_t* pk1_seeds, uint64_t** sk, uint64_t** pk0);
+
+// Relinearization key of ckks_rlkgen for the secret key sk of refKeygen:
+// rlk[i*num_moduli+j] = NTT(e_i) - NTT(s)*a_ij + [i == j]*NTT(s)^2 mod q[j]
+// with e_i the e1 sampled from rlk_error_seeds[i] and a_ij = pk1*R^-1 with
+// pk1 sampled from rlk_seeds[i*num_moduli+j].
+void refRlkgen(uint32_t n, uint32_t num_moduli, const uint64_t* q, const uint64_t* psi, const uint32_t* log_q,
+               const uint64_t* rlk_error_seeds, const uint64_t* rlk_seeds, uint64_t** sk, uint64_t** rlk);
+
+// Galois key of ckks_galkgen: as refRlkgen with s(X^galois) instead of s^2.
+void refGalkgen(uint32_t n, uint32_t num_moduli, const uint64_t* q, const uint64_t* psi, const uint32_t* log_q,
+                const uint64_t* gk_error_seeds, const uint64_t* gk_seeds, uint64_t** sk, uint64_t** gk,
+                uint32_t galois);
+
+// Galois element 3^steps mod 2n that rotates the slots by steps (see ckks_galois_element).
+uint32_t refGaloisElement(int32_t steps, uint32_t n);
+
+// Automorphism X -> X^galois of the Automorphism instruction: a permutation
+// in the NTT domain (ntt_domain != 0), with X^n = -1 in the coefficient domain.
+void refAutomorphism(uint64_t* out, const uint64_t* in, uint32_t n, uint32_t galois, int ntt_domain, uint64_t q);
+
+#endif /* ALOHA_HOST_CKKSREFERENCE_H_ */
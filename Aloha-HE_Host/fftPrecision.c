@@ -0,0 +1,283 @@
+/*********************************************
+ * This host tool estimates the precision loss
+ * of an FFT with fewer than 52 significand
+ * bits against the double precision FFT. It
+ * is a study only, the accelerator keeps the
+ * double precision FFT.
+ *
+ * Build: gcc -O2 -o fftPrecision fftPrecision.c -lm
+ * Usage: fftPrecision [-n log_n] [-s log_scale] [-t trials] [-b sig_bits]
+ *
+ * The reduced FFT truncates the significand of
+ * the operands and results of every addition
+ * and multiplication to sig_bits bits (towards
+ * zero, the rounding of FLPAdder and
+ * FLPMultiplier) and
+ * multiplies complex numbers with four real
+ * multiplications and two additions like
+ * ComplexMultiplier. The transforms follow the
+ * formulation of ckksReference.c.
+ *
+ * Encode: the message (uniform in the unit
+ * square) is transformed and scaled to
+ * integers with 2^log_scale. Reported are the
+ * largest deviation of the scaled coefficients
+ * and the fraction of coefficients that RNS
+ * rounds to a different integer.
+ * Decode: the rounded coefficients of the
+ * double path are scaled by 2^-log_scale
+ * (I2F) and transformed back. Reported are the
+ * largest deviation of the decoded slots and
+ * the remaining precision in bits relative to
+ * the message magnitude of 1.
+ * Without -b, sig_bits runs from 52 down to 20.
+*********************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+typedef struct
+{
+	double re, im;
+} Complex;
+
+static uint32_t sig_bits;
+
+// truncates the significand of x to sig_bits bits
+static double trunc_sig(double x)
+{
+	uint64_t bits;
+	memcpy(&bits, &x, sizeof(double));
+	bits &= ~((1ull << (52 - sig_bits)) - 1);
+	memcpy(&x, &bits, sizeof(double));
+	return x;
+}
+
+static double add(double a, double b)
+{
+	return trunc_sig(trunc_sig(a) + trunc_sig(b));
+}
+
+static double mul(double a, double b)
+{
+	return trunc_sig(trunc_sig(a) * trunc_sig(b));
+}
+
+static Complex cadd(Complex a, Complex b)
+{
+	return (Complex){add(a.re, b.re), add(a.im, b.im)};
+}
+
+static Complex csub(Complex a, Complex b)
+{
+	return (Complex){add(a.re, -b.re), add(a.im, -b.im)};
+}
+
+static Complex cmul(Complex a, Complex b)
+{
+	return (Complex){add(mul(a.re, b.re), -mul(a.im, b.im)), add(mul(a.re, b.im), mul(a.im, b.re))};
+}
+
+static uint32_t bitReverse(uint32_t x, uint32_t bits)
+{
+	uint32_t r = 0;
+	for(uint32_t i = 0; i < bits; ++i)
+		r |= ((x >> i) & 1) << (bits - 1 - i);
+	return r;
+}
+
+static void fftDif(Complex* a, uint32_t n, const Complex* w)
+{
+	for(uint32_t len = n/2, step = 1; len >= 1; len >>= 1, step <<= 1)
+		for(uint32_t start = 0; start < n; start += 2*len)
+			for(uint32_t j = 0; j < len; ++j)
+			{
+				Complex u = a[start+j], v = a[start+j+len];
+				a[start+j] = cadd(u, v);
+				a[start+j+len] = cmul(csub(u, v), w[j*step]);
+			}
+}
+
+static void fftDit(Complex* a, uint32_t n, const Complex* w)
+{
+	for(uint32_t len = 1, step = n/2; len < n; len <<= 1, step >>= 1)
+		for(uint32_t start = 0; start < n; start += 2*len)
+			for(uint32_t j = 0; j < len; ++j)
+			{
+				Complex u = a[start+j], v = cmul(a[start+j+len], w[j*step]);
+				a[start+j] = cadd(u, v);
+				a[start+j+len] = csub(u, v);
+			}
+}
+
+// zeta^(sign*k) for k < count, zeta = e^(i*pi*step/n)
+static void complexRoots(Complex* w, uint32_t count, uint32_t n, uint32_t step, int sign)
+{
+	for(uint32_t k = 0; k < count; ++k)
+	{
+		double phi = M_PI * (double)((uint64_t)k*step % (2*n)) / n;
+		w[k] = (Complex){cos(phi), sign*sin(phi)};
+	}
+}
+
+// Expand and forward FFT (see encodeTask in ckksReference.c), without the
+// scaling by 2^log_scale/N.
+static void encode(Complex* a, const Complex* msg, uint32_t log_n, const Complex* w, const Complex* twist)
+{
+	uint32_t n = 1u << log_n, pos = 1;
+	for(uint32_t k = 0; k < n/2; ++k, pos = pos*3 % (2*n))
+	{
+		a[bitReverse((pos-1) >> 1, log_n)] = msg[k];
+		a[bitReverse(n-1-((pos-1) >> 1), log_n)] = (Complex){msg[k].re, -msg[k].im};
+	}
+	fftDit(a, n, w);
+	for(uint32_t i = 0; i < n; ++i)
+		a[i] = cmul(a[i], twist[i]);
+}
+
+// Inverse FFT and projection (see decryptTask in ckksReference.c).
+static void decode(Complex* msg, Complex* a, uint32_t log_n, const Complex* w, const Complex* twist)
+{
+	uint32_t n = 1u << log_n, pos = 1;
+	for(uint32_t i = 0; i < n; ++i)
+		a[i] = cmul(a[i], twist[i]);
+	fftDif(a, n, w);
+	for(uint32_t k = 0; k < n/2; ++k, pos = pos*3 % (2*n))
+		msg[k] = a[bitReverse((pos-1) >> 1, log_n)];
+}
+
+typedef struct
+{
+	double encode_max_error;   // in units of the scaled integer coefficients
+	double encode_flip_rate;   // fraction of coefficients rounded differently
+	double decode_max_error;   // in units of the message
+} Result;
+
+static int analyze(uint32_t log_n, int32_t log_scale, uint32_t trials, const uint32_t* bits, uint32_t num_bits, Result* results)
+{
+	uint32_t n = 1u << log_n;
+	Complex* msg = malloc(n/2*sizeof(Complex));
+	Complex* dec = malloc(n/2*sizeof(Complex));
+	Complex* dec_ref = malloc(n/2*sizeof(Complex));
+	Complex* a = malloc(n*sizeof(Complex));
+	Complex* a_ref = malloc(n*sizeof(Complex));
+	Complex* coeffs = malloc(n*sizeof(Complex));
+	Complex* w_enc = malloc(n/2*sizeof(Complex));
+	Complex* w_dec = malloc(n/2*sizeof(Complex));
+	Complex* twist_enc = malloc(n*sizeof(Complex));
+	Complex* twist_dec = malloc(n*sizeof(Complex));
+	double scale = ldexp(1.0, log_scale - (int)log_n);
+	int ok = msg && dec && dec_ref && a && a_ref && coeffs && w_enc && w_dec && twist_enc && twist_dec;
+
+	if(ok)
+	{
+		complexRoots(w_enc, n/2, n, 2, -1);
+		complexRoots(twist_enc, n, n, 1, -1);
+		complexRoots(w_dec, n/2, n, 2, 1);
+		complexRoots(twist_dec, n, n, 1, 1);
+		memset(results, 0, num_bits*sizeof(Result));
+	}
+
+	for(uint32_t t = 0; t < trials && ok; ++t)
+	{
+		for(uint32_t k = 0; k < n/2; ++k)
+			msg[k] = (Complex){2.0*rand()/RAND_MAX - 1.0, 2.0*rand()/RAND_MAX - 1.0};
+
+		// double path, the decoder input are its rounded coefficients (I2F)
+		sig_bits = 52;
+		encode(a_ref, msg, log_n, w_enc, twist_enc);
+		for(uint32_t i = 0; i < n; ++i)
+			coeffs[i] = (Complex){ldexp(round(a_ref[i].re*scale), -log_scale), 0.0};
+		memcpy(a, coeffs, n*sizeof(Complex));
+		decode(dec_ref, a, log_n, w_dec, twist_dec);
+
+		for(uint32_t b = 0; b < num_bits; ++b)
+		{
+			Result* r = &results[b];
+			uint64_t flips = 0;
+
+			sig_bits = bits[b];
+			encode(a, msg, log_n, w_enc, twist_enc);
+			for(uint32_t i = 0; i < n; ++i)
+			{
+				double x = a[i].re*scale, x_ref = a_ref[i].re*scale;
+				if(fabs(x - x_ref) > r->encode_max_error)
+					r->encode_max_error = fabs(x - x_ref);
+				flips += round(x) != round(x_ref);
+			}
+			r->encode_flip_rate += (double)flips/n/trials;
+
+			memcpy(a, coeffs, n*sizeof(Complex));
+			decode(dec, a, log_n, w_dec, twist_dec);
+			for(uint32_t k = 0; k < n/2; ++k)
+			{
+				double e = fmax(fabs(dec[k].re - dec_ref[k].re), fabs(dec[k].im - dec_ref[k].im));
+				if(e > r->decode_max_error)
+					r->decode_max_error = e;
+			}
+		}
+	}
+
+	free(msg); free(dec); free(dec_ref); free(a); free(a_ref); free(coeffs);
+	free(w_enc); free(w_dec); free(twist_enc); free(twist_dec);
+	return ok;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t log_n = 15, trials = 4, num_bits = 0;
+	int32_t log_scale = 30;
+	uint32_t bits[52];
+	Result results[52];
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-n") && i + 1 < argc)
+			log_n = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-s") && i + 1 < argc)
+			log_scale = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-t") && i + 1 < argc)
+			trials = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-b") && i + 1 < argc && num_bits < 52)
+			bits[num_bits++] = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: %s [-n log_n] [-s log_scale] [-t trials] [-b sig_bits]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(log_n < 2 || log_n > 16 || !trials)
+	{
+		fprintf(stderr, "log_n must be in [2, 16] and trials positive\n");
+		return 1;
+	}
+	for(uint32_t b = 0; b < num_bits; ++b)
+	{
+		if(bits[b] < 1 || bits[b] > 52)
+		{
+			fprintf(stderr, "sig_bits must be in [1, 52]\n");
+			return 1;
+		}
+	}
+	if(!num_bits)
+		for(uint32_t b = 52; b >= 20; b -= 4)
+			bits[num_bits++] = b;
+
+	srand(1);
+	if(!analyze(log_n, log_scale, trials, bits, num_bits, results))
+	{
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	printf("N = 2^%u, log_scale = %d, %u trials\n", log_n, log_scale, trials);
+	printf("%8s %16s %12s %16s %14s\n", "sig_bits", "encode_max_err", "flip_rate", "decode_max_err", "decode_bits");
+	for(uint32_t b = 0; b < num_bits; ++b)
+		printf("%8u %16.3e %12.3e %16.3e %14.1f\n", bits[b], results[b].encode_max_error, results[b].encode_flip_rate,
+				results[b].decode_max_error,
+				results[b].decode_max_error > 0 ? -log2(results[b].decode_max_error) : INFINITY);
+	return 0;
+}
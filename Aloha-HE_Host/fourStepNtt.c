@@ -0,0 +1,414 @@
+/*********************************************
+ * This host tool models the four-step NTT for
+ * polynomials larger than the BRAM (N > 2^15),
+ * validates it against the NTT of the reference
+ * model and estimates its latency when the
+ * polynomial is tiled through the BRAM from DDR.
+ *
+ * Build: gcc -O2 -o fourStepNtt fourStepNtt.c ckksReference.c
+ *            ../Aloha-HE_Software/fourStep.c -lm -lpthread
+ * Usage: fourStepNtt [-n log_n] [-t log_tile] [-q log_q:qm:ntt_rom]
+ *                    [-r rom.mem] [-f coproc_mhz] [-w ddr_mb_per_s] [-g]
+ *
+ * With N = N1*N2, N2 = 2^log_tile the tile size
+ * and psi a primitive 2N-th root of unity:
+ * 1. Column step: column j < N2 holds the
+ *    coefficients a[j + t*N2], t < N1. Its
+ *    N1-point NTT with root psi^N2 gives the
+ *    residues of a modulo X^N2 - psi^(N2*e),
+ *    e = 2BR(k)+1, for the tiles k < N1.
+ * 2. Twist: coefficient j of tile k is
+ *    multiplied by psi^((e-N1)*j), which maps
+ *    X^N2 - psi^(N2*e) to Y^N2 + 1.
+ * 3. Row step: every tile is transformed by the
+ *    existing N2-point NTT (root psi^N1).
+ * Tile k is then block k of the N-point NTT of
+ * the hardware, a^_j = a(psi^(2BR(j)+1)), so no
+ * reordering is needed. The inverse runs the
+ * steps backwards with the inverse transforms.
+ * The row transforms are regular N2-point
+ * instructions, so their current_n encoding is
+ * unchanged. psi is chosen such that psi^N1 is
+ * the ROM root of the N2-point transform.
+ *
+ * For N = 2^16 and 2^15 tiles, the dataflow of
+ * the driver (ckks_ntt_four_step, see
+ * Aloha-HE_Software/fourStep.c) is run as well:
+ * the PWMs of the accelerator with the twiddle
+ * polynomials and the tile transforms of the
+ * reference model. It also checks that psi^2
+ * matches the ROM constant of the tile
+ * transform and that psi^3 is rejected. Pass
+ * the printed psi to ckks_ntt_four_step.
+ *
+ * The latency model assumes that the column
+ * step and the twist stream through the
+ * UnifiedTransformation datapath (one butterfly
+ * per cycle, log(N1) stages) and the PWM
+ * multipliers (two coefficients per cycle), and
+ * that every step reads and writes the whole
+ * polynomial (64-bit words) in DDR. The twist
+ * factors are read from DDR as well unless -g
+ * (generated on chip) is given. It reports the
+ * transfer time at ddr_mb_per_s, the compute
+ * time at coproc_mhz and the latency with
+ * DMA and compute serialized (single tile
+ * buffer) or overlapped (double buffering).
+*********************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "ckksReference.h"
+#include "../Aloha-HE_Software/fourStep.h"
+
+#define DEFAULT_ROM   "../Aloha-HE_Common/MemoryInitializationFiles/TwFctrCache_RNSConsts.mem"
+#define MAX_LOG_N     20 // q - 1 is a multiple of 2^24
+#define MIN_LOG_TILE  13 // transform sizes of the hardware
+#define MAX_LOG_TILE  15
+#define STAGE_LAT     27 // pipeline drain per transform stage of UnifiedTransformation
+
+typedef unsigned __int128 uint128_t;
+
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t q)
+{
+	return (uint64_t)((uint128_t)a * b % q);
+}
+
+static uint64_t powMod(uint64_t a, uint64_t e, uint64_t q)
+{
+	uint64_t r = 1;
+	for(; e; e >>= 1, a = mulMod(a, a, q))
+		if(e & 1)
+			r = mulMod(r, a, q);
+	return r;
+}
+
+static uint32_t bitReverse(uint32_t x, uint32_t bits)
+{
+	uint32_t r = 0;
+	for(uint32_t i = 0; i < bits; ++i)
+		r |= ((x >> i) & 1) << (bits-1-i);
+	return r;
+}
+
+// Returns a primitive 2^(log_n+1)-th root of unity psi with psi^n1 = root,
+// where root is a primitive 2^(log_n+1)/n1-th root of unity, or 0.
+static uint64_t rootOfRoot(uint64_t root, uint32_t log_n, uint32_t n1, uint64_t q)
+{
+	uint64_t order = 2ull << log_n;
+	for(uint64_t g = 2; g < 1000; ++g)
+	{
+		uint64_t r = powMod(g, (q-1)/order, q);
+		if(powMod(r, order/2, q) != q-1)
+			continue;
+		// r^n1 generates the same group as root, find root = (r^n1)^u
+		uint64_t rn = powMod(r, n1, q), rn2 = mulMod(rn, rn, q), x = rn;
+		for(uint64_t u = 1; u < order/n1; u += 2, x = mulMod(x, rn2, q))
+			if(x == root)
+				return powMod(r, u, q);
+		return 0;
+	}
+	return 0;
+}
+
+typedef struct
+{
+	uint32_t log_n, log_tile;
+	uint64_t q, psi;
+	uint64_t* twist;     // psi^((e_k-N1)*j), indexed by k*N2 + j
+	uint64_t* untwist;   // inverse of twist
+} FourStep;
+
+static int fourStepInit(FourStep* fs, uint32_t log_n, uint32_t log_tile, uint64_t q, uint64_t psi)
+{
+	uint32_t n = 1u << log_n, n1 = 1u << (log_n - log_tile), n2 = 1u << log_tile;
+	fs->log_n = log_n;
+	fs->log_tile = log_tile;
+	fs->q = q;
+	fs->psi = psi;
+	fs->twist = malloc(n*sizeof(uint64_t));
+	fs->untwist = malloc(n*sizeof(uint64_t));
+	if(!fs->twist || !fs->untwist)
+		return 0;
+	for(uint32_t k = 0; k < n1; ++k)
+	{
+		uint64_t e = 2*bitReverse(k, log_n - log_tile) + 1;
+		uint64_t zeta = powMod(psi, (e + 2ull*n - n1) % (2ull*n), q);
+		uint64_t zeta_inv = powMod(zeta, q-2, q), t = 1, t_inv = 1;
+		for(uint32_t j = 0; j < n2; ++j, t = mulMod(t, zeta, q), t_inv = mulMod(t_inv, zeta_inv, q))
+		{
+			fs->twist[k*n2 + j] = t;
+			fs->untwist[k*n2 + j] = t_inv;
+		}
+	}
+	return 1;
+}
+
+static void fourStepFree(FourStep* fs)
+{
+	free(fs->twist);
+	free(fs->untwist);
+}
+
+// Forward NTT of n = 2^log_n coefficients in place, same order as refNttForward
+static int fourStepForward(const FourStep* fs, uint64_t* a)
+{
+	uint32_t n1 = 1u << (fs->log_n - fs->log_tile), n2 = 1u << fs->log_tile;
+	uint64_t q = fs->q, psi_col = powMod(fs->psi, n2, q), psi_row = powMod(fs->psi, n1, q);
+	uint64_t* col = malloc(n1*sizeof(uint64_t));
+	if(!col)
+		return 0;
+
+	for(uint32_t j = 0; j < n2; ++j)
+	{
+		for(uint32_t t = 0; t < n1; ++t)
+			col[t] = a[t*n2 + j];
+		refNttForward(col, n1, psi_col, q);
+		for(uint32_t k = 0; k < n1; ++k)
+			a[k*n2 + j] = mulMod(col[k], fs->twist[k*n2 + j], q);
+	}
+	for(uint32_t k = 0; k < n1; ++k)
+		refNttForward(&a[k*n2], n2, psi_row, q);
+
+	free(col);
+	return 1;
+}
+
+// Inverse of fourStepForward (including the scaling by 1/n)
+static int fourStepInverse(const FourStep* fs, uint64_t* a)
+{
+	uint32_t n1 = 1u << (fs->log_n - fs->log_tile), n2 = 1u << fs->log_tile;
+	uint64_t q = fs->q, psi_col = powMod(fs->psi, n2, q), psi_row = powMod(fs->psi, n1, q);
+	uint64_t* col = malloc(n1*sizeof(uint64_t));
+	if(!col)
+		return 0;
+
+	for(uint32_t k = 0; k < n1; ++k)
+		refNttInverse(&a[k*n2], n2, psi_row, q);
+	for(uint32_t j = 0; j < n2; ++j)
+	{
+		for(uint32_t k = 0; k < n1; ++k)
+			col[k] = mulMod(a[k*n2 + j], fs->untwist[k*n2 + j], q);
+		refNttInverse(col, n1, psi_col, q);
+		for(uint32_t t = 0; t < n1; ++t)
+			a[t*n2 + j] = col[t];
+	}
+
+	free(col);
+	return 1;
+}
+
+static uint32_t countMismatches(const uint64_t* a, const uint64_t* b, uint32_t n)
+{
+	uint32_t mismatches = 0;
+	for(uint32_t i = 0; i < n; ++i)
+		mismatches += a[i] != b[i];
+	return mismatches;
+}
+
+// Accumulates the PWM of the accelerator, msg = msg + a*b*R^-1 mod q
+static void pwm(uint64_t* msg, const uint64_t* a, const uint64_t* b, uint64_t r_inv, uint64_t q)
+{
+	for(uint32_t j = 0; j < FOUR_STEP_TILE_SIZE; ++j)
+		msg[j] = (msg[j] + mulMod(mulMod(a[j], b[j], q), r_inv, q)) % q;
+}
+
+// Runs the dataflow of ckks_ntt_four_step for N = 2^16: the root checks
+// against the ROM constants of the tile transforms, the forward transform of
+// in (PWMs with the twiddle polynomials of fourStepTwiddles, then the tile
+// NTTs) and the inverse of the direct NTT (tile INTTs, then PWMs). Adds the
+// rejected checks and differing coefficients to errors and returns 0 if out of
+// memory.
+static int driverDataflow(const uint64_t* in, uint64_t* a, uint64_t* ref, uint64_t q, uint64_t psi, uint64_t rom_root,
+						  uint32_t* errors)
+{
+	uint32_t n = 1u << FOUR_STEP_LOG_N, t = FOUR_STEP_TILE_SIZE;
+	uint64_t r = powMod(2, 72, q), r_inv = powMod(r, q-2, q);
+	uint64_t tile_root = mulMod(rom_root, r, q), tile_root_inv = mulMod(powMod(rom_root, q-2, q), r, q);
+	uint64_t psi_row = mulMod(psi, psi, q), psi3 = mulMod(psi_row, psi, q);
+	uint64_t* twiddles[FOUR_STEP_TWIDDLE_POLYS];
+	uint64_t* tiles = calloc(n, sizeof(uint64_t));
+	int ok = tiles != NULL;
+
+	for(uint32_t i = 0; i < FOUR_STEP_TWIDDLE_POLYS; ++i)
+		ok &= (twiddles[i] = malloc(t*sizeof(uint64_t))) != NULL;
+	if(!ok)
+		return 0;
+
+	// psi^3 is a primitive 2^17-th root as well, but its square is not the ROM root
+	int root_ok = fourStepCheckRoot(psi, q, tile_root, 0) && fourStepCheckRoot(psi, q, tile_root_inv, 1) &&
+				  !fourStepCheckRoot(psi3, q, tile_root, 0) && !fourStepCheckRoot(psi3, q, tile_root_inv, 1);
+	fourStepTwiddles(twiddles, psi, q);
+
+	memcpy(ref, in, n*sizeof(uint64_t));
+	refNttForward(ref, n, psi, q);
+	for(uint32_t k = 0; k < 2; ++k)
+	{
+		memcpy(&tiles[k*t], twiddles[FOUR_STEP_ZERO], t*sizeof(uint64_t));
+		pwm(&tiles[k*t], in, twiddles[FOUR_STEP_FWD_LO(k)], r_inv, q);
+		pwm(&tiles[k*t], &in[t], twiddles[FOUR_STEP_FWD_HI(k)], r_inv, q);
+		refNttForward(&tiles[k*t], t, psi_row, q);
+	}
+	uint32_t fwd_errors = countMismatches(tiles, ref, n);
+
+	for(uint32_t k = 0; k < 2; ++k)
+		refNttInverse(&ref[k*t], t, psi_row, q);
+	for(uint32_t k = 0; k < 2; ++k)
+	{
+		memcpy(&a[k*t], twiddles[FOUR_STEP_ZERO], t*sizeof(uint64_t));
+		pwm(&a[k*t], ref, twiddles[FOUR_STEP_INV_T0(k)], r_inv, q);
+		pwm(&a[k*t], &ref[t], twiddles[FOUR_STEP_INV_T1(k)], r_inv, q);
+	}
+	uint32_t inv_errors = countMismatches(a, in, n);
+
+	printf("driver:  root %s, forward %u and inverse %u of %u coefficients differ\n",
+			root_ok ? "checked against the ROM" : "REJECTED", fwd_errors, inv_errors, n);
+	*errors += !root_ok + fwd_errors + inv_errors;
+	for(uint32_t i = 0; i < FOUR_STEP_TWIDDLE_POLYS; ++i)
+		free(twiddles[i]);
+	free(tiles);
+	return 1;
+}
+
+static void printLatency(uint32_t log_n, uint32_t log_tile, double coproc_mhz, double ddr_mb_per_s, int twist_on_chip)
+{
+	uint64_t n = 1ull << log_n, n2 = 1ull << log_tile;
+	uint32_t log_n1 = log_n - log_tile;
+	uint64_t words = 4*n + (twist_on_chip ? 0 : n);
+	uint64_t col_cycles = n/2*log_n1 + STAGE_LAT*log_n1 + n/2;
+	uint64_t tile_cycles = n2/2*log_tile + STAGE_LAT*log_tile;
+	uint64_t row_cycles = (n/n2)*tile_cycles;
+	double ddr_us = words*8/ddr_mb_per_s;
+	double tile_ddr_us = 2*n2*8/ddr_mb_per_s;
+	double comp_us, serial_us, overlap_us;
+
+	comp_us = (col_cycles + row_cycles)/coproc_mhz;
+	serial_us = ddr_us + comp_us;
+	// with double buffering only the first tile load and the last tile
+	// store are not hidden behind the compute of the other tiles
+	overlap_us = (ddr_us > comp_us ? ddr_us : comp_us) + tile_ddr_us;
+
+	printf("\nLatency per transform (coproc %.0f MHz, DDR %.0f MB/s, twist factors %s):\n",
+			coproc_mhz, ddr_mb_per_s, twist_on_chip ? "on chip" : "from DDR");
+	printf("  DDR traffic     %10.0f KiB  %10.1f us\n", words*8/1024.0, ddr_us);
+	printf("  column + twist  %10llu cyc  %10.1f us\n", (unsigned long long)col_cycles, col_cycles/coproc_mhz);
+	printf("  %3llu row tiles   %10llu cyc  %10.1f us\n", (unsigned long long)(n/n2),
+			(unsigned long long)row_cycles, row_cycles/coproc_mhz);
+	printf("  serialized                  %10.1f us (%s-bound)\n", serial_us, ddr_us > comp_us ? "bandwidth" : "compute");
+	printf("  double buffered             %10.1f us\n", overlap_us);
+	printf("  N = 2^%u in BRAM %10llu cyc  %10.1f us (reference)\n", log_tile,
+			(unsigned long long)tile_cycles, tile_cycles/coproc_mhz);
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t log_n = 16, log_tile = 15, log_q = 8, qm = 18, ntt_rom = 15;
+	const char* rom_path = DEFAULT_ROM;
+	double coproc_mhz = 150.0, ddr_mb_per_s = 1200.0;
+	int twist_on_chip = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-n") && i + 1 < argc)
+			log_n = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-t") && i + 1 < argc)
+			log_tile = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-q") && i + 1 < argc && sscanf(argv[i+1], "%u:%u:%u", &log_q, &qm, &ntt_rom) == 3)
+			++i;
+		else if(!strcmp(argv[i], "-r") && i + 1 < argc)
+			rom_path = argv[++i];
+		else if(!strcmp(argv[i], "-f") && i + 1 < argc)
+			coproc_mhz = atof(argv[++i]);
+		else if(!strcmp(argv[i], "-w") && i + 1 < argc)
+			ddr_mb_per_s = atof(argv[++i]);
+		else if(!strcmp(argv[i], "-g"))
+			twist_on_chip = 1;
+		else
+		{
+			fprintf(stderr, "Usage: %s [-n log_n] [-t log_tile] [-q log_q:qm:ntt_rom] [-r rom.mem] "
+					"[-f coproc_mhz] [-w ddr_mb_per_s] [-g]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(log_tile < MIN_LOG_TILE || log_tile > MAX_LOG_TILE || log_n <= log_tile || log_n > MAX_LOG_N)
+	{
+		fprintf(stderr, "log_tile must be in [%u, %u] and log_n in (log_tile, %u]\n", MIN_LOG_TILE, MAX_LOG_TILE, MAX_LOG_N);
+		return 1;
+	}
+	if(coproc_mhz <= 0 || ddr_mb_per_s <= 0)
+	{
+		fprintf(stderr, "coproc_mhz and ddr_mb_per_s must be positive\n");
+		return 1;
+	}
+	if(!refLoadRom(rom_path))
+		return 1;
+
+	uint32_t n = 1u << log_n, n1 = 1u << (log_n - log_tile);
+	uint64_t q = (1ull << (46+log_q)) - ((uint64_t)qm << 24) + 1;
+	uint64_t rom_root = refRootOfUnity(q, ntt_rom);
+	if(!rom_root)
+	{
+		fprintf(stderr, "NTT ROM index %u does not hold twiddle factors of q = 0x%llx\n", ntt_rom, (unsigned long long)q);
+		return 1;
+	}
+	uint64_t psi = rootOfRoot(powMod(rom_root, 1u << (MAX_LOG_TILE - log_tile), q), log_n, n1, q);
+	if(!psi)
+	{
+		fprintf(stderr, "No primitive 2^%u-th root of unity modulo q = 0x%llx\n", log_n+1, (unsigned long long)q);
+		return 1;
+	}
+
+	FourStep fs;
+	uint64_t* a = malloc(n*sizeof(uint64_t));
+	uint64_t* ref = malloc(n*sizeof(uint64_t));
+	uint64_t* in = malloc(n*sizeof(uint64_t));
+	if(!a || !ref || !in || !fourStepInit(&fs, log_n, log_tile, q, psi))
+	{
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	srand(1);
+	for(uint32_t i = 0; i < n; ++i)
+		in[i] = (((uint64_t)rand() << 31) ^ ((uint64_t)rand() << 62) ^ (uint64_t)rand()) % q;
+
+	printf("N = 2^%u, %u tiles of 2^%u, q = 0x%llx, psi = 0x%llx\n", log_n, n1, log_tile,
+			(unsigned long long)q, (unsigned long long)psi);
+
+	memcpy(ref, in, n*sizeof(uint64_t));
+	memcpy(a, in, n*sizeof(uint64_t));
+	refNttForward(ref, n, psi, q);
+	if(!fourStepForward(&fs, a))
+	{
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+	uint32_t fwd_errors = countMismatches(a, ref, n);
+
+	// the inverse starts from the reference transform
+	if(!fourStepInverse(&fs, ref))
+	{
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+	uint32_t inv_errors = countMismatches(ref, in, n);
+
+	printf("forward: %u of %u coefficients differ from refNttForward\n", fwd_errors, n);
+	printf("inverse: %u of %u coefficients differ from the input\n", inv_errors, n);
+
+	// dataflow of the driver with the tile transforms of the reference model
+	uint32_t drv_errors = 0;
+	if(log_n == FOUR_STEP_LOG_N && n1 == 2 && !driverDataflow(in, a, ref, q, psi, rom_root, &drv_errors))
+	{
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	printLatency(log_n, log_tile, coproc_mhz, ddr_mb_per_s, twist_on_chip);
+
+	fourStepFree(&fs);
+	free(a); free(ref); free(in);
+	return fwd_errors || inv_errors || drv_errors;
+}
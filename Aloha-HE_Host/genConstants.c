@@ -0,0 +1,429 @@
+/*********************************************
+ * This host tool generates the content of the
+ * constants cache (twiddle factor cache and
+ * RNS constants, see FFTTw_RNS_ROM.v) for any
+ * moduli q = 2^(log_q+46) - (qm << 24) + 1.
+ *
+ * Build: gcc -O2 -o genConstants genConstants.c
+ * Usage: genConstants -q log_q:qm[:ntt_slot:rns_slot[:inv_slot]] [-q ...]
+ *                     [-r base.mem] [-o out.mem] [-c out.h] [-s out.h]
+ *                     [-x check.mem]
+ *
+ * -q writes the forward NTT constants of q to
+ *    ntt_slot (0 to 17), the RNS constants to
+ *    rns_slot (0 to 15) and, if given, the
+ *    inverse NTT constants to inv_slot. The
+ *    slots are only needed for -o and -c.
+ * -r cache content that is patched, default
+ *    ../Aloha-HE_Common/MemoryInitializationFiles/TwFctrCache_RNSConsts.mem
+ *    (FFT twiddle factors and other moduli).
+ * -o writes a .mem file, e.g., to replace the
+ *    initial content for synthesis or as ROM of
+ *    genTestVectors -r.
+ * -c writes a C header for ckks_load_constants
+ *    (see ckksAccelerator.c) with all lines and
+ *    the slots of each modulus.
+ * -s writes a C header with one block per
+ *    modulus for ckks_stream_constants: its
+ *    16 RNS lines followed by the 71 lines of
+ *    an NTT slot pair with the forward constants
+ *    in the lower and the inverse constants in
+ *    the upper half. The number of moduli is
+ *    not limited by the slots.
+ * -x compares the patched image with
+ *    check.mem and fails on the first line
+ *    that differs, e.g., to check that the
+ *    slots of the ROM are reproduced.
+ *
+ * Layout of the 1024 lines of 128 bits:
+ * - RNS: constant i < 32 of slot m is half
+ *   (i & 1) of line 16m + i/2, with the value
+ *   R^2 * 2^(40i) mod q for i < 22, else 0.
+ * - NTT: constant o < 71 of slot s is half
+ *   (s & 1) of line 256 + 71*(s/2) + o, with
+ *   the value psi^E(o) * R mod q. psi is the
+ *   smallest primitive 2^16-th root of unity
+ *   (psi^-1 for the inverse) and E(o) the odd
+ *   multiples of the powers of two of the
+ *   butterfly stages.
+ * - FFT: lines 896 to 966, independent of q.
+ * Halves are 54 bits, the upper one starts at
+ * bit 54. R = 2^72 is the Montgomery factor.
+*********************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define CACHE_LINES       1024
+#define RNS_SLOTS         16
+#define RNS_LINES         16  // lines per RNS slot
+#define RNS_REGIONS       22  // constants used by RNS.sv (N = 2^15)
+#define RNS_REGION_BITS   40
+#define NTT_SLOTS         18
+#define NTT_BASE          256
+#define NTT_ENTRIES       71  // lines per pair of NTT slots
+#define HALF_BITS         54
+#define MONT_LOG_R        72
+#define MAX_MODULI        256
+#define BLOCK_LINES       (RNS_LINES + NTT_ENTRIES)
+
+typedef unsigned __int128 uint128_t;
+
+typedef struct
+{
+	uint32_t log_q, qm, ntt_slot, rns_slot, inv_slot; // inv_slot = NTT_SLOTS: none
+	uint64_t q, psi;
+} Modulus;
+
+static uint128_t lines[CACHE_LINES];
+
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t q)
+{
+	return (uint64_t)((uint128_t)a * b % q);
+}
+
+static uint64_t powMod(uint64_t a, uint64_t e, uint64_t q)
+{
+	uint64_t r = 1;
+	for(; e; e >>= 1, a = mulMod(a, a, q))
+		if(e & 1)
+			r = mulMod(r, a, q);
+	return r;
+}
+
+// Deterministic Miller-Rabin for 64-bit q
+static int isPrime(uint64_t q)
+{
+	static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+	uint64_t d = q - 1;
+	uint32_t s = 0;
+	if(q < 2 || !(q & 1))
+		return q == 2;
+	for(; !(d & 1); d >>= 1, ++s);
+	for(uint32_t i = 0; i < sizeof(bases)/sizeof(bases[0]); ++i)
+	{
+		uint64_t x = powMod(bases[i] % q, d, q);
+		if(!x || x == 1 || x == q - 1)
+			continue;
+		uint32_t r = 1;
+		for(; r < s && x != q - 1; ++r)
+			x = mulMod(x, x, q);
+		if(x != q - 1)
+			return 0;
+	}
+	return 1;
+}
+
+// Smallest primitive 2^16-th root of unity, as in TwFctrCache_RNSConsts.mem:
+// the odd powers of psi = g^((q-1)/2^16) for the smallest generator g >= 2
+// that yields one.
+static uint64_t rootOfUnity(uint64_t q)
+{
+	for(uint64_t g = 2; g < 1000; ++g)
+	{
+		uint64_t psi = powMod(g, (q-1) >> 16, q);
+		if(powMod(psi, 1u << 15, q) != q - 1)
+			continue;
+		uint64_t psi2 = mulMod(psi, psi, q), w = psi, min = psi;
+		for(uint32_t k = 1; k < (1u << 15); ++k)
+		{
+			w = mulMod(w, psi2, q);
+			if(w < min)
+				min = w;
+		}
+		return min;
+	}
+	return 0;
+}
+
+// Exponent of the twiddle factor at offset o of an NTT slot: 16 values for
+// the stages with 16 or more groups, then 8, 4, 2, 1 values and the powers
+// of two from 2^7 (see UnifiedTwFctGen.sv).
+static uint32_t nttExponent(uint32_t o)
+{
+	static const uint32_t counts[] = {16, 16, 16, 8, 4, 2, 1};
+	uint32_t shift = 0;
+	for(; shift < sizeof(counts)/sizeof(counts[0]); o -= counts[shift++])
+		if(o < counts[shift])
+			return (2*o + 1) << shift;
+	return 1u << (shift + o);
+}
+
+// RNS constant i of q: R^2 * 2^(40i) for the regions of RNS.sv
+static uint64_t rnsConstant(uint64_t q, uint32_t i)
+{
+	uint64_t r = powMod(2, MONT_LOG_R, q);
+	return i < RNS_REGIONS ? mulMod(mulMod(r, r, q), powMod(2, (uint64_t)RNS_REGION_BITS*i, q), q) : 0;
+}
+
+// NTT constant o of q in Montgomery form, of psi^-1 if inverse
+static uint64_t nttConstant(uint64_t q, uint64_t psi, uint32_t o, int inverse)
+{
+	uint64_t w = powMod(psi, nttExponent(o), q);
+	if(inverse)
+		w = powMod(w, q-2, q);
+	return mulMod(w, powMod(2, MONT_LOG_R, q), q);
+}
+
+static uint128_t withHalf(uint128_t line, uint32_t half, uint64_t value)
+{
+	uint128_t mask = (((uint128_t)1 << HALF_BITS) - 1) << (half*HALF_BITS);
+	return (line & ~mask) | ((uint128_t)value << (half*HALF_BITS));
+}
+
+static void setHalf(uint32_t line, uint32_t half, uint64_t value)
+{
+	lines[line] = withHalf(lines[line], half, value);
+}
+
+static int loadMem(const char* path, uint128_t* dest)
+{
+	char line[128];
+	uint32_t num_lines = 0;
+	FILE* f = fopen(path, "r");
+	if(!f)
+	{
+		fprintf(stderr, "Cannot open %s\n", path);
+		return 0;
+	}
+	while(fgets(line, sizeof(line), f) && num_lines < CACHE_LINES)
+	{
+		uint128_t v = 0;
+		if(line[0] == '@')
+			continue;
+		for(char* p = line; *p && *p != '\n' && *p != '\r'; ++p)
+			v = (v << 4) | (uint128_t)(*p <= '9' ? *p - '0' : (*p | 0x20) - 'a' + 10);
+		dest[num_lines++] = v;
+	}
+	fclose(f);
+	if(num_lines != CACHE_LINES)
+	{
+		fprintf(stderr, "%s has %u lines, expected %u\n", path, num_lines, CACHE_LINES);
+		return 0;
+	}
+	return 1;
+}
+
+static int writeMem(const char* path)
+{
+	FILE* f = fopen(path, "w");
+	if(!f)
+	{
+		fprintf(stderr, "Cannot open %s\n", path);
+		return 0;
+	}
+	fprintf(f, "@0000\n");
+	for(uint32_t i = 0; i < CACHE_LINES; ++i)
+		fprintf(f, "%016llx%016llx\n", (unsigned long long)(lines[i] >> 64), (unsigned long long)lines[i]);
+	fclose(f);
+	return 1;
+}
+
+static int writeHeader(const char* path, const Modulus* moduli, uint32_t num_moduli, int argc, char** argv)
+{
+	FILE* f = fopen(path, "w");
+	if(!f)
+	{
+		fprintf(stderr, "Cannot open %s\n", path);
+		return 0;
+	}
+	fprintf(f, "// Generated by");
+	for(int i = 0; i < argc; ++i)
+		fprintf(f, " %s", argv[i]);
+	fprintf(f, "\n// Content of the constants cache for ckks_load_constants (two words per line,\n"
+			"// lower half first). The NTT constants index of each modulus is its forward slot,\n"
+			"// map it with ckks_set_ntt_slots(ntt_slot, ntt_slot, inv_slot).\n\n");
+	fprintf(f, "#define GEN_CONSTANTS_LINES %u\n", CACHE_LINES);
+	fprintf(f, "#define GEN_CONSTANTS_NUM_MODULI %u\n\n", num_moduli);
+	fprintf(f, "static const uint64_t gen_constants[2*GEN_CONSTANTS_LINES] = {");
+	for(uint32_t i = 0; i < CACHE_LINES; ++i)
+		fprintf(f, "%s0x%016llxull, 0x%016llxull", i % 2 ? ", " : (i ? ",\n\t" : "\n\t"),
+				(unsigned long long)lines[i], (unsigned long long)(lines[i] >> 64));
+	fprintf(f, "\n};\n\n// log_q, qm, ntt_slot, rns_slot, inv_slot (%u: none)\n", NTT_SLOTS);
+	fprintf(f, "static const uint32_t gen_constants_moduli[GEN_CONSTANTS_NUM_MODULI][5] = {");
+	for(uint32_t j = 0; j < num_moduli; ++j)
+		fprintf(f, "%s{%u, %u, %u, %u, %u}", j ? ",\n\t" : "\n\t", moduli[j].log_q, moduli[j].qm,
+				moduli[j].ntt_slot, moduli[j].rns_slot, moduli[j].inv_slot);
+	fprintf(f, "\n};\n");
+	fclose(f);
+	return 1;
+}
+
+static int writeStreamHeader(const char* path, const Modulus* moduli, uint32_t num_moduli, int argc, char** argv)
+{
+	FILE* f = fopen(path, "w");
+	if(!f)
+	{
+		fprintf(stderr, "Cannot open %s\n", path);
+		return 0;
+	}
+	fprintf(f, "// Generated by");
+	for(int i = 0; i < argc; ++i)
+		fprintf(f, " %s", argv[i]);
+	fprintf(f, "\n// Constants of each modulus for ckks_stream_constants: %u RNS lines and the\n"
+			"// %u lines of an NTT slot pair (forward constants in the lower, inverse\n"
+			"// constants in the upper half), two words per line, lower half first.\n\n", RNS_LINES, NTT_ENTRIES);
+	fprintf(f, "#define GEN_STREAM_NUM_MODULI %u\n\n", num_moduli);
+	fprintf(f, "static const uint64_t gen_stream_constants[GEN_STREAM_NUM_MODULI][%u] = {", 2*BLOCK_LINES);
+	for(uint32_t j = 0; j < num_moduli; ++j)
+	{
+		const Modulus* m = &moduli[j];
+		fprintf(f, "%s{", j ? ",\n\t" : "\n\t");
+		for(uint32_t l = 0; l < BLOCK_LINES; ++l)
+		{
+			uint128_t line = 0;
+			if(l < RNS_LINES)
+			{
+				line = withHalf(line, 0, rnsConstant(m->q, 2*l));
+				line = withHalf(line, 1, rnsConstant(m->q, 2*l + 1));
+			}
+			else
+			{
+				line = withHalf(line, 0, nttConstant(m->q, m->psi, l - RNS_LINES, 0));
+				line = withHalf(line, 1, nttConstant(m->q, m->psi, l - RNS_LINES, 1));
+			}
+			fprintf(f, "%s0x%016llxull, 0x%016llxull", l ? (l % 2 ? ", " : ",\n\t ") : "",
+					(unsigned long long)line, (unsigned long long)(line >> 64));
+		}
+		fprintf(f, "}");
+	}
+	fprintf(f, "\n};\n\n// log_q, qm\n");
+	fprintf(f, "static const uint32_t gen_stream_moduli[GEN_STREAM_NUM_MODULI][2] = {");
+	for(uint32_t j = 0; j < num_moduli; ++j)
+		fprintf(f, "%s{%u, %u}", j ? ",\n\t" : "\n\t", moduli[j].log_q, moduli[j].qm);
+	fprintf(f, "\n};\n");
+	fclose(f);
+	return 1;
+}
+
+static void usage(const char* name)
+{
+	fprintf(stderr, "Usage: %s -q log_q:qm[:ntt_slot:rns_slot[:inv_slot]] [-q ...] [-r base.mem] "
+			"[-o out.mem] [-c out.h] [-s out.h] [-x check.mem]\n", name);
+	exit(1);
+}
+
+int main(int argc, char** argv)
+{
+	const char* base = "../Aloha-HE_Common/MemoryInitializationFiles/TwFctrCache_RNSConsts.mem";
+	const char* out_mem = NULL;
+	const char* out_header = NULL;
+	const char* out_stream = NULL;
+	const char* check = NULL;
+	int slots_given = 1;
+	Modulus moduli[MAX_MODULI];
+	uint32_t num_moduli = 0;
+	uint32_t ntt_used = 0, rns_used = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-q") && i + 1 < argc && num_moduli < MAX_MODULI)
+		{
+			Modulus* m = &moduli[num_moduli++];
+			int fields = sscanf(argv[++i], "%u:%u:%u:%u:%u", &m->log_q, &m->qm, &m->ntt_slot, &m->rns_slot, &m->inv_slot);
+			if(fields < 2 || fields == 3)
+				usage(argv[0]);
+			if(fields == 2)
+			{
+				slots_given = 0;
+				m->ntt_slot = m->rns_slot = 0;
+			}
+			if(fields <= 4)
+				m->inv_slot = NTT_SLOTS;
+		}
+		else if(!strcmp(argv[i], "-r") && i + 1 < argc)
+			base = argv[++i];
+		else if(!strcmp(argv[i], "-o") && i + 1 < argc)
+			out_mem = argv[++i];
+		else if(!strcmp(argv[i], "-c") && i + 1 < argc)
+			out_header = argv[++i];
+		else if(!strcmp(argv[i], "-s") && i + 1 < argc)
+			out_stream = argv[++i];
+		else if(!strcmp(argv[i], "-x") && i + 1 < argc)
+			check = argv[++i];
+		else
+			usage(argv[0]);
+	}
+	if(!num_moduli || (!out_mem && !out_header && !out_stream && !check))
+		usage(argv[0]);
+	if((out_mem || out_header || check) && !slots_given)
+	{
+		fprintf(stderr, "-o, -c and -x need the slots of every modulus\n");
+		return 1;
+	}
+	if((out_mem || out_header || check) && !loadMem(base, lines))
+		return 1;
+
+	for(uint32_t j = 0; j < num_moduli; ++j)
+	{
+		Modulus* m = &moduli[j];
+		if(m->log_q > 8 || m->qm >= (1u << 17) || m->ntt_slot >= NTT_SLOTS || m->rns_slot >= RNS_SLOTS ||
+		   m->inv_slot > NTT_SLOTS)
+		{
+			fprintf(stderr, "Modulus %u: log_q must be at most 8, qm below 2^17, ntt_slot and inv_slot below %u "
+					"and rns_slot below %u\n", j, NTT_SLOTS, RNS_SLOTS);
+			return 1;
+		}
+		uint32_t slots = (1u << m->ntt_slot) | (m->inv_slot < NTT_SLOTS ? 1u << m->inv_slot : 0);
+		if(slots_given && ((ntt_used & slots) || (rns_used & (1u << m->rns_slot)) || m->ntt_slot == m->inv_slot))
+		{
+			fprintf(stderr, "Modulus %u: slot already used\n", j);
+			return 1;
+		}
+		ntt_used |= slots;
+		rns_used |= 1u << m->rns_slot;
+
+		m->q = (1ull << (46+m->log_q)) - ((uint64_t)m->qm << 24) + 1;
+		if(!isPrime(m->q))
+		{
+			fprintf(stderr, "Modulus %u: q = 0x%llx is not prime\n", j, (unsigned long long)m->q);
+			return 1;
+		}
+		m->psi = rootOfUnity(m->q);
+		if(!m->psi)
+		{
+			fprintf(stderr, "Modulus %u: no primitive 2^16-th root of unity found\n", j);
+			return 1;
+		}
+
+		for(uint32_t i = 0; i < 2*RNS_LINES; ++i)
+			setHalf(RNS_LINES*m->rns_slot + i/2, i & 1, rnsConstant(m->q, i));
+		for(uint32_t o = 0; o < NTT_ENTRIES; ++o)
+		{
+			setHalf(NTT_BASE + NTT_ENTRIES*(m->ntt_slot/2) + o, m->ntt_slot & 1, nttConstant(m->q, m->psi, o, 0));
+			if(m->inv_slot < NTT_SLOTS)
+				setHalf(NTT_BASE + NTT_ENTRIES*(m->inv_slot/2) + o, m->inv_slot & 1, nttConstant(m->q, m->psi, o, 1));
+		}
+		printf("q = 0x%llx (log_q %u, qm %u)", (unsigned long long)m->q, m->log_q, m->qm);
+		if(slots_given)
+			printf(": NTT slot %u", m->ntt_slot);
+		if(slots_given && m->inv_slot < NTT_SLOTS)
+			printf(", inverse slot %u", m->inv_slot);
+		if(slots_given)
+			printf(", RNS slot %u", m->rns_slot);
+		printf(", psi = 0x%llx\n", (unsigned long long)m->psi);
+	}
+
+	if(out_mem && !writeMem(out_mem))
+		return 1;
+	if(out_header && !writeHeader(out_header, moduli, num_moduli, argc, argv))
+		return 1;
+	if(out_stream && !writeStreamHeader(out_stream, moduli, num_moduli, argc, argv))
+		return 1;
+	if(check)
+	{
+		static uint128_t expected[CACHE_LINES];
+		if(!loadMem(check, expected))
+			return 1;
+		for(uint32_t i = 0; i < CACHE_LINES; ++i)
+			if(lines[i] != expected[i])
+			{
+				fprintf(stderr, "Line %u differs from %s\n", i, check);
+				return 1;
+			}
+		printf("Image matches %s\n", check);
+	}
+	return 0;
+}
@@ -0,0 +1,385 @@
+/*********************************************
+ * This host tool generates binary test-vector
+ * containers (see Aloha-HE_Software/Testing/
+ * testVectors.h) for arbitrary polynomial
+ * degrees, moduli sets and seeds. All expected
+ * intermediates are computed by the reference
+ * model in ckksReference.c.
+ *
+ * Build: gcc -O2 -o genTestVectors genTestVectors.c ckksReference.c
+ *            ../Aloha-HE_Software/Testing/testVectors.c -lm -lpthread
+ * Usage: genTestVectors -n log_n -q log_q:qm:ntt_rom:rns_rom [-q ...]
+ *                       [-s seed] [-l log_scale] [-r rom.mem] [-t threads]
+ *                       [-i header.h ...] -o out.tv
+ *
+ * -q adds one modulus q = 2^(log_q+46) - (qm << 24) + 1 with the
+ *    given offsets into the twiddle factor and RNS constant ROM.
+ *    The decryption uses the first modulus, so its inverse twiddle
+ *    factors must be in the ROM (e.g. 8:18:15:x).
+ * -r twiddle factor ROM, default
+ *    ../Aloha-HE_Common/MemoryInitializationFiles/TwFctrCache_RNSConsts.mem
+ * -t number of threads, default: number of online CPUs
+ * -i imports the arrays of a legacy reference header (e.g.
+ *    referenceDecryption13.h). Arrays are matched by name, per
+ *    modulus arrays have the suffix _<modulus>. Imported arrays
+ *    replace generated ones.
+ *
+ * All random inputs (message, key pair, seeds) are derived from the
+ * seed, so the same command line always yields the same container.
+*********************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include "../Aloha-HE_Software/Testing/testVectors.h"
+#include "ckksReference.h"
+
+#define MAX_ENTRIES (TV_NUM_IDS*TV_MAX_MODULI)
+
+typedef struct
+{
+	uint32_t id;
+	uint32_t modulus;
+	uint64_t* words;
+	uint64_t num_words;
+} Payload;
+
+static Payload payloads[MAX_ENTRIES];
+static uint32_t num_payloads = 0;
+
+// Names of the entries. They match the array names of the legacy C headers.
+static const char* tv_names[TV_NUM_IDS] = {
+	"input", "expanded_input", "fft_expected", "v_poly", "e0_poly", "e1_poly",
+	"message_after_rns", "v_poly_ntt", "e1_poly_ntt", "pk0", "pk1", "expected_c0", "expected_c1",
+	"c0_to_decrypt", "c1_to_decrypt", "sk", "decrypted_m_ntt", "intt_m_reference",
+	"ifft_input", "ifft_reference", "projected_reference"
+};
+
+static const int tv_per_modulus[TV_NUM_IDS] = {
+	0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 1, 1, 1,
+	0, 0, 0, 0, 0,
+	0, 0, 0
+};
+
+// Returns the number of 64-bit words of the entry id.
+static uint64_t expectedWords(uint32_t id, uint8_t log_n)
+{
+	if(id == TV_EXPANDED_INPUT || id == TV_FFT_EXPECTED || id == TV_IFFT_INPUT || id == TV_IFFT_REFERENCE)
+		return 2ull << log_n;
+	return 1ull << log_n;
+}
+
+// splitmix64, used to derive all random inputs from the seed.
+static uint64_t rng_state;
+static uint64_t nextRandom()
+{
+	uint64_t z = (rng_state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+// Adds or replaces the payload (id, modulus). Takes ownership of words.
+static void addPayload(uint32_t id, uint32_t modulus, uint64_t* words, uint64_t num_words)
+{
+	for(uint32_t i = 0; i < num_payloads; ++i)
+	{
+		if(payloads[i].id == id && payloads[i].modulus == modulus)
+		{
+			free(payloads[i].words);
+			payloads[i].words = words;
+			payloads[i].num_words = num_words;
+			return;
+		}
+	}
+	if(num_payloads == MAX_ENTRIES)
+	{
+		fprintf(stderr, "Too many entries\n");
+		exit(1);
+	}
+	payloads[num_payloads++] = (Payload){id, modulus, words, num_words};
+}
+
+static uint64_t* allocWords(uint64_t num_words)
+{
+	uint64_t* words = calloc(num_words, sizeof(uint64_t));
+	if(!words)
+	{
+		fprintf(stderr, "Out of memory\n");
+		exit(1);
+	}
+	return words;
+}
+
+// Generates the random inputs: the message with values in [-1, 1),
+// the ternary secret key s and the key error e with the centered
+// binomial distribution of the hardware error sampler.
+static void generateInputs(const TvHeader* hdr, int8_t* s, int8_t* e)
+{
+	uint32_t poly_size = 1u << hdr->log_n;
+
+	uint64_t* input = allocWords(poly_size);
+	for(uint32_t i = 0; i < poly_size; ++i)
+	{
+		double x = (double)(nextRandom() >> 11) / (double)(1ull << 52) - 1.0;
+		memcpy(&input[i], &x, sizeof(double));
+	}
+	addPayload(TV_INPUT, 0, input, poly_size);
+
+	for(uint32_t i = 0; i < poly_size; ++i)
+	{
+		uint64_t r = nextRandom();
+		s[i] = (int8_t)(r % 3) - 1;
+		e[i] = __builtin_popcountll((r >> 2) & 0x1fffff) - __builtin_popcountll((r >> 23) & 0x1fffff);
+	}
+}
+
+// Runs the reference model and adds all computed entries.
+static void computeReference(const TvHeader* hdr, const int8_t* s, const int8_t* e, uint32_t num_threads)
+{
+	static uint64_t* out[TV_NUM_IDS][TV_MAX_MODULI];
+	struct timespec start, end;
+	const uint64_t* input = NULL;
+
+	for(uint32_t i = 0; i < num_payloads; ++i)
+		if(payloads[i].id == TV_INPUT)
+			input = payloads[i].words;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if(!refCompute(hdr, input, s, e, out, num_threads))
+		exit(1);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	for(uint32_t id = 0; id < TV_NUM_IDS; ++id)
+		for(uint32_t j = 0; j < TV_MAX_MODULI; ++j)
+			if(out[id][j])
+				addPayload(id, j, out[id][j], expectedWords(id, hdr->log_n));
+	printf("Computed reference with %u threads in %.3f s\n", num_threads,
+			(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9);
+}
+
+// Finds the entry name at the start of the C declarator s (e.g. "sk[] = {")
+// and returns its id and modulus. Returns 0 if the name is unknown.
+static int parseArrayName(const char* s, uint32_t* id, uint32_t* modulus)
+{
+	char name[64];
+	uint32_t len = 0;
+	while((isalnum((unsigned char)s[len]) || s[len] == '_') && len < sizeof(name)-1)
+	{
+		name[len] = s[len];
+		len++;
+	}
+	name[len] = 0;
+
+	for(uint32_t i = 0; i < TV_NUM_IDS; ++i)
+	{
+		size_t n = strlen(tv_names[i]);
+		if(strncmp(name, tv_names[i], n))
+			continue;
+		if(!tv_per_modulus[i] && name[n] == 0)
+		{
+			*id = i;
+			*modulus = 0;
+			return 1;
+		}
+		if(tv_per_modulus[i] && name[n] == '_' && isdigit((unsigned char)name[n+1]))
+		{
+			*id = i;
+			*modulus = atoi(&name[n+1]);
+			return *modulus < TV_MAX_MODULI;
+		}
+	}
+	return 0;
+}
+
+// Imports all known arrays "uint64_t <name>[] ... = {0x..., ...};" of a legacy header.
+// Additional words (e.g. the trailing 0 of the legacy arrays) are dropped.
+static void importHeader(const char* path, uint8_t log_n)
+{
+	FILE* f = fopen(path, "r");
+	if(!f)
+	{
+		fprintf(stderr, "Cannot open %s\n", path);
+		exit(1);
+	}
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char* text = malloc(size+1);
+	if(!text || fread(text, 1, size, f) != (size_t)size)
+	{
+		fprintf(stderr, "Cannot read %s\n", path);
+		exit(1);
+	}
+	text[size] = 0;
+	fclose(f);
+
+	char* p = text;
+	while((p = strstr(p, "uint64_t ")))
+	{
+		uint32_t id, modulus;
+		p += strlen("uint64_t ");
+		char* open = strchr(p, '{');
+		char* close = open ? strchr(open, '}') : NULL;
+		if(!close)
+			break;
+		if(!parseArrayName(p, &id, &modulus))
+		{
+			p = close;
+			continue;
+		}
+
+		uint64_t num_words = 0, capacity = 1024;
+		uint64_t* words = allocWords(capacity);
+		char* q = open+1;
+		while(q < close)
+		{
+			char* end;
+			uint64_t value = strtoull(q, &end, 0);
+			if(end == q)
+			{
+				q++;
+				continue;
+			}
+			if(num_words == capacity)
+			{
+				capacity *= 2;
+				words = realloc(words, capacity*sizeof(uint64_t));
+				if(!words)
+				{
+					fprintf(stderr, "Out of memory\n");
+					exit(1);
+				}
+			}
+			words[num_words++] = value;
+			q = end;
+		}
+		if(num_words < expectedWords(id, log_n))
+		{
+			fprintf(stderr, "%s in %s has %llu words, expected %llu\n", tv_names[id], path,
+					(unsigned long long)num_words, (unsigned long long)expectedWords(id, log_n));
+			exit(1);
+		}
+		num_words = expectedWords(id, log_n);
+		addPayload(id, modulus, words, num_words);
+		printf("Imported %s (modulus %u, %llu words)\n", tv_names[id], modulus, (unsigned long long)num_words);
+		p = close;
+	}
+	free(text);
+}
+
+// Writes the container: header, entry table and the aligned payloads.
+static void writeContainer(TvHeader* hdr, const char* path)
+{
+	static const uint8_t zeros[TV_ALIGNMENT];
+	TvEntry entries[MAX_ENTRIES];
+	uint64_t offset = sizeof(TvHeader) + num_payloads*sizeof(TvEntry);
+
+	hdr->num_entries = num_payloads;
+	for(uint32_t i = 0; i < num_payloads; ++i)
+	{
+		offset = (offset + TV_ALIGNMENT-1) / TV_ALIGNMENT * TV_ALIGNMENT;
+		entries[i] = (TvEntry){payloads[i].id, payloads[i].modulus, offset, payloads[i].num_words};
+		offset += payloads[i].num_words*sizeof(uint64_t);
+	}
+
+	FILE* f = fopen(path, "wb");
+	if(!f)
+	{
+		fprintf(stderr, "Cannot open %s\n", path);
+		exit(1);
+	}
+	fwrite(hdr, sizeof(TvHeader), 1, f);
+	fwrite(entries, sizeof(TvEntry), num_payloads, f);
+	for(uint32_t i = 0; i < num_payloads; ++i)
+	{
+		long pos = ftell(f);
+		fwrite(zeros, 1, entries[i].offset - pos, f);
+		fwrite(payloads[i].words, sizeof(uint64_t), payloads[i].num_words, f);
+	}
+	fclose(f);
+	printf("Wrote %u entries (%llu bytes) to %s\n", num_payloads, (unsigned long long)offset, path);
+}
+
+static void usage(const char* name)
+{
+	fprintf(stderr, "Usage: %s -n log_n -q log_q:qm:ntt_rom:rns_rom [-q ...] [-s seed] [-l log_scale] "
+			"[-r rom.mem] [-t threads] [-i header.h ...] -o out.tv\n", name);
+	exit(1);
+}
+
+int main(int argc, char** argv)
+{
+	TvHeader hdr;
+	const char* out = NULL;
+	const char* rom = "../Aloha-HE_Common/MemoryInitializationFiles/TwFctrCache_RNSConsts.mem";
+	long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	const char* headers[16];
+	uint32_t num_headers = 0;
+	uint64_t seed = 0;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = TV_MAGIC;
+	hdr.version = TV_VERSION;
+	hdr.log_scale = 40;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(i+1 >= argc)
+			usage(argv[0]);
+		if(!strcmp(argv[i], "-n"))
+			hdr.log_n = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-s"))
+			seed = strtoull(argv[++i], NULL, 0);
+		else if(!strcmp(argv[i], "-l"))
+			hdr.log_scale = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-r"))
+			rom = argv[++i];
+		else if(!strcmp(argv[i], "-t"))
+			num_threads = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-o"))
+			out = argv[++i];
+		else if(!strcmp(argv[i], "-i") && num_headers < 16)
+			headers[num_headers++] = argv[++i];
+		else if(!strcmp(argv[i], "-q") && hdr.num_moduli < TV_MAX_MODULI)
+		{
+			uint32_t j = hdr.num_moduli++;
+			if(sscanf(argv[++i], "%u:%u:%u:%u", &hdr.log_q[j], &hdr.qm[j], &hdr.ntt_rom_index[j], &hdr.rns_rom_index[j]) != 4
+					|| hdr.log_q[j] > 8 || hdr.qm[j] >= (1u<<17))
+				usage(argv[0]);
+		}
+		else
+			usage(argv[0]);
+	}
+	if(!out || hdr.log_n < 13 || hdr.log_n > 15 || hdr.num_moduli == 0)
+		usage(argv[0]);
+	if(!refLoadRom(rom))
+		return 1;
+	if(num_threads < 1)
+		num_threads = 1;
+
+	rng_state = seed;
+	hdr.error_polys_seed = nextRandom();
+	for(uint32_t j = 0; j < hdr.num_moduli; ++j)
+		hdr.pk1_seeds[j] = nextRandom();
+
+	int8_t* s = malloc(1u << hdr.log_n);
+	int8_t* e = malloc(1u << hdr.log_n);
+	if(!s || !e)
+	{
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+	generateInputs(&hdr, s, e);
+	computeReference(&hdr, s, e, num_threads);
+	for(uint32_t i = 0; i < num_headers; ++i)
+		importHeader(headers[i], hdr.log_n);
+
+	writeContainer(&hdr, out);
+	return 0;
+}
@@ -0,0 +1,250 @@
+/*********************************************
+ * This host tool is a cycle model of ISA_control
+ * and the instruction decoding of ComputeCore for
+ * the fused NTT+PWM instruction.
+ *
+ * Build: gcc -O2 -o isaControlSim isaControlSim.c
+ * Usage: isaControlSim [-c max_cycles] [-n log_n]
+ *
+ * The model executes the encryption program of
+ * initInsBuffer (see instruction.c) with the
+ * registered instruction memory output, the
+ * control FSM, command_reg, the fused_pwm_phase
+ * register and abstract units: the transform
+ * raises done for one cycle ntt_cycles after its
+ * reset is released, RNS and PWM hold done once
+ * they finished until they are reset. The unit
+ * latencies follow the counters and pipeline
+ * drains of the RTL for N = 2^log_n. It runs
+ * the program with the original (clear on
+ * command_we) and the current (clear on
+ * command_issue) phase logic and reports whether
+ * the FSM reaches state 7 and whether each unit
+ * ran as intended. Each program is also run with
+ * separate NTT and PWM instructions and with two
+ * fused instructions in a row. Finally, it
+ * reports the cycles of the encryption program
+ * per modulus with the PWM at one coefficient
+ * per cycle and at one pair per cycle (see
+ * PWM.sv).
+*********************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Opcode definition. Must comply with hardware (see ComputeCore.v)
+#define OPC_TRANSFORMATION (1)
+#define OPC_RNS            (2)
+#define OPC_PWM            (4)
+
+#define INS_BUFFER_SIZE 16
+
+// Pipeline drains in cycles after the last coefficient is read
+#define STAGE_LAT 27              // per transform stage of UnifiedTransformation (see fourStepNtt.c)
+#define PWM_DRAIN (15 + 2 + 2)    // DELAY_NTT_BF_MULT + BRAM_RD_LAT + MODADD_LAT (PWM.sv)
+#define RNS_DRAIN (15 + 13 + 2 + 15 + 3) // done_delay of RNS.sv
+
+// Unit latencies in cycles (see unitLatencies)
+static uint32_t ntt_cycles, rns_cycles, pwm_cycles;
+
+// Sets the unit latencies for N = 2^log_n with pwm_rate coefficients per PWM cycle
+static void unitLatencies(uint32_t log_n, uint32_t pwm_rate)
+{
+	uint32_t n = 1u << log_n;
+	ntt_cycles = n/2*log_n + STAGE_LAT*log_n;
+	rns_cycles = n + RNS_DRAIN;
+	pwm_cycles = n/pwm_rate + PWM_DRAIN;
+}
+
+enum { PHASE_CLEAR_ON_WE, PHASE_CLEAR_ON_ISSUE };
+
+typedef struct
+{
+	uint32_t cycles;        // until state 7 or max_cycles
+	int      done;          // state 7 reached
+	uint32_t ntt_runs;      // completed transforms
+	uint32_t pwm_runs;      // completed PWMs
+	uint32_t rns_runs;
+} SimResult;
+
+// Instruction words as built by instruction.c (only the decoded fields)
+static uint64_t rnsWord(void)  { return (1ull<<42) | OPC_RNS; }
+static uint64_t nttWord(void)  { return (1ull<<42) | (5ull<<5) | OPC_TRANSFORMATION; }
+static uint64_t nttPwmWord(uint32_t modulus) { return nttWord() | ((uint64_t)modulus<<9) | (1ull<<33); }
+static uint64_t pwmWord(void)  { return (1ull<<42) | OPC_PWM; }
+
+// Fills the buffer like initInsBuffer: nop, instructions, clear, nop, end
+static void initInsBuffer(uint64_t* buf, const uint64_t* words, uint32_t num_words)
+{
+	uint32_t i = 0;
+
+	memset(buf, 0, INS_BUFFER_SIZE*sizeof(uint64_t));
+	buf[i++] = 0;
+	for(uint32_t j = 0; j < num_words; ++j)
+		buf[i++] = words[j];
+	buf[i++] = 1ull<<42;
+	buf[i++] = 0;
+	buf[i++] = 0x1f;
+}
+
+static SimResult simulate(const uint64_t* ins, int phase_mode, uint32_t max_cycles)
+{
+	SimResult r = {0};
+	// registers
+	uint32_t state = 0, ir_address = 0;
+	uint64_t ir_data = 0, command_reg = 0;
+	int command_we_1DP = 0, fused_pwm_phase = 0;
+	uint32_t ntt_count = 0, rns_count = 0, pwm_count = 0;
+	int ntt_done = 0, rns_done = 0, pwm_done = 0;
+
+	for(r.cycles = 0; r.cycles < max_cycles; ++r.cycles)
+	{
+		// combinational logic of this cycle
+		int command_we1 = (ir_data >> 43) & 1;
+		int command_we  = (ir_data >> 42) & 1;
+		uint64_t command_in = ir_data & ((1ull<<42) - 1);
+		int non_instruction  = command_we1 || (ir_data & 0x1f) == 0;
+		int last_instruction = (ir_data & 0x1f) == 0x1f;
+		int inc_ir_address   = state == 0 || state == 6;
+
+		uint32_t opcode = command_reg & 7;
+		int op1_0 = (command_reg >> 3) & 1, op1_1 = (command_reg >> 4) & 1;
+		int op4_0 = (command_reg >> 33) & 1;
+		int fuse_pwm = opcode == OPC_TRANSFORMATION && op4_0 && !op1_1 && !op1_0;
+		int transform_rst = !(opcode == OPC_TRANSFORMATION && !fused_pwm_phase);
+		int pwm_rst = !(opcode == OPC_PWM || fused_pwm_phase);
+		int rns_rst = opcode != OPC_RNS;
+		int command_issue = command_we && (!command_we_1DP || command_in != command_reg);
+		int phase_clear = phase_mode == PHASE_CLEAR_ON_WE ? command_we : command_issue;
+		int done_ins_computation = (ntt_done && !fuse_pwm) || rns_done || pwm_done;
+
+		uint32_t nextstate;
+		switch(state)
+		{
+			case 5:  nextstate = done_ins_computation || non_instruction || last_instruction ? 6 : 5; break;
+			case 6:  nextstate = last_instruction ? 7 : 1; break;
+			case 7:  nextstate = 7; break;
+			default: nextstate = state + 1;
+		}
+		if(state == 7)
+		{
+			r.done = 1;
+			break;
+		}
+
+		// clock edge
+		if(phase_clear)
+			fused_pwm_phase = 0;
+		else if(fuse_pwm && ntt_done)
+			fused_pwm_phase = 1;
+
+		if(transform_rst)
+			ntt_count = 0, ntt_done = 0;
+		else if(ntt_count < ntt_cycles)
+		{
+			ntt_done = ++ntt_count == ntt_cycles;
+			r.ntt_runs += ntt_done;
+		}
+		else
+			ntt_done = 0;
+
+		if(rns_rst)
+			rns_count = 0, rns_done = 0;
+		else if(rns_count < rns_cycles)
+		{
+			rns_done = ++rns_count == rns_cycles;
+			r.rns_runs += rns_done;
+		}
+
+		if(pwm_rst)
+			pwm_count = 0, pwm_done = 0;
+		else if(pwm_count < pwm_cycles)
+		{
+			pwm_done = ++pwm_count == pwm_cycles;
+			r.pwm_runs += pwm_done;
+		}
+
+		if(command_we)
+			command_reg = command_in;
+		command_we_1DP = command_we;
+		ir_data = ins[ir_address];
+		if(inc_ir_address)
+			ir_address = (ir_address + 1) % INS_BUFFER_SIZE;
+		state = nextstate;
+	}
+	return r;
+}
+
+typedef struct
+{
+	const char* name;
+	uint64_t    words[4];
+	uint32_t    num_words;
+	uint32_t    ntt_runs, pwm_runs, rns_runs; // expected
+} Program;
+
+int main(int argc, char** argv)
+{
+	uint32_t max_cycles = 10000000, log_n = 13;
+	const Program programs[] = {
+		{"encrypt (RNS, NTT+PWM)", {rnsWord(), nttPwmWord(0)}, 2, 1, 1, 1},
+		{"encrypt (RNS, NTT, PWM)", {rnsWord(), nttWord(), pwmWord()}, 3, 1, 1, 1},
+		{"NTT+PWM, NTT+PWM", {nttPwmWord(0), nttPwmWord(1)}, 2, 2, 2, 0},
+		{"NTT+PWM, NTT", {nttPwmWord(0), nttWord()}, 2, 2, 1, 0},
+	};
+	const char* modes[] = {"clear on command_we", "clear on command_issue"};
+	int failed = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-c") && i+1 < argc)
+			max_cycles = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-n") && i+1 < argc)
+			log_n = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: %s [-c max_cycles] [-n log_n]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(log_n < 13 || log_n > 15)
+	{
+		fprintf(stderr, "log_n must be in [13, 15]\n");
+		return 1;
+	}
+	unitLatencies(log_n, 1);
+
+	for(uint32_t p = 0; p < sizeof(programs)/sizeof(programs[0]); ++p)
+	{
+		uint64_t ins[INS_BUFFER_SIZE];
+
+		initInsBuffer(ins, programs[p].words, programs[p].num_words);
+		for(int mode = PHASE_CLEAR_ON_WE; mode <= PHASE_CLEAR_ON_ISSUE; ++mode)
+		{
+			SimResult r = simulate(ins, mode, max_cycles);
+			int ok = r.done && r.ntt_runs == programs[p].ntt_runs && r.pwm_runs == programs[p].pwm_runs &&
+					 r.rns_runs == programs[p].rns_runs;
+
+			printf("%-24s %-24s %s after %6u cycles (NTT %u, PWM %u, RNS %u) %s\n", programs[p].name, modes[mode],
+				   r.done ? "done" : "HANG", r.cycles, r.ntt_runs, r.pwm_runs, r.rns_runs, ok ? "ok" : "FAIL");
+			if(mode == PHASE_CLEAR_ON_ISSUE)
+				failed |= !ok;
+		}
+	}
+
+	// encryption program per modulus with the single- and the double-rate PWM
+	uint64_t ins[INS_BUFFER_SIZE];
+	uint32_t cycles[2];
+	initInsBuffer(ins, programs[0].words, programs[0].num_words);
+	for(uint32_t rate = 1; rate <= 2; ++rate)
+	{
+		unitLatencies(log_n, rate);
+		cycles[rate-1] = simulate(ins, PHASE_CLEAR_ON_ISSUE, max_cycles).cycles;
+	}
+	printf("\n%s, N = 2^%u: %u cycles with 1 PWM coefficient per cycle, %u with 2 (-%u, %.1f%%)\n",
+		   programs[0].name, log_n, cycles[0], cycles[1], cycles[0] - cycles[1],
+		   100.0*(cycles[0] - cycles[1])/cycles[0]);
+	return failed;
+}
@@ -0,0 +1,289 @@
+/*********************************************
+ * This host tool measures the key generation,
+ * the relinearization key generation and the
+ * Galois key generation of ckks_keygen,
+ * ckks_rlkgen and ckks_galkgen (see
+ * Aloha-HE_Software/ckksAccelerator.c) on the
+ * host CPU with the reference model as the
+ * baseline of the on-chip key generation.
+ *
+ * Build: gcc -O2 -o keygen keygen.c ckksReference.c
+ *            ../Aloha-HE_Software/Testing/testVectors.c -lm -lpthread
+ * Usage: keygen [-n log_n] [-m max_moduli] [-t trials] [-s seed]
+ *               [-g steps]
+ *
+ * The moduli are the first max_moduli primes
+ * q = 2^54 - qm*2^24 + 1 (log_q = 8) with
+ * increasing qm, the NTT uses the smallest
+ * primitive 2N-th root of unity of each q
+ * instead of the twiddle factors of the ROM.
+ * For 1..max_moduli moduli, the mean time of
+ * trials runs is reported (single thread).
+ *
+ * Every run is checked: the secret key must be
+ * ternary, and the errors pk0*R^-1 + a*s of the
+ * public key and b_ij + a_ij*s - [i==j]*s^2 of
+ * the relinearization key must be within the
+ * bound of the centered binomial distribution,
+ * as must the errors of the Galois key for a
+ * rotation by steps slots (1 by default) with
+ * s(X^k) instead of s^2. The automorphism of
+ * the NTT domain must match the NTT of the
+ * automorphism of the coefficient domain.
+*********************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "ckksReference.h"
+
+#define LOG_Q        8
+#define MAX_MODULI   8
+#define CBD_BOUND    21  // largest magnitude of the centered binomial errors
+#define MONT_LOG_R   72
+
+typedef unsigned __int128 uint128_t;
+
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t q)
+{
+	return (uint64_t)((uint128_t)a * b % q);
+}
+
+static uint64_t powMod(uint64_t a, uint64_t e, uint64_t q)
+{
+	uint64_t r = 1;
+	for(; e; e >>= 1, a = mulMod(a, a, q))
+		if(e & 1)
+			r = mulMod(r, a, q);
+	return r;
+}
+
+static int isPrime(uint64_t q)
+{
+	static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+	uint64_t d = q - 1;
+	uint32_t s = 0;
+	for(; !(d & 1); d >>= 1, ++s);
+	for(uint32_t i = 0; i < sizeof(bases)/sizeof(bases[0]); ++i)
+	{
+		uint64_t x = powMod(bases[i], d, q);
+		if(x == 1 || x == q - 1)
+			continue;
+		uint32_t r = 1;
+		for(; r < s && x != q - 1; ++r)
+			x = mulMod(x, x, q);
+		if(x != q - 1)
+			return 0;
+	}
+	return 1;
+}
+
+// Smallest primitive 2n-th root of unity modulo q
+static uint64_t rootOfUnity(uint64_t q, uint32_t n)
+{
+	for(uint64_t g = 2;; ++g)
+	{
+		uint64_t psi = powMod(g, (q - 1) / (2*n), q);
+		if(powMod(psi, n, q) == q - 1)
+			return psi;
+	}
+}
+
+static uint64_t* allocPolys(uint32_t num, uint32_t n, uint64_t** polys)
+{
+	uint64_t* words = malloc((size_t)num*n*sizeof(uint64_t));
+	if(!words)
+	{
+		fprintf(stderr, "Out of memory\n");
+		exit(1);
+	}
+	for(uint32_t i = 0; i < num; ++i)
+		polys[i] = words + (size_t)i*n;
+	return words;
+}
+
+static double elapsedMs(const struct timespec* start, const struct timespec* end)
+{
+	return (end->tv_sec - start->tv_sec)*1e3 + (end->tv_nsec - start->tv_nsec)*1e-6;
+}
+
+// Largest magnitude of INTT(a) with the coefficients centered around 0
+static uint64_t maxCentered(uint64_t* a, uint32_t n, uint64_t psi, uint64_t q)
+{
+	uint64_t max = 0;
+	refNttInverse(a, n, psi, q);
+	for(uint32_t i = 0; i < n; ++i)
+	{
+		uint64_t x = a[i] > q/2 ? q - a[i] : a[i];
+		if(x > max)
+			max = x;
+	}
+	return max;
+}
+
+// Errors b_ij + a_ij*s - [i==j]*target_j of a key switching key, returns the
+// number of failed checks. target holds the n words of modulus j.
+static uint32_t checkSwitchKey(uint32_t n, uint32_t num_moduli, uint32_t j, const uint64_t* q, const uint64_t* psi,
+                               const uint32_t* log_q, const uint64_t* seeds, const uint64_t* s, const uint64_t* target,
+                               uint64_t** ksk, uint64_t* a, uint64_t* t)
+{
+	uint64_t r_inv = powMod(powMod(2, MONT_LOG_R, q[j]), q[j] - 2, q[j]);
+	uint32_t failed = 0;
+	for(uint32_t i = 0; i < num_moduli; ++i)
+	{
+		refSamplePk1(seeds[i*num_moduli + j], log_q[j], q[j], n, a);
+		for(uint32_t k = 0; k < n; ++k)
+		{
+			uint64_t x = (ksk[i*num_moduli + j][k] + mulMod(mulMod(a[k], r_inv, q[j]), s[k], q[j])) % q[j];
+			uint64_t y = i == j ? target[k] : 0;
+			t[k] = x >= y ? x - y : x + q[j] - y;
+		}
+		failed += maxCentered(t, n, psi[j], q[j]) > CBD_BOUND;
+	}
+	return failed;
+}
+
+// Checks sk, pk0, rlk and gk, returns the number of failed checks.
+static uint32_t check(uint32_t n, uint32_t num_moduli, const uint64_t* q, const uint64_t* psi, const uint32_t* log_q,
+                      const uint64_t* pk1_seeds, const uint64_t* rlk_seeds, const uint64_t* gk_seeds,
+                      uint32_t galois, uint64_t** sk, uint64_t** pk0, uint64_t** rlk, uint64_t** gk)
+{
+	uint64_t* s = malloc(n*sizeof(uint64_t));
+	uint64_t* a = malloc(n*sizeof(uint64_t));
+	uint64_t* t = malloc(n*sizeof(uint64_t));
+	uint64_t* u = malloc(n*sizeof(uint64_t));
+	uint32_t failed = 0;
+
+	for(uint32_t j = 0; j < num_moduli; ++j)
+	{
+		uint64_t r_inv = powMod(powMod(2, MONT_LOG_R, q[j]), q[j] - 2, q[j]);
+
+		for(uint32_t k = 0; k < n; ++k)
+			s[k] = mulMod(sk[j][k], r_inv, q[j]);
+		memcpy(t, s, n*sizeof(uint64_t));
+		failed += maxCentered(t, n, psi[j], q[j]) > 1;
+
+		refSamplePk1(pk1_seeds[j], log_q[j], q[j], n, a);
+		for(uint32_t k = 0; k < n; ++k)
+			t[k] = (mulMod(pk0[j][k], r_inv, q[j]) + mulMod(mulMod(a[k], r_inv, q[j]), s[k], q[j])) % q[j];
+		failed += maxCentered(t, n, psi[j], q[j]) > CBD_BOUND;
+
+		for(uint32_t k = 0; k < n; ++k)
+			u[k] = mulMod(s[k], s[k], q[j]);
+		failed += checkSwitchKey(n, num_moduli, j, q, psi, log_q, rlk_seeds, s, u, rlk, a, t);
+
+		refAutomorphism(u, s, n, galois, 1, q[j]);
+		failed += checkSwitchKey(n, num_moduli, j, q, psi, log_q, gk_seeds, s, u, gk, a, t);
+
+		// NTT(s(X^k)) must be the permutation of NTT(s)
+		memcpy(t, s, n*sizeof(uint64_t));
+		refNttInverse(t, n, psi[j], q[j]);
+		refAutomorphism(a, t, n, galois, 0, q[j]);
+		refNttForward(a, n, psi[j], q[j]);
+		failed += memcmp(a, u, n*sizeof(uint64_t)) != 0;
+	}
+	free(s);
+	free(a);
+	free(t);
+	free(u);
+	return failed;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t log_n = 15, max_moduli = 5, trials = 3;
+	int32_t steps = 1;
+	uint64_t seed = 1;
+	uint64_t q[MAX_MODULI], psi[MAX_MODULI], pk1_seeds[MAX_MODULI], rlk_error_seeds[MAX_MODULI];
+	uint64_t rlk_seeds[MAX_MODULI*MAX_MODULI], gk_seeds[MAX_MODULI*MAX_MODULI];
+	uint32_t log_q[MAX_MODULI];
+	uint64_t* sk[MAX_MODULI];
+	uint64_t* pk0[MAX_MODULI];
+	uint64_t* rlk[MAX_MODULI*MAX_MODULI];
+	uint64_t* gk[MAX_MODULI*MAX_MODULI];
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-n") && i + 1 < argc)
+			log_n = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-m") && i + 1 < argc)
+			max_moduli = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-t") && i + 1 < argc)
+			trials = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-s") && i + 1 < argc)
+			seed = strtoull(argv[++i], NULL, 0);
+		else if(!strcmp(argv[i], "-g") && i + 1 < argc)
+			steps = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: %s [-n log_n] [-m max_moduli] [-t trials] [-s seed] [-g steps]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(log_n < 2 || log_n > 16 || max_moduli < 1 || max_moduli > MAX_MODULI || !trials)
+	{
+		fprintf(stderr, "log_n must be in [2, 16], max_moduli in [1, %u] and trials positive\n", MAX_MODULI);
+		return 1;
+	}
+
+	uint32_t n = 1u << log_n, num_found = 0;
+	for(uint32_t qm = 1; num_found < max_moduli; ++qm)
+	{
+		uint64_t candidate = (1ull << (46 + LOG_Q)) - ((uint64_t)qm << 24) + 1;
+		if(!isPrime(candidate))
+			continue;
+		q[num_found] = candidate;
+		psi[num_found] = rootOfUnity(candidate, n);
+		log_q[num_found++] = LOG_Q;
+	}
+	for(uint32_t i = 0; i < MAX_MODULI; ++i)
+	{
+		pk1_seeds[i] = seed + 1 + i;
+		rlk_error_seeds[i] = seed + 1 + MAX_MODULI + i;
+	}
+	for(uint32_t i = 0; i < MAX_MODULI*MAX_MODULI; ++i)
+	{
+		rlk_seeds[i] = seed + 1 + 2*MAX_MODULI + i;
+		gk_seeds[i] = seed + 1 + 2*MAX_MODULI + MAX_MODULI*MAX_MODULI + i;
+	}
+	uint32_t galois = refGaloisElement(steps, n);
+	uint64_t* sk_words = allocPolys(max_moduli, n, sk);
+	uint64_t* pk0_words = allocPolys(max_moduli, n, pk0);
+	uint64_t* rlk_words = allocPolys(max_moduli*max_moduli, n, rlk);
+	uint64_t* gk_words = allocPolys(max_moduli*max_moduli, n, gk);
+
+	printf("N = 2^%u, %u trials, rotation by %d (k = %u)\n", log_n, trials, steps, galois);
+	printf("%7s %12s %12s %12s %8s\n", "moduli", "keygen_ms", "rlkgen_ms", "galkgen_ms", "checks");
+	uint32_t failed = 0;
+	for(uint32_t num_moduli = 1; num_moduli <= max_moduli; ++num_moduli)
+	{
+		struct timespec start, mid, end, gal;
+		double keygen_ms = 0, rlkgen_ms = 0, galkgen_ms = 0;
+		uint32_t run_failed = 0;
+		for(uint32_t t = 0; t < trials; ++t)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			refKeygen(n, num_moduli, q, psi, log_q, seed, pk1_seeds, sk, pk0);
+			clock_gettime(CLOCK_MONOTONIC, &mid);
+			refRlkgen(n, num_moduli, q, psi, log_q, rlk_error_seeds, rlk_seeds, sk, rlk);
+			clock_gettime(CLOCK_MONOTONIC, &end);
+			refGalkgen(n, num_moduli, q, psi, log_q, rlk_error_seeds, gk_seeds, sk, gk, galois);
+			clock_gettime(CLOCK_MONOTONIC, &gal);
+			keygen_ms += elapsedMs(&start, &mid)/trials;
+			rlkgen_ms += elapsedMs(&mid, &end)/trials;
+			galkgen_ms += elapsedMs(&end, &gal)/trials;
+		}
+		run_failed = check(n, num_moduli, q, psi, log_q, pk1_seeds, rlk_seeds, gk_seeds, galois, sk, pk0, rlk, gk);
+		failed += run_failed;
+		printf("%7u %12.2f %12.2f %12.2f %8s\n", num_moduli, keygen_ms, rlkgen_ms, galkgen_ms,
+				run_failed ? "FAILED" : "ok");
+	}
+
+	free(sk_words);
+	free(pk0_words);
+	free(rlk_words);
+	free(gk_words);
+	return failed != 0;
+}
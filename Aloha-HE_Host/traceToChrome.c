@@ -0,0 +1,106 @@
+/*********************************************
+ * This host tool converts the execution trace
+ * printed by printTrace() (see communication.c)
+ * into the Chrome trace event format. The result
+ * can be opened in chrome://tracing or Perfetto.
+ *
+ * Build: gcc -O2 -o traceToChrome traceToChrome.c
+ * Usage: traceToChrome [-f freq_mhz] [uart_log] > trace.json
+ *
+ * Lines of the log not starting with "TRACE," are
+ * ignored, so the whole serial output can be passed.
+ * Each program execution is one row (tid) of the
+ * timeline. Gaps between the end of an instruction
+ * and the start of the next are emitted as "idle".
+*********************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Opcode definition. Must comply with hardware (see ComputeCore.v)
+#define OPC_TRANSFORMATION (1)
+#define OPC_RNS            (2)
+#define OPC_I2F            (3)
+#define OPC_PWM            (4)
+#define OPC_PROJECT        (5)
+#define OPC_AUTOMORPHISM   (6)
+
+#define MAX_LINE 256
+
+// Returns the instruction name of an opcode. For transformations, OP1[1]
+// selects FFT/NTT and OP1[0] the DIF/DIT variant (see instruction.c).
+static const char* insName(uint32_t opcode, uint32_t op1)
+{
+	switch(opcode)
+	{
+	case OPC_TRANSFORMATION:
+		if(op1 & 0x2)
+			return (op1 & 0x1) ? "FFT" : "IFFT";
+		return (op1 & 0x1) ? "INTT" : "NTT";
+	case OPC_RNS:     return "RNS";
+	case OPC_I2F:     return "I2F";
+	case OPC_PWM:     return "PWM";
+	case OPC_PROJECT: return "PROJECT";
+	case OPC_AUTOMORPHISM: return "AUTOMORPHISM";
+	default:          return "UNKNOWN";
+	}
+}
+
+static void printEvent(int* first, const char* name, uint32_t program, uint32_t index,
+		uint32_t start, uint32_t end, double freq_mhz)
+{
+	printf("%s\n    {\"name\": \"%s\", \"cat\": \"aloha\", \"ph\": \"X\", \"pid\": 0, \"tid\": %u, "
+			"\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"ir_index\": %u, \"start_cycle\": %u, \"cycles\": %u}}",
+			*first ? "" : ",", name, program, start/freq_mhz, (end-start)/freq_mhz, index, start, end-start);
+	*first = 0;
+}
+
+int main(int argc, char** argv)
+{
+	double freq_mhz = 150.0;
+	FILE* in = stdin;
+	char line[MAX_LINE];
+	int first = 1;
+	int have_prev = 0;
+	uint32_t prev_program = 0, prev_end = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "-f") && i+1 < argc)
+			freq_mhz = atof(argv[++i]);
+		else if(!(in = fopen(argv[i], "r")))
+		{
+			fprintf(stderr, "Cannot open %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if(freq_mhz <= 0)
+	{
+		fprintf(stderr, "Invalid frequency\n");
+		return 1;
+	}
+
+	printf("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+	while(fgets(line, sizeof(line), in))
+	{
+		uint32_t program, index, opcode, op1, start, end;
+		char* p = strstr(line, "TRACE,");
+		if(!p || sscanf(p, "TRACE,%u,%u,%u,%u,%u,%u", &program, &index, &opcode, &op1, &start, &end) != 6)
+			continue;
+
+		if(have_prev && prev_program == program && start > prev_end)
+			printEvent(&first, "idle", program, index, prev_end, start, freq_mhz);
+		printEvent(&first, insName(opcode, op1), program, index, start, end, freq_mhz);
+
+		have_prev = 1;
+		prev_program = program;
+		prev_end = end;
+	}
+	printf("\n]}\n");
+
+	if(in != stdin)
+		fclose(in);
+	return 0;
+}
@@ -55,6 +55,8 @@
 #    "../Aloha-HE_Common/SharedArithmetics/IntMultiplier_54x54.sv"
 #    "../Aloha-HE_Common/FloatingPoint/IntToFlP.sv"
 #    "../Aloha-HE_Common/FloatingPoint/IntToFlPWrapper.sv"
+#    "../Aloha-HE_Common/FloatingPoint/DoubleToPlaintext.sv"
+#    "../Aloha-HE_Common/FloatingPoint/PlaintextToDouble.sv"
 #    "../Aloha-HE_Common/Utils/LeadingZeroCount.sv"
 #    "../Aloha-HE_Common/ModRing/ModAdd.sv"
 #    "../Aloha-HE_Common/ModRing/ModMul.sv"
@@ -63,6 +65,7 @@
 #    "../Aloha-HE_Common/ModRing/MontRed_Stage.sv"
 #    "../Aloha-HE_Common/ModRing/NTTButterfly.sv"
 #    "../Aloha-HE_Common/ModRing/PWM.sv"
+#    "../Aloha-HE_Common/ModRing/Automorphism.sv"
 #    "../Aloha-HE_Common/Utils/Project.sv"
 #    "../Aloha-HE_Common/ModRing/RNS.sv"
 #    "../Aloha-HE_Common/ModRing/RNSErrorPolys.sv"
@@ -95,6 +98,10 @@ if { [info exists ::user_project_name] } {
   set _xil_proj_name_ $::user_project_name
 }
 
+# Clock of the accelerator (ComputeCoreWrapper, AXISlave8Ports and the AXI BRAM
+# controller) in MHz. 0 runs the accelerator on the MicroBlaze/AXI clock.
+set core_clk_mhz 0
+
 variable script_file
 set script_file "Aloha-HE_Kintex_new.tcl"
 
@@ -110,6 +117,7 @@ proc print_help {} {
   puts "$script_file"
   puts "$script_file -tclargs \[--origin_dir <path>\]"
   puts "$script_file -tclargs \[--project_name <name>\]"
+  puts "$script_file -tclargs \[--core_clk_mhz <freq>\]"
   puts "$script_file -tclargs \[--help\]\n"
   puts "Usage:"
   puts "Name                   Description"
@@ -121,6 +129,10 @@ proc print_help {} {
   puts "\[--project_name <name>\] Create project with the specified name. Default"
   puts "                       name is the name of the project from where this"
   puts "                       script was generated.\n"
+  puts "\[--core_clk_mhz <freq>\] Clock the accelerator with a second output of"
+  puts "                       clk_wiz_0 at <freq> MHz. The AXI interconnects"
+  puts "                       cross to the bus clock. Default is 0, i.e., the"
+  puts "                       accelerator runs on the bus clock.\n"
   puts "\[--help\]               Print help information for this script"
   puts "-------------------------------------------------------------------------\n"
   exit 0
@@ -132,6 +144,7 @@ if { $::argc > 0 } {
     switch -regexp -- $option {
       "--origin_dir"   { incr i; set origin_dir [lindex $::argv $i] }
       "--project_name" { incr i; set _xil_proj_name_ [lindex $::argv $i] }
+      "--core_clk_mhz" { incr i; set core_clk_mhz [lindex $::argv $i] }
       "--help"         { print_help }
       default {
         if { [regexp {^-} $option] } {
@@ -251,6 +264,8 @@ set files [list \
  [file normalize "../Aloha-HE_Common/SharedArithmetics/IntMultiplier_54x54.sv"] \
  [file normalize "../Aloha-HE_Common/FloatingPoint/IntToFlP.sv"] \
  [file normalize "../Aloha-HE_Common/FloatingPoint/IntToFlPWrapper.sv"] \
+ [file normalize "../Aloha-HE_Common/FloatingPoint/DoubleToPlaintext.sv"] \
+ [file normalize "../Aloha-HE_Common/FloatingPoint/PlaintextToDouble.sv"] \
  [file normalize "../Aloha-HE_Common/Utils/LeadingZeroCount.sv"] \
  [file normalize "../Aloha-HE_Common/ModRing/ModAdd.sv"] \
  [file normalize "../Aloha-HE_Common/ModRing/ModMul.sv"] \
@@ -259,6 +274,7 @@ set files [list \
  [file normalize "../Aloha-HE_Common/ModRing/MontRed_Stage.sv"] \
  [file normalize "../Aloha-HE_Common/ModRing/NTTButterfly.sv"] \
  [file normalize "../Aloha-HE_Common/ModRing/PWM.sv"] \
+ [file normalize "../Aloha-HE_Common/ModRing/Automorphism.sv"] \
  [file normalize "../Aloha-HE_Common/Utils/Project.sv"] \
  [file normalize "../Aloha-HE_Common/ModRing/RNS.sv"] \
  [file normalize "../Aloha-HE_Common/ModRing/RNSErrorPolys.sv"] \
@@ -665,6 +681,32 @@ set_property -name "used_in_implementation" -value "1" -objects $file_obj
 set_property -name "used_in_simulation" -value "1" -objects $file_obj
 set_property -name "used_in_synthesis" -value "1" -objects $file_obj
 
+set file "../Aloha-HE_Common/FloatingPoint/DoubleToPlaintext.sv"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "SystemVerilog" -objects $file_obj
+set_property -name "is_enabled" -value "1" -objects $file_obj
+set_property -name "is_global_include" -value "0" -objects $file_obj
+set_property -name "library" -value "xil_defaultlib" -objects $file_obj
+set_property -name "path_mode" -value "RelativeFirst" -objects $file_obj
+set_property -name "used_in" -value "synthesis implementation simulation" -objects $file_obj
+set_property -name "used_in_implementation" -value "1" -objects $file_obj
+set_property -name "used_in_simulation" -value "1" -objects $file_obj
+set_property -name "used_in_synthesis" -value "1" -objects $file_obj
+
+set file "../Aloha-HE_Common/FloatingPoint/PlaintextToDouble.sv"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "SystemVerilog" -objects $file_obj
+set_property -name "is_enabled" -value "1" -objects $file_obj
+set_property -name "is_global_include" -value "0" -objects $file_obj
+set_property -name "library" -value "xil_defaultlib" -objects $file_obj
+set_property -name "path_mode" -value "RelativeFirst" -objects $file_obj
+set_property -name "used_in" -value "synthesis implementation simulation" -objects $file_obj
+set_property -name "used_in_implementation" -value "1" -objects $file_obj
+set_property -name "used_in_simulation" -value "1" -objects $file_obj
+set_property -name "used_in_synthesis" -value "1" -objects $file_obj
+
 set file "../Aloha-HE_Common/Utils/LeadingZeroCount.sv"
 set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
@@ -769,6 +811,19 @@ set_property -name "used_in_implementation" -value "1" -objects $file_obj
 set_property -name "used_in_simulation" -value "1" -objects $file_obj
 set_property -name "used_in_synthesis" -value "1" -objects $file_obj
 
+set file "../Aloha-HE_Common/ModRing/Automorphism.sv"
+set file [file normalize $file]
+set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
+set_property -name "file_type" -value "SystemVerilog" -objects $file_obj
+set_property -name "is_enabled" -value "1" -objects $file_obj
+set_property -name "is_global_include" -value "0" -objects $file_obj
+set_property -name "library" -value "xil_defaultlib" -objects $file_obj
+set_property -name "path_mode" -value "RelativeFirst" -objects $file_obj
+set_property -name "used_in" -value "synthesis implementation simulation" -objects $file_obj
+set_property -name "used_in_implementation" -value "1" -objects $file_obj
+set_property -name "used_in_simulation" -value "1" -objects $file_obj
+set_property -name "used_in_synthesis" -value "1" -objects $file_obj
+
 set file "../Aloha-HE_Common/Utils/Project.sv"
 set file [file normalize $file]
 set file_obj [get_files -of_objects [get_filesets sources_1] [list "*$file"]]
@@ -1268,6 +1323,12 @@ if { [get_files IntToFlP.sv] == "" } {
 if { [get_files IntToFlPWrapper.sv] == "" } {
   import_files -quiet -fileset sources_1 ../Aloha-HE_Common/FloatingPoint/IntToFlPWrapper.sv
 }
+if { [get_files DoubleToPlaintext.sv] == "" } {
+  import_files -quiet -fileset sources_1 ../Aloha-HE_Common/FloatingPoint/DoubleToPlaintext.sv
+}
+if { [get_files PlaintextToDouble.sv] == "" } {
+  import_files -quiet -fileset sources_1 ../Aloha-HE_Common/FloatingPoint/PlaintextToDouble.sv
+}
 if { [get_files LeadingZeroCount.sv] == "" } {
   import_files -quiet -fileset sources_1 ../Aloha-HE_Common/Utils/LeadingZeroCount.sv
 }
@@ -1292,6 +1353,9 @@ if { [get_files NTTButterfly.sv] == "" } {
 if { [get_files PWM.sv] == "" } {
   import_files -quiet -fileset sources_1 ../Aloha-HE_Common/ModRing/PWM.sv
 }
+if { [get_files Automorphism.sv] == "" } {
+  import_files -quiet -fileset sources_1 ../Aloha-HE_Common/ModRing/Automorphism.sv
+}
 if { [get_files Project.sv] == "" } {
   import_files -quiet -fileset sources_1 ../Aloha-HE_Common/Utils/Project.sv
 }
@@ -1915,8 +1979,40 @@ proc create_hier_cell_microblaze_1_local_memory { parentCell nameHier } {
   connect_bd_net -net rst_mig_7series_0_100M_peripheral_aresetn [get_bd_pins mig_7series_0/aresetn] [get_bd_pins rst_mig_7series_0_100M/peripheral_aresetn]
   connect_bd_net -net xlconstant_0_dout [get_bd_pins axi_timer_0/capturetrig0] [get_bd_pins axi_timer_0/capturetrig1] [get_bd_pins axi_timer_0/freeze] [get_bd_pins xlconstant_0/dout]
 
+  # Separate accelerator clock: clk_out2 of clk_wiz_0 drives the accelerator
+  # side of the AXI interconnects, which insert asynchronous clock converters
+  # for the register port (M02) and the DMA port (M00). Therefore, control,
+  # status and BRAM accesses stay synchronous to the compute clock.
+  if { $::core_clk_mhz > 0 } {
+    set_property -dict [ list \
+     CONFIG.CLKOUT2_USED {true} \
+     CONFIG.CLKOUT2_REQUESTED_OUT_FREQ $::core_clk_mhz \
+     CONFIG.NUM_OUT_CLKS {2} \
+   ] $clk_wiz_0
+
+    set rst_core_clk [ create_bd_cell -type ip -vlnv xilinx.com:ip:proc_sys_reset:5.0 rst_core_clk ]
+    set_property -dict [ list \
+     CONFIG.RESET_BOARD_INTERFACE {reset} \
+     CONFIG.USE_BOARD_FLOW {true} \
+   ] $rst_core_clk
+
+    set core_clk_pins [list AXISlave8Ports_0/s00_axi_aclk ComputeCoreWrapper_0/clk axi_bram_ctrl_0/s_axi_aclk axi_interconnect_0/M00_ACLK microblaze_0_axi_periph/M02_ACLK]
+    set core_rst_pins [list AXISlave8Ports_0/s00_axi_aresetn axi_bram_ctrl_0/s_axi_aresetn axi_interconnect_0/M00_ARESETN microblaze_0_axi_periph/M02_ARESETN]
+    foreach pin $core_clk_pins {
+      disconnect_bd_net /microblaze_1_Clk [get_bd_pins $pin]
+    }
+    foreach pin $core_rst_pins {
+      disconnect_bd_net /proc_sys_reset_0_peripheral_aresetn [get_bd_pins $pin]
+    }
+    connect_bd_net -net clk_wiz_0_clk_out2 [get_bd_pins clk_wiz_0/clk_out2] [get_bd_pins rst_core_clk/slowest_sync_clk] [get_bd_pins $core_clk_pins]
+    connect_bd_net -net rst_core_clk_peripheral_aresetn [get_bd_pins rst_core_clk/peripheral_aresetn] [get_bd_pins $core_rst_pins]
+    connect_bd_net [get_bd_pins clk_wiz_0/locked] [get_bd_pins rst_core_clk/dcm_locked]
+    connect_bd_net [get_bd_ports reset] [get_bd_pins rst_core_clk/ext_reset_in]
+    connect_bd_net [get_bd_pins mdm_1/Debug_SYS_Rst] [get_bd_pins rst_core_clk/mb_debug_sys_rst]
+  }
+
   # Create address segments
-  create_bd_addr_seg -range 0x00100000 -offset 0xC0000000 [get_bd_addr_spaces axi_cdma_0/Data] [get_bd_addr_segs axi_bram_ctrl_0/S_AXI/Mem0] SEG_axi_bram_ctrl_0_Mem0
+  create_bd_addr_seg -range 0x00200000 -offset 0xC0000000 [get_bd_addr_spaces axi_cdma_0/Data] [get_bd_addr_segs axi_bram_ctrl_0/S_AXI/Mem0] SEG_axi_bram_ctrl_0_Mem0
   create_bd_addr_seg -range 0x40000000 -offset 0x80000000 [get_bd_addr_spaces axi_cdma_0/Data] [get_bd_addr_segs mig_7series_0/memmap/memaddr] SEG_mig_7series_0_memaddr
   create_bd_addr_seg -range 0x00010000 -offset 0x44A20000 [get_bd_addr_spaces microblaze_1/Data] [get_bd_addr_segs AXISlave8Ports_0/s00_axi/reg0] SEG_AXISlave8Ports_0_reg0
   create_bd_addr_seg -range 0x00010000 -offset 0x44A10000 [get_bd_addr_spaces microblaze_1/Data] [get_bd_addr_segs axi_cdma_0/S_AXI_LITE/Reg] SEG_axi_cdma_0_Reg
@@ -0,0 +1,246 @@
+/****************************************
+ * Benchmark Code
+ *
+ * This file measures the latency of each
+ * instruction in isolation and of the
+ * end-to-end encode+encrypt and
+ * decrypt+decode paths for all supported
+ * polynomial degrees and 1..BENCH_MAX_MODULI
+ * moduli. Results are printed as JSON
+ * between BENCH_JSON_BEGIN and BENCH_JSON_END.
+ * Besides the wall-clock latency, each result
+ * reports the co-processor cycles per run, so
+ * the compute time can be told apart from the
+ * bus and DMA time if the co-processor runs on
+ * its own clock. The end-to-end paths are
+ * also measured with the packed float32 and
+ * fixed32 plaintext formats and with sparse
+ * packing (fewer slots than N/2), with the
+ * pk0 cache and, for N < 2^15, with pk0
+ * residues resident in the key BRAM. Each
+ * result reports the bytes of pk0 per run
+ * that the cache saved.
+ * Key generation and relinearization key
+ * generation are measured per number of
+ * moduli.
+ *
+ * Only the driver API is used, so the same
+ * code runs on every backend implementing it.
+ ***************************************/
+
+#include "xparameters.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../communication.h"
+#include "../instruction.h"
+#include "../xtime_l.h"
+#include "../ckksAccelerator.h"
+#include "instrTest.h"
+#include "benchmark.h"
+
+#define BENCH_BACKEND     "board" // name of the backend reported in the JSON output
+#define BENCH_WARMUP      4       // untimed iterations before each measurement
+#define BENCH_ITERATIONS  100     // timed iterations of each measurement
+#define BENCH_MAX_MODULI  5       // encryption is measured with 1..BENCH_MAX_MODULI moduli
+#define BENCH_RLK_MODULI  3       // rlkgen is measured with 1..BENCH_RLK_MODULI moduli
+
+#define MAX_POLY_SIZE (1<<15)
+#define ALIGN __attribute__((aligned(1<<15)))
+
+extern const uint64_t CPU_FREQ_MHZ;
+extern const uint64_t COPROC_FREQ_MHZ;
+
+// Latency does not depend on the operand values. Therefore, zero-initialized
+// buffers and the first entries of the modulus ROM are used.
+static uint64_t bench_plaintext[MAX_POLY_SIZE] ALIGN;
+static uint64_t bench_c0[BENCH_MAX_MODULI][MAX_POLY_SIZE] ALIGN;
+static uint64_t bench_c1[BENCH_MAX_MODULI][MAX_POLY_SIZE] ALIGN;
+static uint64_t bench_pk0[BENCH_MAX_MODULI][MAX_POLY_SIZE] ALIGN;
+static uint64_t bench_sk[MAX_POLY_SIZE] ALIGN;
+static uint64_t bench_keygen_sk[BENCH_MAX_MODULI][MAX_POLY_SIZE] ALIGN;
+static uint64_t bench_rlk[BENCH_RLK_MODULI*BENCH_RLK_MODULI][MAX_POLY_SIZE] ALIGN;
+static uint64_t bench_scratch[(2+BENCH_RLK_MODULI)*MAX_POLY_SIZE] ALIGN;
+
+static uint64_t* bench_c0_ptr[BENCH_MAX_MODULI];
+static uint64_t* bench_c1_ptr[BENCH_MAX_MODULI];
+static uint64_t* bench_pk0_ptr[BENCH_MAX_MODULI];
+static uint64_t* bench_keygen_sk_ptr[BENCH_MAX_MODULI];
+static uint64_t* bench_rlk_ptr[BENCH_RLK_MODULI*BENCH_RLK_MODULI];
+static uint64_t bench_rlk_seeds[BENCH_RLK_MODULI*BENCH_RLK_MODULI] = {6, 7, 8, 9, 10, 11, 12, 13, 14};
+static uint64_t bench_pk1_seeds[BENCH_MAX_MODULI] = {1, 2, 3, 4, 5};
+static uint32_t bench_rom_indices[BENCH_MAX_MODULI] = {0, 1, 2, 3, 4};
+static uint32_t bench_qm[BENCH_MAX_MODULI] = {1, 2, 3, 4, 5};
+static uint32_t bench_log_q[BENCH_MAX_MODULI] = {8, 8, 8, 8, 8};
+static const int32_t bench_log_scale = 40;
+
+static XTime samples[BENCH_ITERATIONS];
+static char first_result;
+static uint32_t bench_slots; // slots of the plaintext (see ckks_set_slots)
+
+enum BenchOp
+{
+	BENCH_FFT, BENCH_IFFT, BENCH_RNS, BENCH_NTT, BENCH_INTT,
+	BENCH_I2F, BENCH_PWM, BENCH_PROJECT, BENCH_AUTOMORPHISM, BENCH_ENCRYPT, BENCH_DECRYPT,
+	BENCH_ENCRYPT_FLOAT32, BENCH_DECRYPT_FLOAT32, BENCH_ENCRYPT_FIXED32, BENCH_DECRYPT_FIXED32,
+	BENCH_ENCRYPT_PK0_CACHE, BENCH_ENCRYPT_RESIDENT_PK0, BENCH_KEYGEN, BENCH_RLKGEN
+};
+
+static const char* bench_op_names[] = {
+	"fft", "ifft", "rns", "ntt", "intt", "i2f", "pwm", "project", "automorphism", "encode_encrypt", "decrypt_decode",
+	"encode_encrypt_float32", "decrypt_decode_float32", "encode_encrypt_fixed32", "decrypt_decode_fixed32",
+	"encode_encrypt_pk0_cache", "encode_encrypt_resident_pk0", "keygen", "rlkgen"
+};
+
+// Plaintext format of each operation (see setPlaintextFormat).
+static uint8_t benchFormat(enum BenchOp op)
+{
+	switch(op)
+	{
+	case BENCH_ENCRYPT_FLOAT32: case BENCH_DECRYPT_FLOAT32: return PT_FORMAT_FLOAT32;
+	case BENCH_ENCRYPT_FIXED32: case BENCH_DECRYPT_FIXED32: return PT_FORMAT_FIXED32;
+	default: return PT_FORMAT_DOUBLE;
+	}
+}
+
+static void runOp(enum BenchOp op, uint8_t current_n, uint8_t num_moduli)
+{
+	uint32_t poly_size = 1<<(13+current_n);
+	setPlaintextFormat(benchFormat(op), 16);
+	ckks_pk0_cache_use(op == BENCH_ENCRYPT_PK0_CACHE ? 1 : PK0_CACHE_NO_KEY);
+	switch(op)
+	{
+	case BENCH_FFT:     fft_HW(NULL, NULL, 1, 0, 0, current_n); break;
+	case BENCH_IFFT:    fft_HW(NULL, NULL, 0, 0, 0, current_n); break;
+	case BENCH_RNS:     rns_HW(NULL, NULL, NULL, NULL, 0, bench_rom_indices[0], bench_log_scale, bench_qm[0], bench_log_q[0], current_n); break;
+	case BENCH_NTT:     ntt_HW(NULL, NULL, bench_qm[0], bench_log_q[0], bench_rom_indices[0], 1, NTT_MSG_BRAM_ID, 0, 0, current_n); break;
+	case BENCH_INTT:    ntt_HW(NULL, NULL, bench_qm[0], bench_log_q[0], 15, 0, NTT_MSG_BRAM_ID, 0, 0, current_n); break;
+	case BENCH_I2F:     i2f_HW(NULL, NULL, bench_qm[0], bench_log_q[0], -bench_log_scale, current_n); break;
+	case BENCH_PWM:     pwm_HW(NULL, NULL, NULL, NULL, NULL, NULL, NULL, bench_qm[0], bench_log_q[0], current_n); break;
+	case BENCH_PROJECT: prj_HW(NULL, NULL, current_n); break;
+	case BENCH_AUTOMORPHISM: aut_HW(NULL, NULL, 3, 1, bench_qm[0], bench_log_q[0], current_n); break;
+	case BENCH_ENCRYPT:
+	case BENCH_ENCRYPT_FLOAT32:
+	case BENCH_ENCRYPT_FIXED32:
+	case BENCH_ENCRYPT_PK0_CACHE:
+	case BENCH_ENCRYPT_RESIDENT_PK0:
+		ckks_encrypt(bench_c0_ptr, bench_c1_ptr, bench_plaintext, poly_size, 0, bench_pk1_seeds, num_moduli,
+				bench_rom_indices, bench_rom_indices, bench_pk0_ptr, bench_log_scale, bench_qm, bench_log_q);
+		break;
+	case BENCH_DECRYPT:
+	case BENCH_DECRYPT_FLOAT32:
+	case BENCH_DECRYPT_FIXED32:
+		ckks_decrypt(bench_c0[0], bench_c1[0], bench_sk, bench_plaintext, poly_size, bench_qm[0], bench_log_q[0],
+				bench_rom_indices[0], -bench_log_scale);
+		break;
+	case BENCH_KEYGEN:
+		ckks_keygen(bench_keygen_sk_ptr, bench_pk0_ptr, bench_scratch, poly_size, 0, bench_pk1_seeds, num_moduli,
+				bench_rom_indices, bench_rom_indices, bench_qm, bench_log_q);
+		break;
+	case BENCH_RLKGEN:
+		ckks_rlkgen(bench_rlk_ptr, bench_keygen_sk_ptr, bench_scratch, poly_size, bench_pk1_seeds, bench_rlk_seeds,
+				num_moduli, bench_rom_indices, bench_rom_indices, bench_qm, bench_log_q);
+		break;
+	}
+	setPlaintextFormat(PT_FORMAT_DOUBLE, 0);
+	ckks_pk0_cache_use(PK0_CACHE_NO_KEY);
+}
+
+static int compareXTime(const void* a, const void* b)
+{
+	XTime x = *(const XTime*)a, y = *(const XTime*)b;
+	return (x > y) - (x < y);
+}
+
+// Converts timer ticks into microseconds (the timer ticks with half the CPU clock).
+static double toMicroseconds(XTime t)
+{
+	return 2.0*t/CPU_FREQ_MHZ;
+}
+
+// Measures one operation and prints its statistics as one JSON object.
+static void measure(enum BenchOp op, uint8_t current_n, uint8_t num_moduli)
+{
+	XTime tStart, tEnd, total = 0;
+	uint64_t cycles, hits, misses, bytes_saved, bytes_saved_start;
+
+	for(uint32_t i = 0; i < BENCH_WARMUP; ++i)
+		runOp(op, current_n, num_moduli);
+
+	cycles = coprocCycles();
+	ckks_pk0_cache_stats(&hits, &misses, &bytes_saved_start);
+	for(uint32_t i = 0; i < BENCH_ITERATIONS; ++i)
+	{
+		XTime_GetTime(&tStart);
+		runOp(op, current_n, num_moduli);
+		XTime_GetTime(&tEnd);
+		samples[i] = tEnd - tStart;
+		total += samples[i];
+	}
+	cycles = (coprocCycles() - cycles)/BENCH_ITERATIONS;
+	ckks_pk0_cache_stats(&hits, &misses, &bytes_saved);
+	bytes_saved = (bytes_saved - bytes_saved_start)/BENCH_ITERATIONS;
+	qsort(samples, BENCH_ITERATIONS, sizeof(XTime), compareXTime);
+
+	printf("%s\n    {\"n\": %u, \"slots\": %u, \"moduli\": %u, \"op\": \"%s\", \"iterations\": %u, "
+			"\"p50_us\": %.1lf, \"p99_us\": %.1lf, \"max_us\": %.1lf, \"throughput_ops\": %.1lf, "
+			"\"coproc_cycles\": %llu, \"coproc_us\": %.1lf, \"pk0_bytes_saved\": %llu}",
+			first_result ? "" : ",", 1u<<(13+current_n), bench_slots, num_moduli, bench_op_names[op], BENCH_ITERATIONS,
+			toMicroseconds(samples[(BENCH_ITERATIONS-1)*50/100]),
+			toMicroseconds(samples[(BENCH_ITERATIONS*99+99)/100-1]),
+			toMicroseconds(samples[BENCH_ITERATIONS-1]),
+			1000000.0*BENCH_ITERATIONS/toMicroseconds(total),
+			cycles, (double)cycles/COPROC_FREQ_MHZ, bytes_saved);
+	first_result = 0;
+}
+
+void benchmark()
+{
+	for(uint32_t i = 0; i < BENCH_MAX_MODULI; ++i)
+	{
+		bench_c0_ptr[i] = bench_c0[i];
+		bench_c1_ptr[i] = bench_c1[i];
+		bench_pk0_ptr[i] = bench_pk0[i];
+		bench_keygen_sk_ptr[i] = bench_keygen_sk[i];
+	}
+	for(uint32_t i = 0; i < BENCH_RLK_MODULI*BENCH_RLK_MODULI; ++i)
+		bench_rlk_ptr[i] = bench_rlk[i];
+
+	first_result = 1;
+	printf("BENCH_JSON_BEGIN\n");
+	printf("{\"backend\": \"%s\", \"cpu_freq_mhz\": %llu, \"coproc_freq_mhz\": %llu, \"results\": [",
+			BENCH_BACKEND, CPU_FREQ_MHZ, COPROC_FREQ_MHZ);
+	for(uint8_t current_n = 0; current_n < 3; ++current_n)
+	{
+		ckks_init(current_n);
+		bench_slots = 1u<<(12+current_n);
+		for(enum BenchOp op = BENCH_FFT; op <= BENCH_AUTOMORPHISM; ++op)
+			measure(op, current_n, 1);
+		for(uint8_t num_moduli = 1; num_moduli <= BENCH_MAX_MODULI; ++num_moduli)
+			measure(BENCH_ENCRYPT, current_n, num_moduli);
+		measure(BENCH_DECRYPT, current_n, 1);
+		for(enum BenchOp op = BENCH_ENCRYPT_FLOAT32; op <= BENCH_DECRYPT_FIXED32; ++op)
+			measure(op, current_n, 1);
+		for(uint8_t sparse_shift = 1; sparse_shift <= current_n; ++sparse_shift)
+		{
+			bench_slots = 1u<<(12+current_n-sparse_shift);
+			ckks_set_slots(bench_slots);
+			measure(BENCH_ENCRYPT, current_n, 1);
+			measure(BENCH_DECRYPT, current_n, 1);
+		}
+		ckks_set_slots(1u<<(12+current_n));
+		for(uint8_t num_moduli = 1; num_moduli <= BENCH_MAX_MODULI; ++num_moduli)
+			measure(BENCH_ENCRYPT_PK0_CACHE, current_n, num_moduli);
+		ckks_pk0_cache_invalidate(PK0_CACHE_ALL);
+		uint8_t num_resident = ckks_load_resident_pk0(bench_pk0_ptr, BENCH_MAX_MODULI);
+		for(uint8_t num_moduli = 1; num_moduli <= num_resident; ++num_moduli)
+			measure(BENCH_ENCRYPT_RESIDENT_PK0, current_n, num_moduli);
+		ckks_load_resident_pk0(NULL, 0);
+		for(uint8_t num_moduli = 1; num_moduli <= BENCH_MAX_MODULI; ++num_moduli)
+			measure(BENCH_KEYGEN, current_n, num_moduli);
+		for(uint8_t num_moduli = 1; num_moduli <= BENCH_RLK_MODULI; ++num_moduli)
+			measure(BENCH_RLKGEN, current_n, num_moduli);
+	}
+	printf("\n]}\n");
+	printf("BENCH_JSON_END\n");
+}
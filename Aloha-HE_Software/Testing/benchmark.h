@@ -0,0 +1,6 @@
+#ifndef SRC_TESTING_BENCHMARK_H_
+#define SRC_TESTING_BENCHMARK_H_
+
+void benchmark();
+
+#endif /* SRC_TESTING_BENCHMARK_H_ */
@@ -15,6 +15,7 @@
 #include "../instruction.h"
 #include "../xtime_l.h"
 #include "../ckksAccelerator.h"
+#include "../dmaPool.h"
 #include "instrTest.h"
 #include "polyCheck.h"
 
@@ -24,8 +25,12 @@
 #define FAST_ALOHA 			// Runs end-to-end encode+encrypt and decrypt+decode without intermediate checks but with execution timing
 #define TEST_ALOHA     	// Tests a full encode+encrypt and decrypt+decode procedure and validates all intermediate results
 #define POLY_DEGREE 15  // select the polynomial degree to test (13, 14, or 15)
+//#define BINARY_TEST_VECTORS // Reads the test vectors from a binary container (see testVectors.h) instead of the C headers
+#define TEST_VECTOR_ADDR 0xB0000000 // DDR address the container is loaded to, e.g. with xsdb: dow -data vectors.tv 0xB0000000
 
-#if POLY_DEGREE == 13
+#if defined(BINARY_TEST_VECTORS)
+#include "testVectors.h"
+#elif POLY_DEGREE == 13
 #include "referenceEncryption13.h"
 #include "referenceDecryption13.h"
 #elif POLY_DEGREE == 14
@@ -39,17 +44,126 @@
 
 
 const uint64_t CPU_FREQ_MHZ = 150;    // clock frequency of host CPU
-const uint64_t COPROC_FREQ_MHZ = 150; // clock frequency of co-processor
+const uint64_t COPROC_FREQ_MHZ = 150; // clock frequency of co-processor (see --core_clk_mhz)
 
 #define ALIGN __attribute__((aligned(1<<15)))
 
+#if defined(BINARY_TEST_VECTORS)
+// The test vectors are bound to these variables by loadTestVectors(). They have the
+// same names as the arrays in the C headers, so the tests work with both sources.
+// The polynomial degree is taken from the container, POLY_DEGREE is not used.
+static uint8_t current_n;
+static int32_t scale;
+static uint32_t num_moduli;
+static uint64_t error_polys_seed;
+static uint64_t pk1_seeds[TV_MAX_MODULI];
+static uint32_t current_k[TV_MAX_MODULI], qm[TV_MAX_MODULI], constants_select[TV_MAX_MODULI], modulus_select[TV_MAX_MODULI];
+static uint64_t *input, *expanded_input, *fft_expected, *v_poly, *e0_poly, *e1_poly;
+static uint64_t *message_after_rns[TV_MAX_MODULI], *v_poly_ntt[TV_MAX_MODULI], *e1_poly_ntt[TV_MAX_MODULI];
+static uint64_t *pk0[TV_MAX_MODULI], *pk1[TV_MAX_MODULI], *expected_c0[TV_MAX_MODULI], *expected_c1[TV_MAX_MODULI];
+static uint64_t *c0_to_decrypt, *c1_to_decrypt, *sk, *decrypted_m_ntt, *intt_m_reference;
+static uint64_t *ifft_input, *ifft_reference, *projected_reference;
+
+// The results are DMA buffers of the pool, sized for the loaded container.
+static uint64_t *result_c0[TV_MAX_MODULI], *result_c1[TV_MAX_MODULI];
+static uint32_t num_result_polys;
+static uint8_t result_n;
+
+static void freeResults()
+{
+  for(uint32_t i = 0; i < num_result_polys; ++i)
+  {
+    dmaPolyFree(result_c0[i], result_n);
+    dmaPolyFree(result_c1[i], result_n);
+    result_c0[i] = result_c1[i] = NULL;
+  }
+  num_result_polys = 0;
+}
+
+// Binds the test vectors of the container at TEST_VECTOR_ADDR.
+// Returns 0 if the container is invalid or incomplete.
+static char loadTestVectors()
+{
+  const TvHeader* tv = tvOpen((const void*)TEST_VECTOR_ADDR, 0);
+  char complete = 1;
+
+  if(!tv)
+  {
+    printf("No valid test vector container at 0x%x\n", TEST_VECTOR_ADDR);
+    return 0;
+  }
+  freeResults();
+
+  current_n = tv->log_n - 13;
+  scale = tv->log_scale;
+  num_moduli = tv->num_moduli;
+  error_polys_seed = tv->error_polys_seed;
+
+  input = tvGet(tv, TV_INPUT, 0, NULL);
+  expanded_input = tvGet(tv, TV_EXPANDED_INPUT, 0, NULL);
+  fft_expected = tvGet(tv, TV_FFT_EXPECTED, 0, NULL);
+  v_poly = tvGet(tv, TV_V_POLY, 0, NULL);
+  e0_poly = tvGet(tv, TV_E0_POLY, 0, NULL);
+  e1_poly = tvGet(tv, TV_E1_POLY, 0, NULL);
+  complete &= input && expanded_input && fft_expected && v_poly && e0_poly && e1_poly;
+
+  for(uint32_t i = 0; i < num_moduli; ++i)
+  {
+    pk1_seeds[i] = tv->pk1_seeds[i];
+    current_k[i] = tv->log_q[i];
+    qm[i] = tv->qm[i];
+    constants_select[i] = tv->ntt_rom_index[i];
+    modulus_select[i] = tv->rns_rom_index[i];
+    message_after_rns[i] = tvGet(tv, TV_MESSAGE_AFTER_RNS, i, NULL);
+    v_poly_ntt[i] = tvGet(tv, TV_V_POLY_NTT, i, NULL);
+    e1_poly_ntt[i] = tvGet(tv, TV_E1_POLY_NTT, i, NULL);
+    pk0[i] = tvGet(tv, TV_PK0, i, NULL);
+    pk1[i] = tvGet(tv, TV_PK1, i, NULL);
+    expected_c0[i] = tvGet(tv, TV_EXPECTED_C0, i, NULL);
+    expected_c1[i] = tvGet(tv, TV_EXPECTED_C1, i, NULL);
+    result_c0[i] = dmaPolyAlloc(current_n);
+    result_c1[i] = dmaPolyAlloc(current_n);
+    num_result_polys = i + 1;
+    result_n = current_n;
+    if(!result_c0[i] || !result_c1[i])
+    {
+      printf("DMA pool exhausted by the results of %u moduli\n", (unsigned)num_moduli);
+      freeResults();
+      return 0;
+    }
+    complete &= message_after_rns[i] && v_poly_ntt[i] && e1_poly_ntt[i] && pk0[i] && pk1[i] && expected_c0[i] && expected_c1[i];
+  }
+
+  c0_to_decrypt = tvGet(tv, TV_C0_TO_DECRYPT, 0, NULL);
+  c1_to_decrypt = tvGet(tv, TV_C1_TO_DECRYPT, 0, NULL);
+  sk = tvGet(tv, TV_SK, 0, NULL);
+  decrypted_m_ntt = tvGet(tv, TV_DECRYPTED_M_NTT, 0, NULL);
+  intt_m_reference = tvGet(tv, TV_INTT_M_REFERENCE, 0, NULL);
+  ifft_input = tvGet(tv, TV_IFFT_INPUT, 0, NULL);
+  ifft_reference = tvGet(tv, TV_IFFT_REFERENCE, 0, NULL);
+  projected_reference = tvGet(tv, TV_PROJECTED_REFERENCE, 0, NULL);
+  complete &= c0_to_decrypt && c1_to_decrypt && sk && decrypted_m_ntt && intt_m_reference;
+  complete &= ifft_input && ifft_reference && projected_reference;
+
+  if(!complete)
+    printf("Test vector container is incomplete\n");
+  return complete;
+}
+#else
+static char loadTestVectors()
+{
+  return 1;
+}
+#endif
+
 char testAloha()
 {
   char error = 0;
 
   int poly_size = 1<<(13+current_n);
-	uint64_t result_fft[2*poly_size] ALIGN;
-	uint64_t result[poly_size];
+	uint64_t* result_fft = dmaPoolAlloc(2*poly_size);
+	uint64_t* result = dmaPolyAlloc(current_n);
+	uint64_t* result1 = dmaPolyAlloc(current_n);
 	int64_t rns_delta_max = 1;
 	const double eps_fft = pow(2,-25);
 
@@ -70,7 +184,6 @@ char testAloha()
 	fft_HW(result_fft, NULL, 1, 0, error_polys_seed, current_n);
 
   // check FFT result and error sampling result:
-  uint64_t result1[poly_size];
   error |= checkPolyFFT(result_fft, fft_expected,poly_size,1,"fft result", eps_fft, scale);
   recvErrorPolys_HW(result, result_fft, result1, current_n);
   error |= checkPoly(result, v_poly,poly_size,"v result", 0, 0);
@@ -100,7 +213,7 @@ char testAloha()
     error |= checkPoly(result, e1_poly_ntt[modulus_index],poly_size,"e1_poly_ntt",modulus_index, 0);
 		
 		// check generated pk1:
-    receive64(result, poly_size, FFT_IM_BRAM_ID);
+    receive64DMA(result, poly_size, FFT_IM_BRAM_ID);
     error |= checkPoly(result, pk1[modulus_index],poly_size,"sampled pk1",modulus_index, 0);
 
 		// perform point-wise multiplication
@@ -132,11 +245,11 @@ char testAloha()
 	cdmaWaitForIdle();
 
   // check whether sending ciphertexts and secret key works:
-  receive64(result,poly_size,NTT_MSG_BRAM_ID);
+  receive64DMA(result,poly_size,NTT_MSG_BRAM_ID);
   error |= checkPoly(result, c0_to_decrypt, poly_size, "sent c0", 0, 0);
-  receive64(result,poly_size,NTT_KEY_BRAM_ID);
+  receive64DMA(result,poly_size,NTT_KEY_BRAM_ID);
   error |= checkPoly(result, c1_to_decrypt, poly_size, "sent c1", 0, 0);
-  receive64(result,poly_size,NTT_V_BRAM_ID);
+  receive64DMA(result,poly_size,NTT_V_BRAM_ID);
   error |= checkPoly(result, sk, poly_size, "sent sk", 0, 0);
 
   // perform point-wise multiplication and check result:
@@ -165,6 +278,9 @@ char testAloha()
 
   printf("Testing Decryption Done\n");
 
+  dmaPoolFree(result_fft, 2*poly_size);
+  dmaPolyFree(result, current_n);
+  dmaPolyFree(result1, current_n);
   return error;
 }
 
@@ -172,7 +288,7 @@ void fastAloha()
 {
   XTime tStart = 0, tEnd = 0;
 	int poly_size = 1<<(13+current_n);
-	uint64_t result_fft[2*poly_size] ALIGN;
+	uint64_t* result_fft = dmaPolyAlloc(current_n);
 
 	// initialize the accelerator:
   ckks_init(current_n);
@@ -188,12 +304,16 @@ void fastAloha()
 	ckks_decrypt(c0_to_decrypt, c1_to_decrypt, sk, result_fft, poly_size, qm[0], current_k[0], constants_select[0], -scale);
 	XTime_GetTime(&tEnd);
   printf("Decode+decrypt in hardware took %llu CPU cc -> %.0lf us\n",2*(tEnd-tStart), 2.0*(tEnd-tStart)/CPU_FREQ_MHZ);
+  dmaPolyFree(result_fft, current_n);
 }
 
 void test_hardware(){
 	XTime tStart = 0, tEnd = 0;
 	char error = 0;
 
+	if(!loadTestVectors())
+		return;
+
 	XTime_GetTime(&tStart);
 
 #if defined(TEST_ALOHA)
@@ -221,6 +341,9 @@ void test_hardware(){
 
 void demo()
 {
+  if(!loadTestVectors())
+    return;
+
   int poly_size = 1<<(13+current_n);
   ckks_init(current_n);
 
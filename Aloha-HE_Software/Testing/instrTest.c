@@ -3,6 +3,7 @@
 #include "xil_cache.h"
 #include "../communication.h"
 #include "../instruction.h"
+#include "../dmaPool.h"
 
 
 uint32_t fft_HW(uint64_t *result, uint64_t *input, uint32_t do_forw_transf, int skip, uint64_t seed, uint8_t current_n)
@@ -58,13 +59,13 @@ uint32_t rns_HW(uint64_t *result_message, uint64_t* result_v, uint64_t* result_e
 	}
 
 	if(result_message){
-		receive64(result_message, poly_degree, NTT_MSG_BRAM_ID);
+		receive64DMA(result_message, poly_degree, NTT_MSG_BRAM_ID);
 	}
 	if(result_v){
-		receive64(result_v, poly_degree, NTT_V_BRAM_ID);
+		receive64DMA(result_v, poly_degree, NTT_V_BRAM_ID);
 	}
 	if(result_e1){
-		receive64(result_e1, poly_degree, NTT_E1_BRAM_ID);
+		receive64DMA(result_e1, poly_degree, NTT_E1_BRAM_ID);
 	}
 
 	return fpga_cycle_count;
@@ -91,7 +92,7 @@ uint32_t ntt_HW(uint64_t *result, uint64_t *input, uint32_t qm, uint32_t current
 	}
 
 	if(result){
-		receive64(result, poly_degree, bram_sel);
+		receive64DMA(result, poly_degree, bram_sel);
 	}
 
 	return fpga_cycle_count;
@@ -153,10 +154,10 @@ uint32_t pwm_HW(uint64_t *result_c0_m, uint64_t *result_c1, uint64_t *v_sk_poly,
 	fpga_cycle_count = exeIns();
 
 	if(result_c1){
-		receive64(result_c1, poly_degree, NTT_KEY_BRAM_ID);
+		receive64DMA(result_c1, poly_degree, NTT_KEY_BRAM_ID);
 	}
 	if(result_c0_m){
-		receive64(result_c0_m, poly_degree, NTT_MSG_BRAM_ID);
+		receive64DMA(result_c0_m, poly_degree, NTT_MSG_BRAM_ID);
 	}
 
 	return fpga_cycle_count;
@@ -185,6 +186,24 @@ uint32_t prj_HW(uint64_t* result, uint64_t* input, uint8_t current_n)
 	return fpga_cycle_count;
 }
 
+uint32_t aut_HW(uint64_t* result, uint64_t* input, uint32_t galois, uint32_t ntt_domain, uint32_t qm, uint32_t current_k, uint8_t current_n)
+{
+	uint32_t poly_degree = 1<<(13+current_n);
+
+	uint64_t INS[INS_BUFFER_SIZE];
+	uint64_t instr = getAutomorphismInstructionWord(galois, ntt_domain, current_k, qm, current_n);
+	initInsBuffer(INS, &instr, 1);
+	if(input)
+		send64(input, poly_degree, 0, NTT_MSG_BRAM_ID);
+
+	send64(INS, INS_BUFFER_SIZE, 1, 0);
+	uint32_t fpga_cycle_count = exeIns();
+
+	if(result)
+		receive64DMA(result, poly_degree, NTT_KEY_BRAM_ID);
+	return fpga_cycle_count;
+}
+
 void getMessageAfterRns(int poly_size, uint64_t* e0_poly, uint64_t** message_after_rns, uint64_t num_moduli, uint32_t* current_k, uint32_t* qm)
 {
 	static char already_done = 0;
@@ -215,9 +234,9 @@ void getMessageAfterRns(int poly_size, uint64_t* e0_poly, uint64_t** message_aft
 void recvErrorPolys_HW(uint64_t *v, uint64_t *e0, uint64_t* e1, uint8_t current_n)
 {
 	uint32_t poly_degree = 1<<(13+current_n);
-	uint64_t combined[poly_degree];
+	uint64_t* combined = dmaPolyAlloc(current_n);
 
-	receive64(combined, poly_degree, ERROR_BRAM_ID);
+	receive64DMA(combined, poly_degree, ERROR_BRAM_ID);
 
 	for (uint32_t i = 0; i < poly_degree; ++i)
 	{
@@ -225,5 +244,6 @@ void recvErrorPolys_HW(uint64_t *v, uint64_t *e0, uint64_t* e1, uint8_t current_
 		e0[i] = (combined[i] >> 6) & 0x3f;
 		e1[i] = (combined[i]) & 0x3f;
 	}
+	dmaPolyFree(combined, current_n);
 }
 
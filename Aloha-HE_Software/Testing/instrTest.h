@@ -9,6 +9,7 @@ uint32_t ntt_HW(uint64_t *result, uint64_t *input, uint32_t qm, uint32_t current
 uint32_t i2f_HW(uint64_t *result, uint64_t *input, uint32_t qm, uint32_t current_k, int32_t scale, uint8_t current_n);
 uint32_t pwm_HW(uint64_t *result_c0_m, uint64_t *result_c1, uint64_t *v_sk_poly, uint64_t *pk0_c1_poly, uint64_t *pk1_poly, uint64_t *msg_c0_poly, uint64_t *e1_poly, uint32_t qm, uint32_t current_k, uint8_t current_n);
 uint32_t prj_HW(uint64_t* result, uint64_t* input, uint8_t current_n);
+uint32_t aut_HW(uint64_t* result, uint64_t* input, uint32_t galois, uint32_t ntt_domain, uint32_t qm, uint32_t current_k, uint8_t current_n);
 
 void getMessageAfterRns(int poly_size, uint64_t* e0_poly, uint64_t** message_after_rns, uint64_t num_moduli, uint32_t* current_k, uint32_t* qm);
 void recvErrorPolys_HW(uint64_t *v, uint64_t *e0, uint64_t* e1, uint8_t current_n);
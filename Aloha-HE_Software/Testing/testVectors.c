@@ -0,0 +1,100 @@
+/****************************************
+ * Binary Test-Vector Container
+ *
+ * Accessors for the test-vector container
+ * defined in testVectors.h. On the board,
+ * the container is loaded to DDR (e.g. with
+ * xsdb "dow -data") and its payloads are
+ * DMA'd to the BRAMs in place. On Linux,
+ * the container is mmapped.
+ ***************************************/
+
+#include "testVectors.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Validates the container at base and returns its header or NULL if the
+// container is malformed. Pass size = 0 if the size is unknown (board).
+const TvHeader* tvOpen(const void* base, size_t size)
+{
+	const TvHeader* tv = (const TvHeader*)base;
+	const TvEntry* entries = (const TvEntry*)(tv + 1);
+
+	if(!base || (size && size < sizeof(TvHeader)))
+		return NULL;
+	if(tv->magic != TV_MAGIC || tv->version != TV_VERSION)
+		return NULL;
+	if(tv->log_n < 13 || tv->log_n > 15 || tv->num_moduli > TV_MAX_MODULI)
+		return NULL;
+	if(size && size < sizeof(TvHeader) + tv->num_entries*sizeof(TvEntry))
+		return NULL;
+
+	for(uint32_t i = 0; i < tv->num_entries; ++i)
+	{
+		if(entries[i].offset % TV_ALIGNMENT)
+			return NULL;
+		if(size && entries[i].offset + entries[i].num_words*sizeof(uint64_t) > size)
+			return NULL;
+	}
+	return tv;
+}
+
+// Returns a pointer to the payload of the entry (id, modulus) or NULL if the
+// container does not have this entry. The number of words is stored at
+// *num_words if num_words is not NULL.
+uint64_t* tvGet(const TvHeader* tv, uint32_t id, uint32_t modulus, uint64_t* num_words)
+{
+	const TvEntry* entries = (const TvEntry*)(tv + 1);
+
+	for(uint32_t i = 0; i < tv->num_entries; ++i)
+	{
+		if(entries[i].id == id && entries[i].modulus == modulus)
+		{
+			if(num_words)
+				*num_words = entries[i].num_words;
+			return (uint64_t*)((uint8_t*)tv + entries[i].offset);
+		}
+	}
+	return NULL;
+}
+
+#ifdef __linux__
+// Maps the container file at path into memory. The mapping is private and
+// writable, so tests may modify payloads in place without changing the file.
+const TvHeader* tvMap(const char* path, size_t* size)
+{
+	struct stat st;
+	void* base;
+	int fd = open(path, O_RDONLY);
+
+	if(fd < 0)
+		return NULL;
+	if(fstat(fd, &st) < 0)
+	{
+		close(fd);
+		return NULL;
+	}
+	base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED)
+		return NULL;
+
+	*size = st.st_size;
+	if(!tvOpen(base, *size))
+	{
+		munmap(base, *size);
+		return NULL;
+	}
+	return (const TvHeader*)base;
+}
+
+void tvUnmap(const TvHeader* tv, size_t size)
+{
+	munmap((void*)tv, size);
+}
+#endif
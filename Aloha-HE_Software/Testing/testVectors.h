@@ -0,0 +1,82 @@
+#ifndef SRC_TESTING_TESTVECTORS_H_
+#define SRC_TESTING_TESTVECTORS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Binary test-vector container.
+// Layout (little endian):
+//   TvHeader
+//   TvEntry[num_entries]
+//   payloads, each starting at a multiple of TV_ALIGNMENT
+// Payloads are arrays of 64-bit words that are used in place, i.e., they are
+// passed directly to the DMA on the board or mmapped on Linux.
+// The layout has no implicit padding, so it is identical for all targets.
+#define TV_MAGIC       0x56544841 // "AHTV"
+#define TV_VERSION     1
+#define TV_MAX_MODULI  16
+#define TV_ALIGNMENT   4096
+
+// Entry IDs. Entries marked "per modulus" exist once for each modulus
+// (TvEntry.modulus), all others have TvEntry.modulus = 0.
+enum TvId
+{
+	// encode+encrypt:
+	TV_INPUT = 0,           // message, interleaved re/im doubles (N words)
+	TV_EXPANDED_INPUT,      // message after expand (2N words)
+	TV_FFT_EXPECTED,        // result of the forward FFT (2N words)
+	TV_V_POLY,              // sampled v (N words)
+	TV_E0_POLY,             // sampled e0 (N words)
+	TV_E1_POLY,             // sampled e1 (N words)
+	TV_MESSAGE_AFTER_RNS,   // per modulus: RNS result without e0 (N words)
+	TV_V_POLY_NTT,          // per modulus: NTT of v (N words)
+	TV_E1_POLY_NTT,         // per modulus: NTT of e1 (N words)
+	TV_PK0,                 // per modulus: public key pk0 (N words)
+	TV_PK1,                 // per modulus: public key pk1 sampled from pk1_seeds (N words)
+	TV_EXPECTED_C0,         // per modulus: ciphertext c0 (N words)
+	TV_EXPECTED_C1,         // per modulus: ciphertext c1 (N words)
+	// decrypt+decode (first modulus only):
+	TV_C0_TO_DECRYPT,       // ciphertext c0 (N words)
+	TV_C1_TO_DECRYPT,       // ciphertext c1 (N words)
+	TV_SK,                  // secret key in NTT domain (N words)
+	TV_DECRYPTED_M_NTT,     // result of PWM (N words)
+	TV_INTT_M_REFERENCE,    // result of the inverse NTT (N words)
+	TV_IFFT_INPUT,          // result of I2F (2N words)
+	TV_IFFT_REFERENCE,      // result of the inverse FFT (2N words)
+	TV_PROJECTED_REFERENCE, // result of the projection (N words)
+	TV_NUM_IDS
+};
+
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint8_t  log_n;              // 13, 14 or 15
+	uint8_t  num_moduli;
+	int32_t  log_scale;
+	uint32_t num_entries;
+	uint64_t error_polys_seed;
+	uint64_t pk1_seeds[TV_MAX_MODULI];
+	uint32_t log_q[TV_MAX_MODULI];         // q = 2^(log_q+46) - (qm << 24) + 1
+	uint32_t qm[TV_MAX_MODULI];
+	uint32_t ntt_rom_index[TV_MAX_MODULI]; // constants_select of the NTT
+	uint32_t rns_rom_index[TV_MAX_MODULI]; // modulus_select of the RNS
+} TvHeader;
+
+typedef struct
+{
+	uint32_t id;
+	uint32_t modulus;
+	uint64_t offset;    // byte offset of the payload from the start of the container
+	uint64_t num_words; // number of 64-bit words of the payload
+} TvEntry;
+
+const TvHeader* tvOpen(const void* base, size_t size);
+uint64_t* tvGet(const TvHeader* tv, uint32_t id, uint32_t modulus, uint64_t* num_words);
+
+#ifdef __linux__
+const TvHeader* tvMap(const char* path, size_t* size);
+void tvUnmap(const TvHeader* tv, size_t size);
+#endif
+
+#endif /* SRC_TESTING_TESTVECTORS_H_ */
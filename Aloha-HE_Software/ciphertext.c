@@ -0,0 +1,130 @@
+/****************************************
+ * Contiguous Ciphertext
+ *
+ * Accessors for the ciphertext object
+ * defined in ciphertext.h. The object is
+ * written by the DMA (ckks_encrypt_ct) and
+ * read by the DMA (ckks_decrypt_ct) in
+ * place. On Linux, it is sent to and
+ * received from a file or socket without
+ * repacking.
+ ***************************************/
+
+#include "ciphertext.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+static uint32_t headerBytes(uint8_t num_moduli)
+{
+	size_t bytes = sizeof(CtHeader) + num_moduli*sizeof(uint32_t);
+	return (uint32_t)((bytes + CT_ALIGNMENT - 1) / CT_ALIGNMENT * CT_ALIGNMENT);
+}
+
+// Returns the bytes of a ciphertext with num_moduli residues of 2^log_n words.
+size_t ctBytes(uint8_t log_n, uint8_t num_moduli)
+{
+	return headerBytes(num_moduli) + (2*(size_t)num_moduli*sizeof(uint64_t) << log_n);
+}
+
+// Writes the header of a ciphertext to base, which must hold ctBytes(log_n,
+// num_moduli) bytes. The residues are left as they are.
+CtHeader* ctInit(void* base, uint8_t log_n, uint8_t num_moduli, const uint32_t* qm, const uint32_t* log_q,
+				 int32_t log_scale)
+{
+	CtHeader* ct = (CtHeader*)base;
+
+	ct->magic = CT_MAGIC;
+	ct->version = CT_VERSION;
+	ct->log_n = log_n;
+	ct->num_moduli = num_moduli;
+	ct->log_scale = log_scale;
+	ct->header_bytes = headerBytes(num_moduli);
+	for(uint32_t i = 0; i < num_moduli; ++i)
+		ct->moduli[i] = (qm[i] & 0xffffff) | (log_q[i] << 24);
+	return ct;
+}
+
+// Validates the ciphertext at base and returns its header or NULL if the
+// ciphertext is malformed. Pass size = 0 if the size is unknown.
+const CtHeader* ctOpen(const void* base, size_t size)
+{
+	const CtHeader* ct = (const CtHeader*)base;
+
+	if(!base || (size && size < sizeof(CtHeader)))
+		return NULL;
+	if(ct->magic != CT_MAGIC || ct->version != CT_VERSION)
+		return NULL;
+	if(ct->log_n < 13 || ct->log_n > 15 || !ct->num_moduli)
+		return NULL;
+	if(ct->header_bytes != headerBytes(ct->num_moduli))
+		return NULL;
+	if(size && size < ctBytes(ct->log_n, ct->num_moduli))
+		return NULL;
+	return ct;
+}
+
+// Returns the c0 residue of the given modulus (2^log_n words).
+uint64_t* ctC0(const CtHeader* ct, uint32_t modulus)
+{
+	return (uint64_t*)((uint8_t*)ct + ct->header_bytes) + ((size_t)modulus << ct->log_n);
+}
+
+// Returns the c1 residue of the given modulus (2^log_n words).
+uint64_t* ctC1(const CtHeader* ct, uint32_t modulus)
+{
+	return ctC0(ct, ct->num_moduli + modulus);
+}
+
+#ifdef __linux__
+// Writes the whole ciphertext to the file or socket fd.
+// Returns 0 on failure.
+int ctWrite(const CtHeader* ct, int fd)
+{
+	const uint8_t* p = (const uint8_t*)ct;
+	size_t left = ctBytes(ct->log_n, ct->num_moduli);
+
+	while(left)
+	{
+		ssize_t n = write(fd, p, left);
+		if(n <= 0)
+			return 0;
+		p += n;
+		left -= n;
+	}
+	return 1;
+}
+
+// Reads exactly num_bytes from fd to p. Returns 0 on failure.
+static int readAll(int fd, uint8_t* p, size_t num_bytes)
+{
+	while(num_bytes)
+	{
+		ssize_t n = read(fd, p, num_bytes);
+		if(n <= 0)
+			return 0;
+		p += n;
+		num_bytes -= n;
+	}
+	return 1;
+}
+
+// Reads a ciphertext of ctWrite from the file or socket fd into buffer of
+// capacity bytes (e.g., a DMA buffer, so the residues are DMA'd from there).
+// Returns the header or NULL if the ciphertext is malformed or too large.
+const CtHeader* ctRead(int fd, void* buffer, size_t capacity)
+{
+	const CtHeader* ct = (const CtHeader*)buffer;
+	size_t num_bytes;
+
+	if(capacity < sizeof(CtHeader) || !readAll(fd, buffer, sizeof(CtHeader)))
+		return NULL;
+	if(ct->magic != CT_MAGIC || ct->log_n < 13 || ct->log_n > 15)
+		return NULL;
+	num_bytes = ctBytes(ct->log_n, ct->num_moduli);
+	if(num_bytes > capacity || !readAll(fd, (uint8_t*)buffer + sizeof(CtHeader), num_bytes - sizeof(CtHeader)))
+		return NULL;
+	return ctOpen(buffer, num_bytes);
+}
+#endif
@@ -0,0 +1,46 @@
+#ifndef SRC_CIPHERTEXT_H_
+#define SRC_CIPHERTEXT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Contiguous ciphertext.
+// Layout (little endian):
+//   CtHeader with num_moduli entries of moduli[], padded to header_bytes
+//   c0 residues of all moduli, N words each
+//   c1 residues of all moduli, N words each
+// ckks_encrypt_ct lets the DMA write every residue to its place, so the
+// object is sent to a socket or file as it is (ctWrite) and the residues
+// are DMA'd in place for the decryption (ctOpen/ctRead, ckks_decrypt_ct).
+// The layout has no implicit padding, so it is identical for all targets.
+#define CT_MAGIC       0x54434841 // "AHCT"
+#define CT_VERSION     1
+#define CT_ALIGNMENT   64         // of the residues (a multiple of the cache line)
+
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint8_t  log_n;              // 13, 14 or 15
+	uint8_t  num_moduli;
+	int32_t  log_scale;
+	uint32_t header_bytes;       // byte offset of the first c0 residue
+	uint32_t moduli[];           // qm | log_q << 24, q = 2^(log_q+46) - (qm << 24) + 1
+} CtHeader;
+
+#define CT_QM(ct, i)     ((ct)->moduli[i] & 0xffffff)
+#define CT_LOG_Q(ct, i)  ((ct)->moduli[i] >> 24)
+
+size_t ctBytes(uint8_t log_n, uint8_t num_moduli);
+CtHeader* ctInit(void* base, uint8_t log_n, uint8_t num_moduli, const uint32_t* qm, const uint32_t* log_q,
+				 int32_t log_scale);
+const CtHeader* ctOpen(const void* base, size_t size);
+uint64_t* ctC0(const CtHeader* ct, uint32_t modulus);
+uint64_t* ctC1(const CtHeader* ct, uint32_t modulus);
+
+#ifdef __linux__
+int ctWrite(const CtHeader* ct, int fd);
+const CtHeader* ctRead(int fd, void* buffer, size_t capacity);
+#endif
+
+#endif /* SRC_CIPHERTEXT_H_ */
@@ -11,16 +11,110 @@
 #include "ckksAccelerator.h"
 #include "communication.h"
 #include "instruction.h"
+#include "dmaPool.h"
+#include "fourStep.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 // Instruction buffers. They are partially set up during ckks_init() and
 // contain the instruction buffer data for encode, encrypt and decrypt.
 uint64_t instructions_decrypt[INS_BUFFER_SIZE]; // instruction buffer for decrypt+decode
 uint64_t instructions_encode[INS_BUFFER_SIZE];  // instruction buffer for encode
 uint64_t instructions_encrypt[INS_BUFFER_SIZE]; // instruction buffer for encrypt
+uint64_t instructions_pwm[INS_BUFFER_SIZE];     // instruction buffer for the PWMs of the key generation
+uint64_t instructions_automorphism[INS_BUFFER_SIZE]; // instruction buffer for the automorphism
+uint64_t instructions_ntt[INS_BUFFER_SIZE];     // instruction buffer for the tiles of the four-step NTT
 
 uint8_t configured_current_n = -1;
+uint8_t configured_sparse_shift = 0; // plaintexts have N>>configured_sparse_shift words (doubles)
+
+// pk0 cache: the key BRAM holds 2^(15+KEY_STORE_LOG_POLYS)/N regions of N
+// coefficients. Region 0 is used by the PWM, cache entry i is region i+1.
+#define PK0_CACHE_MAX_ENTRIES ((1<<(KEY_STORE_LOG_POLYS+2))-1)
+typedef struct
+{
+	uint32_t key_id;
+	uint32_t qm;
+	uint32_t log_q;
+	uint32_t last_use; // for LRU replacement
+	uint8_t valid;
+	const uint64_t* pinned; // residue of ckks_load_resident_pk0, never replaced
+} Pk0CacheEntry;
+static Pk0CacheEntry pk0_cache[PK0_CACHE_MAX_ENTRIES];
+static uint32_t pk0_cache_entries;              // usable entries for the configured N
+static uint32_t pk0_cache_key_id = PK0_CACHE_NO_KEY;
+static uint32_t pk0_cache_clock;
+static uint64_t pk0_cache_hits, pk0_cache_misses, pk0_cache_bytes_saved;
+
+// Constant slots of the forward and inverse NTT for each NTT constants index of
+// ckks_encrypt/ckks_decrypt (see ckks_set_ntt_slots). The defaults match
+// TwFctrCache_RNSConsts.mem and the original ROM index mapping: index 15 uses
+// slots 16/17, all other indices (including 16 and 17) use their own slot for
+// the forward and slot 15 for the inverse NTT.
+static uint8_t ntt_slots[NTT_CONSTANT_SLOTS][2] = {
+	{0, 15}, {1, 15}, {2, 15}, {3, 15}, {4, 15}, {5, 15}, {6, 15}, {7, 15}, {8, 15},
+	{9, 15}, {10, 15}, {11, 15}, {12, 15}, {13, 15}, {14, 15}, {16, 17}, {16, 15}, {17, 15}
+};
+
+// Constant 0 of each NTT constants slot, i.e., the root of unity of the slot
+// times R mod q (see Aloha-HE_Host/genConstants.c). The defaults are the ones
+// of TwFctrCache_RNSConsts.mem, ckks_load_constants and the streamed constants
+// update them. ckks_ntt_four_step checks its root against them.
+static uint64_t ntt_root_constants[NTT_CONSTANT_SLOTS] = {
+	0x20bf83ad17ceull, 0x2d2004f226b9ull, 0x19263bcdb09bull, 0x295bf43181ecull, 0x9542c6992a09ull,
+	0x25c254fe26ull, 0xcc67f137bb5ull, 0x1631c512d8db8ull, 0xf997fa7c4aa0ull, 0x2db1770231be1ull,
+	0x1bfdf0afe75d4ull, 0xdeefd031a8b21ull, 0x91a7f7bb492e5ull, 0x53b14fdd25efdull, 0x19796cf5d53aa3ull,
+	0x384ebcb4d071c2ull, 0x5e8777fa70b4ull, 0xf9503536bf185ull
+};
+
+// Each line of the constants cache holds two constants of CONSTANT_BITS bits,
+// e.g., the same constant of the two NTT slots of a pair.
+#define CONSTANT_BITS 54
+
+// Returns constant half (0 or 1) of a line given as two words
+static uint64_t lineConstant(const uint64_t* line, uint32_t half)
+{
+	uint64_t mask = (1ull << CONSTANT_BITS) - 1;
+	return half ? (line[0] >> CONSTANT_BITS | line[1] << (64 - CONSTANT_BITS)) & mask : line[0] & mask;
+}
+
+// Updates ntt_root_constants with the lines first_line.. of the constants cache
+static void updateRootConstants(const uint64_t* lines, uint32_t first_line, uint32_t num_lines)
+{
+	for(uint32_t slot = 0; slot < NTT_CONSTANT_SLOTS; ++slot)
+	{
+		uint32_t line = NTT_CONSTANTS_BASE + slot/2*NTT_CONSTANT_LINES;
+		if(line >= first_line && line - first_line < num_lines)
+			ntt_root_constants[slot] = lineConstant(lines + 2*(line - first_line), slot & 1);
+	}
+}
+
+// Streamed constants (see ckks_stream_constants): the slots of index 15 are
+// overwritten with the constants of each modulus before its use.
+#define STREAM_RNS_SLOT 15
+#define STREAM_NTT_SLOT 16 // forward, STREAM_NTT_SLOT+1 inverse
+
+static const uint64_t* stream_blocks;
+
+// Returns 1 if the num NTT constants indices are in the range of ntt_slots.
+// The indices are ignored with streamed constants.
+static int validNttIndices(const uint32_t* ntt_indices, uint32_t num)
+{
+	if(stream_blocks)
+		return 1;
+	for(uint32_t i = 0; i < num; ++i)
+		if(ntt_indices[i] >= NTT_CONSTANT_SLOTS)
+			return 0;
+	return 1;
+}
+
+// Switch this to run NTT and PWM of the encryption as one fused instruction (1)
+// or as two separate instructions (0), e.g., to compare the cycle counts.
+#define FUSE_NTT_PWM 1
+// Switch this to run INTT+I2F and IFFT+Project of the decryption as fused instructions (1)
+// or as four separate instructions (0).
+#define FUSE_DECODE 1
 
 // Initializes the instruction buffers.
 // Instruction buffers contain constant data. E.g.: the FFT instruction word in encrypt
@@ -29,12 +123,191 @@ void ckks_init(uint8_t current_n)
 {
 	configured_current_n = current_n;
 	uint64_t dummy[16] = { 0 };
+#if FUSE_DECODE
+	initInsBuffer(instructions_decrypt, dummy, 3);
+	instructions_decrypt[3] = getIFFTProjectInstructionWord(current_n);
+#else
 	initInsBuffer(instructions_decrypt, dummy, 5);
 	instructions_decrypt[4] = getFFTTransformationInstructionWord(0, current_n);
 	instructions_decrypt[5] = getProjectInstructionWord(current_n);
+#endif
 	initInsBuffer(instructions_encode, dummy, 1);
 	instructions_encode[1] = getFFTTransformationInstructionWord(1, current_n);
-	initInsBuffer(instructions_encrypt, dummy, 3);
+	initInsBuffer(instructions_encrypt, dummy, FUSE_NTT_PWM ? 2 : 3);
+	initInsBuffer(instructions_pwm, dummy, 1);
+	initInsBuffer(instructions_automorphism, dummy, 1);
+	initInsBuffer(instructions_ntt, dummy, 1);
+	ckks_set_slots(1u << (12+current_n));
+	pk0_cache_entries = (1u << (KEY_STORE_LOG_POLYS+2-current_n)) - 1;
+	ckks_pk0_cache_invalidate(PK0_CACHE_ALL);
+	setPk0Region(0);
+	// the staging buffer of the instruction uploads is set up here, not on the hot path
+	dmaStagingBuffer();
+}
+
+// Overwrites num_lines lines of the constants cache (twiddle factor cache and
+// RNS constants), starting at first_line, e.g., with the output of
+// Aloha-HE_Host/genConstants.c. lines holds two words per line and must be
+// in DDR. The new moduli can be used right after this call.
+void ckks_load_constants(const uint64_t* lines, uint32_t first_line, uint32_t num_lines)
+{
+	if(first_line >= CONSTANTS_CACHE_LINES || num_lines > CONSTANTS_CACHE_LINES - first_line)
+		return;
+	cdmaDDRtoConstants((size_t)lines, first_line, num_lines);
+	updateRootConstants(lines, first_line, num_lines);
+}
+
+// Maps the NTT constants index of ckks_encrypt/ckks_decrypt to the constant
+// slots of the forward and the inverse NTT. Returns 0 if a value is out of range.
+int ckks_set_ntt_slots(uint8_t ntt_index, uint8_t forward_slot, uint8_t inverse_slot)
+{
+	if(ntt_index >= NTT_CONSTANT_SLOTS || forward_slot >= NTT_CONSTANT_SLOTS || inverse_slot >= NTT_CONSTANT_SLOTS)
+		return 0;
+	ntt_slots[ntt_index][0] = forward_slot;
+	ntt_slots[ntt_index][1] = inverse_slot;
+	return 1;
+}
+
+// Streams the constants of each modulus into the constants cache before it is
+// used, instead of selecting them with the ROM indices. Then ckks_encrypt
+// takes any number of moduli: modulus i of ckks_encrypt uses block i and
+// ckks_decrypt block 0. A block has CKKS_STREAM_BLOCK_WORDS words (see
+// genConstants -s) and must be in DDR. This costs two DMAs with 1392 bytes per
+// modulus and overwrites RNS slot 15 and NTT slots 16/17, i.e., ROM index 15
+// (and 16) refers to the last streamed modulus afterwards.
+// NULL returns to the ROM indices.
+void ckks_stream_constants(const uint64_t* blocks)
+{
+	stream_blocks = blocks;
+}
+
+// Loads block i of the streamed constants. The CDMA must be idle.
+static void loadStreamedConstants(uint32_t i)
+{
+	const uint64_t* block = stream_blocks + i*CKKS_STREAM_BLOCK_WORDS;
+	cdmaDDRtoConstants((size_t)block, STREAM_RNS_SLOT*RNS_CONSTANT_LINES, RNS_CONSTANT_LINES);
+	cdmaDDRtoConstants((size_t)(block + 2*RNS_CONSTANT_LINES), NTT_CONSTANTS_BASE + STREAM_NTT_SLOT/2*NTT_CONSTANT_LINES,
+					   NTT_CONSTANT_LINES);
+	updateRootConstants(block + 2*RNS_CONSTANT_LINES, NTT_CONSTANTS_BASE + STREAM_NTT_SLOT/2*NTT_CONSTANT_LINES,
+						NTT_CONSTANT_LINES);
+}
+
+// Selects the key of the pk0 residues of the following ckks_encrypt calls.
+// The residues are kept in the key BRAM, which saves their DMA as long as
+// they are resident. A residue is identified by key_id and its modulus
+// (qm, log_q), the least recently used one is replaced. The caller must
+// invalidate a key_id with ckks_pk0_cache_invalidate when its pk0 changes.
+// PK0_CACHE_NO_KEY transfers pk0 on every encryption (default).
+void ckks_pk0_cache_use(uint32_t key_id)
+{
+	pk0_cache_key_id = key_id;
+}
+
+// Drops all residues of key_id (PK0_CACHE_ALL: of all keys and the resident
+// residues of ckks_load_resident_pk0) from the cache.
+void ckks_pk0_cache_invalidate(uint32_t key_id)
+{
+	for(uint32_t i = 0; i < PK0_CACHE_MAX_ENTRIES; ++i)
+		if(key_id == PK0_CACHE_ALL || (!pk0_cache[i].pinned && pk0_cache[i].key_id == key_id))
+		{
+			pk0_cache[i].valid = 0;
+			pk0_cache[i].pinned = NULL;
+		}
+}
+
+// Keeps the pk0 residues of the first moduli resident in the key BRAM, e.g.,
+// of the only public key of a client. They are pinned entries of the pk0
+// cache: the residue pk0[i] is copied once to cache entry i, is identified by
+// its address and is never replaced. The following ckks_encrypt calls skip its
+// DMA whatever key ckks_pk0_cache_use selected, the remaining entries are
+// used by the LRU cache. The residues must not change while they are
+// resident. Call it with num_moduli = 0 to release them. Must be called after
+// ckks_init().
+// @param pk0: Array with num_moduli pointers, see ckks_encrypt.
+// @return the number of resident residues (with the default key BRAM at most
+//		   3 for N=2^13, 1 for N=2^14, 0 for N=2^15)
+uint8_t ckks_load_resident_pk0(uint64_t** pk0, uint8_t num_moduli)
+{
+	uint32_t poly_size = 1u << (13+configured_current_n);
+	uint8_t num_resident = num_moduli < pk0_cache_entries ? num_moduli : pk0_cache_entries;
+
+	for(uint32_t i = 0; i < pk0_cache_entries; ++i)
+		if(pk0_cache[i].pinned || i < num_resident)
+		{
+			pk0_cache[i].valid = 0;
+			pk0_cache[i].pinned = NULL;
+		}
+	for(uint8_t i = 0; i < num_resident; ++i)
+	{
+		cdmaDDRtoKeyRegion((size_t)pk0[i], poly_size*sizeof(uint64_t), i+1);
+		cdmaWaitForIdle();
+		pk0_cache[i] = (Pk0CacheEntry){PK0_CACHE_NO_KEY, 0, 0, 0, 1, pk0[i]};
+	}
+	return num_resident;
+}
+
+// Returns the cache statistics since the start: number of hits and misses
+// and the bytes of pk0 that did not have to be transferred from DDR.
+void ckks_pk0_cache_stats(uint64_t* hits, uint64_t* misses, uint64_t* bytes_saved)
+{
+	*hits = pk0_cache_hits;
+	*misses = pk0_cache_misses;
+	*bytes_saved = pk0_cache_bytes_saved;
+}
+
+// Returns the key BRAM region of the pk0 residue for the modulus (qm, log_q),
+// either resident (see ckks_load_resident_pk0) or of the selected key, which
+// is loaded on a miss. Returns 0 if the residue is not cached, then it must be
+// transferred to region 0.
+static uint32_t pk0CacheRegion(uint64_t* pk0, uint32_t qm, uint32_t log_q, uint32_t poly_size)
+{
+	uint32_t victim = PK0_CACHE_MAX_ENTRIES;
+
+	++pk0_cache_clock;
+	for(uint32_t i = 0; i < pk0_cache_entries; ++i)
+	{
+		Pk0CacheEntry* entry = &pk0_cache[i];
+		if(entry->valid && (entry->pinned ? entry->pinned == pk0 :
+			entry->key_id == pk0_cache_key_id && entry->qm == qm && entry->log_q == log_q))
+		{
+			entry->last_use = pk0_cache_clock;
+			++pk0_cache_hits;
+			pk0_cache_bytes_saved += poly_size*sizeof(uint64_t);
+			return i+1;
+		}
+		if(!entry->pinned && (victim == PK0_CACHE_MAX_ENTRIES ||
+			(pk0_cache[victim].valid && (!entry->valid || entry->last_use < pk0_cache[victim].last_use))))
+			victim = i;
+	}
+	if(pk0_cache_key_id == PK0_CACHE_NO_KEY || victim == PK0_CACHE_MAX_ENTRIES)
+		return 0;
+
+	++pk0_cache_misses;
+	cdmaDDRtoKeyRegion((size_t)pk0, poly_size*sizeof(uint64_t), victim+1);
+	pk0_cache[victim] = (Pk0CacheEntry){pk0_cache_key_id, qm, log_q, pk0_cache_clock, 1, NULL};
+	return victim+1;
+}
+
+// Selects the number of slots of the following encryptions and decryptions
+// (sparse packing). Supported are N/2, N/4 and N/8 slots, but not less than
+// 2^12, because the FFT supports 2^13 to 2^15 points. The message is
+// encoded with an FFT of 2*num_slots points and the coefficients are spread
+// to every N/(2*num_slots)-th position. This is the standard sparse packing,
+// i.e., the ciphertexts decrypt with any CKKS decoder using num_slots slots.
+// Shorter messages can be padded with zeros or repeated to num_slots values,
+// the latter equals the sparse packing with fewer slots.
+// Must be called after ckks_init(). Returns 0 on success and -1 if num_slots
+// is not supported.
+int ckks_set_slots(uint32_t num_slots)
+{
+	uint8_t sparse_shift = 0;
+	while(sparse_shift < 3 && (num_slots << sparse_shift) < (1u << (12+configured_current_n)))
+		sparse_shift++;
+	if((num_slots << sparse_shift) != (1u << (12+configured_current_n)) || sparse_shift > configured_current_n)
+		return -1;
+	configured_sparse_shift = sparse_shift;
+	setSparseShift(sparse_shift);
+	return 0;
 }
 
 // Performs a CKKS decryption+decoding with one left modulus.
@@ -45,33 +318,113 @@ void ckks_init(uint8_t current_n)
 //					 i.e.: x[0] = plaintext[0] + j*plaintext[1], ....,
 //						   x[poly_size/2-1] = plaintext[poly_size-2] + j*plaintext[poly_size-1]
 //					 Each of the uint64 elements of plaintext can directly be casted to double.
+//					 With a packed format (see setPlaintextFormat), plaintext has poly_size/2
+//					 words, each holding one complex value.
+//					 With sparse packing (see ckks_set_slots), poly_size is replaced by 2*num_slots.
 // @param poly_size: the polynomial degree. 2^13 in our case
 // @param qm: The 17-bit value of the modulus q = 2^(log_q[i]+46) - (qm << 24) + 1
 // @param log_q: Defines bit-width of modulus q.
 //				 A value of 0 corresponds to 46-bit modulus, 1 -> 47-bit, ..., 8 -> 54-bit modulus
 // @param ntt_modulus_rom_index: Offset of the NTT twiddle factors within the modulus ROM (Twiddle factor cache)
+//								 Ignored with streamed constants (see ckks_stream_constants).
+//								 Nothing is decrypted if it is not below NTT_CONSTANT_SLOTS.
 // @param log_scale: The log2 of the scale (Delta) each input operand is divided by
 void ckks_decrypt(uint64_t* c0, uint64_t* c1, uint64_t* sk, uint64_t* plaintext, uint32_t poly_size, uint32_t qm, uint8_t log_q,
 				  uint8_t ntt_modulus_rom_index, int32_t log_scale)
 {
+	uint32_t ntt_index = ntt_modulus_rom_index;
+	if(!validNttIndices(&ntt_index, 1))
+		return;
+	uint8_t ntt_constants = ntt_slots[stream_blocks ? 0 : ntt_index][1];
+	if(stream_blocks)
+	{
+		loadStreamedConstants(0);
+		ntt_constants = STREAM_NTT_SLOT + 1;
+	}
+
 	cdmaDDRtoBRAM(NTT_MSG_BRAM_ID, (size_t)c0, poly_size*sizeof(uint64_t),configured_current_n);
 	instructions_decrypt[1] = getPWMInstructionWord(log_q, qm, configured_current_n);
 	cdmaWaitForIdle();
 	cdmaDDRtoBRAM(NTT_KEY_BRAM_ID, (size_t)c1, poly_size*sizeof(uint64_t),configured_current_n);
-	instructions_decrypt[2] = getNTTTransformationInstructionWord(1,log_q, ntt_modulus_rom_index == 15 ? 17 : 15,qm, configured_current_n);
+#if FUSE_DECODE
+	instructions_decrypt[2] = getINTTI2FInstructionWord(log_scale, log_q, ntt_constants, qm, configured_current_n);
+	cdmaWaitForIdle();
+	cdmaDDRtoBRAM(NTT_V_BRAM_ID, (size_t)sk, poly_size*sizeof(uint64_t),configured_current_n);
+#else
+	instructions_decrypt[2] = getNTTTransformationInstructionWord(1,log_q, ntt_constants,qm, configured_current_n);
 	cdmaWaitForIdle();
 	cdmaDDRtoBRAM(NTT_V_BRAM_ID, (size_t)sk, poly_size*sizeof(uint64_t),configured_current_n);
 	instructions_decrypt[3] = getI2FInstructionWord(log_scale,log_q,qm, configured_current_n);
+#endif
 
-	send64(instructions_decrypt, INS_BUFFER_SIZE, 1, 0);
+	sendInstructions(instructions_decrypt, INS_BUFFER_SIZE);
 	cdmaWaitForIdle();
 
 	exeIns();
 
-	cdmaBRAMtoDDR((size_t)plaintext, FFT_BRAM_ID, poly_size*sizeof(uint64_t));
+	cdmaBRAMtoDDR((size_t)plaintext, FFT_BRAM_ID, plaintextBytes(poly_size >> configured_sparse_shift));
 	cdmaWaitForIdle();
 }
 
+// Decrypts modulus 0 of the contiguous ciphertext ct (e.g., of ctOpen or
+// ctRead) in place, with the scale of its header. All other parameters as in
+// ckks_decrypt.
+void ckks_decrypt_ct(const CtHeader* ct, uint64_t* sk, uint64_t* plaintext, uint8_t ntt_modulus_rom_index)
+{
+	ckks_decrypt(ctC0(ct, 0), ctC1(ct, 0), sk, plaintext, 1u << ct->log_n, CT_QM(ct, 0), CT_LOG_Q(ct, 0),
+				 ntt_modulus_rom_index, -ct->log_scale);
+}
+
+// Sends the plaintext and runs the encode program (expand and forward FFT),
+// which also samples v, e0 and e1 from error_polys_seed. Returns the
+// log_scale operand of the RNS instruction.
+static int32_t runEncode(uint64_t* plaintext, uint32_t poly_size, uint64_t error_polys_seed, int32_t log_scale)
+{
+	cdmaDDRtoBRAM(FFT_BRAM_ID, (size_t)plaintext, plaintextBytes(poly_size >> configured_sparse_shift), configured_current_n - configured_sparse_shift);
+
+	log_scale = log_scale - 52 - 1023 - (13+configured_current_n-configured_sparse_shift); // -13 for scaling factor of 1/N of the FFT size
+	if(log_scale < 0)
+		log_scale += 4096;
+
+	sendInstructions(instructions_encode, INS_BUFFER_SIZE);
+	cdmaWaitForIdle();
+
+	exeInsWithParameter(error_polys_seed);
+	return log_scale;
+}
+
+// Returns the NTT and RNS constants of modulus i, either from the ROM indices
+// or streamed (see ckks_stream_constants). The CDMA must be idle.
+static void selectConstants(uint32_t i, const uint32_t* ntt_modulus_rom_indices, const uint32_t* rns_modulus_rom_indices,
+							int* ntt_constants, int* rns_constants)
+{
+	if(stream_blocks)
+	{
+		loadStreamedConstants(i);
+		*ntt_constants = STREAM_NTT_SLOT;
+		*rns_constants = STREAM_RNS_SLOT;
+	}
+	else
+	{
+		*ntt_constants = ntt_slots[ntt_modulus_rom_indices[i]][0];
+		*rns_constants = rns_modulus_rom_indices[i];
+	}
+}
+
+// Sends the RNS, NTT and PWM program of one modulus of the encryption.
+static void sendEncryptProgram(int ntt_constants, int rns_constants, int32_t log_scale, uint32_t qm, uint32_t log_q)
+{
+	instructions_encrypt[1] = getRNSInstructionWord(log_scale, log_q, rns_constants, qm, configured_current_n);
+#if FUSE_NTT_PWM
+	instructions_encrypt[2] = getNTTPWMInstructionWord(log_q, ntt_constants, qm, configured_current_n);
+#else
+	instructions_encrypt[2] = getNTTTransformationInstructionWord(0, log_q, ntt_constants, qm, configured_current_n);
+	instructions_encrypt[3] = getPWMInstructionWord(log_q, qm, configured_current_n);
+#endif
+
+	sendInstructions(instructions_encrypt, INS_BUFFER_SIZE);
+}
+
 // Performs a CKKS encoding+encryption.
 // @param ciphertext: array of num_moduli pointers. Each pointer indicates an array with
 //					  2*poly_size many 64-bit elements. Each array stores a (c0,c1)-pair of one modulus
@@ -80,17 +433,24 @@ void ckks_decrypt(uint64_t* c0, uint64_t* c1, uint64_t* sk, uint64_t* plaintext,
 //					 i.e.: x[0] = plaintext[0] + j*plaintext[1], ....,
 //						   x[poly_size/2-1] = plaintext[poly_size-2] + j*plaintext[poly_size-1]
 //					 Each of the uint64 elements of plaintext can directly be casted from double.
+//					 With a packed format (see setPlaintextFormat), plaintext has poly_size/2
+//					 words, each holding one complex value.
+//					 With sparse packing (see ckks_set_slots), poly_size is replaced by 2*num_slots.
 // @param poly_size: the polynomial degree. 2^13 in our case
 // @param error_polys_seed: the 64-bit high entropy seed for generating the error polynomials
 // @param pk1_seeds: array with num_moduli 64-bit seeds. Each seed generates one pk1 polynomial residue
-// @param num_moduli: number of moduli involved in encryption
+// @param num_moduli: number of moduli involved in encryption. With streamed constants
+//					  (see ckks_stream_constants), it is not limited by the modulus ROM.
 // @param ntt_modulus_rom_indices: Array with num_moduli offsets of the NTT twiddle factors within
 //								   the modulus ROM (Twiddle factor cache). One offset for each modulus
-//								   involved in encryption.
+//								   involved in encryption. Nothing is encrypted if an offset is not
+//								   below NTT_CONSTANT_SLOTS.
 // @param rns_modulus_rom_indices: Array with num_moduli offsets of the RNS constants within
 //								   the modulus ROM. One offset for each modulus involved in encryption.
+//								   Both index arrays are ignored with streamed constants and may be NULL.
 // @param pk0: Array with num_moduli pointers. Each pointer indicates an array with poly_size elements
-//			   representing one of the pk0 residues.
+//			   representing one of the pk0 residues. Residues in the pk0 cache
+//			   (see ckks_pk0_cache_use and ckks_load_resident_pk0) are not transferred.
 // @param log_scale: The log2 of the scale (Delta) multiplied with each input operand
 // @param log_q: Array with num_moduli many bit-widths of the moduli q.
 //				 A value of 0 corresponds to 46-bit modulus, 1 -> 47-bit, ..., 8 -> 54-bit modulus
@@ -101,30 +461,21 @@ void ckks_encrypt(uint64_t** ciphertext0, uint64_t** ciphertext1, uint64_t* plai
 				  uint32_t* rns_modulus_rom_indices, uint64_t** pk0, int32_t log_scale, uint32_t* qm,
 				  uint32_t* log_q)
 {
-	cdmaDDRtoBRAM(FFT_BRAM_ID, (size_t)plaintext, poly_size*sizeof(uint64_t), configured_current_n);
-
-	log_scale = log_scale - 52 - 1023 - (13+configured_current_n); // -13 for scaling factor of 1/N
-	if(log_scale < 0)
-		log_scale += 4096;
-
-	send64(instructions_encode, INS_BUFFER_SIZE, 1, 0);
-	cdmaWaitForIdle();
-
-	exeInsWithParameter(error_polys_seed);
+	if(!validNttIndices(ntt_modulus_rom_indices, num_moduli))
+		return;
+	log_scale = runEncode(plaintext, poly_size, error_polys_seed, log_scale);
 
 	for(uint8_t modulus_index = 0; modulus_index < num_moduli; ++modulus_index)
 	{
-		cdmaDDRtoBRAM(NTT_KEY_BRAM_ID, (size_t)pk0[modulus_index], poly_size*sizeof(uint64_t),configured_current_n);
-
-		int ntt_constants = ntt_modulus_rom_indices[modulus_index];
-		if(ntt_constants == 15)
-			ntt_constants = 16;
+		int ntt_constants, rns_constants;
+		selectConstants(modulus_index, ntt_modulus_rom_indices, rns_modulus_rom_indices, &ntt_constants, &rns_constants);
 
-		instructions_encrypt[1] = getRNSInstructionWord(log_scale, log_q[modulus_index], rns_modulus_rom_indices[modulus_index], qm[modulus_index],configured_current_n);
-		instructions_encrypt[2] = getNTTTransformationInstructionWord(0, log_q[modulus_index], ntt_constants, qm[modulus_index],configured_current_n);
-		instructions_encrypt[3] = getPWMInstructionWord(log_q[modulus_index], qm[modulus_index],configured_current_n);
+		uint32_t pk0_region = pk0CacheRegion(pk0[modulus_index], qm[modulus_index], log_q[modulus_index], poly_size);
+		setPk0Region(pk0_region);
+		if(!pk0_region)
+			cdmaDDRtoBRAM(NTT_KEY_BRAM_ID, (size_t)pk0[modulus_index], poly_size*sizeof(uint64_t),configured_current_n);
 
-		send64(instructions_encrypt, INS_BUFFER_SIZE, 1, 0);
+		sendEncryptProgram(ntt_constants, rns_constants, log_scale, qm[modulus_index], log_q[modulus_index]);
 		cdmaWaitForIdle();
 
 		exeInsWithParameter(pk1_seeds[modulus_index]);
@@ -134,4 +485,352 @@ void ckks_encrypt(uint64_t** ciphertext0, uint64_t** ciphertext1, uint64_t* plai
 		cdmaBRAMtoDDR((size_t)ciphertext1[modulus_index], NTT_KEY_BRAM_ID, poly_size*sizeof(uint64_t));
 		cdmaWaitForIdle();
 	}
+	setPk0Region(0);
+}
+
+// Encrypts plaintext into the contiguous ciphertext ct (see ciphertext.h),
+// whose header selects N, the moduli and the scale (see ctInit). The residues
+// are DMA'd to their place in ct, so ct is sent to a socket or file as it is.
+// All other parameters as in ckks_encrypt.
+void ckks_encrypt_ct(CtHeader* ct, uint64_t* plaintext, uint64_t error_polys_seed, uint64_t* pk1_seeds,
+					 uint32_t* ntt_modulus_rom_indices, uint32_t* rns_modulus_rom_indices, uint64_t** pk0)
+{
+	uint64_t *c0[ct->num_moduli], *c1[ct->num_moduli];
+	uint32_t qm[ct->num_moduli], log_q[ct->num_moduli];
+
+	for(uint32_t i = 0; i < ct->num_moduli; ++i)
+	{
+		c0[i] = ctC0(ct, i);
+		c1[i] = ctC1(ct, i);
+		qm[i] = CT_QM(ct, i);
+		log_q[i] = CT_LOG_Q(ct, i);
+	}
+	ckks_encrypt(c0, c1, plaintext, 1u << ct->log_n, error_polys_seed, pk1_seeds, ct->num_moduli,
+				 ntt_modulus_rom_indices, rns_modulus_rom_indices, pk0, ct->log_scale, qm, log_q);
+}
+
+// Montgomery factor R = 2^72 of the PWM
+#define MONT_LOG_R 72
+
+// Returns q = 2^(log_q+46) - (qm << 24) + 1
+static uint64_t modulusValue(uint32_t qm, uint32_t log_q)
+{
+	return (1ull << (46+log_q)) - ((uint64_t)qm << 24) + 1;
+}
+
+// Returns 2^e mod q without 128-bit arithmetic
+static uint64_t pow2Mod(uint32_t e, uint64_t q)
+{
+	uint64_t r = 1;
+	for(uint32_t i = 0; i < e; ++i)
+	{
+		r <<= 1;
+		if(r >= q)
+			r -= q;
+	}
+	return r;
+}
+
+static void fillPoly(uint64_t* poly, uint64_t value, uint32_t poly_size)
+{
+	for(uint32_t i = 0; i < poly_size; ++i)
+		poly[i] = value;
+}
+
+// Runs a single PWM of N = 2^(13+current_n): message BRAM = c + a*b*R^-1 mod q
+// with a in the V BRAM, b in the key BRAM and c in the message BRAM. NULL
+// operands keep the content of their BRAM. The key BRAM receives
+// e1 + a*pk1*R^-1 with e1 and pk1 of the last encryption program.
+static void runPwmInBram(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint32_t poly_size, uint32_t qm,
+						 uint32_t log_q, uint8_t current_n)
+{
+	const uint64_t* operands[3] = {a, b, c};
+	const size_t bram_ids[3] = {NTT_V_BRAM_ID, NTT_KEY_BRAM_ID, NTT_MSG_BRAM_ID};
+
+	instructions_pwm[1] = getPWMInstructionWord(log_q, qm, current_n);
+	sendInstructions(instructions_pwm, INS_BUFFER_SIZE);
+	for(uint32_t i = 0; i < 3; ++i)
+	{
+		if(!operands[i])
+			continue;
+		cdmaDDRtoBRAM(bram_ids[i], (size_t)operands[i], poly_size*sizeof(uint64_t), current_n);
+		cdmaWaitForIdle();
+	}
+
+	exeIns();
+}
+
+// Runs a single PWM (see runPwmInBram) and copies the result to result.
+static void runPwm(uint64_t* result, const uint64_t* a, const uint64_t* b, const uint64_t* c, uint32_t poly_size,
+				   uint32_t qm, uint32_t log_q)
+{
+	runPwmInBram(a, b, c, poly_size, qm, log_q, configured_current_n);
+	cdmaBRAMtoDDR((size_t)result, NTT_MSG_BRAM_ID, poly_size*sizeof(uint64_t));
+	cdmaWaitForIdle();
+}
+
+// Generates a key pair on the accelerator. The secret key s is the ternary
+// polynomial v that the encode program samples from sk_seed and the key error
+// is the negated e1 of the same seed. For each modulus, the encryption program
+// of a zero message gives c1 = e1 + v*a (a = pk1*R^-1, pk1 sampled from
+// pk1_seeds like in ckks_encrypt) and leaves NTT(v) in the V BRAM. Two PWMs
+// with constant polynomials then yield
+//   sk  = NTT(v)*R          (NTT(v) * R^2 * R^-1)
+//   pk0 = -c1*R = (-a*s + e)*R
+// in the formats of ckks_decrypt and ckks_encrypt.
+// @param sk: Array with num_moduli pointers, each receives the residue of the secret key
+//			  (poly_size words) of one modulus.
+// @param pk0: Array with num_moduli pointers, each receives a pk0 residue (poly_size words).
+// @param scratch: 2*poly_size words in DDR
+// @param sk_seed: the 64-bit high entropy seed of the secret key and the key error
+// @param pk1_seeds: array with the num_moduli seeds of the pk1 residues, i.e., of the public key
+// All other parameters as in ckks_encrypt.
+void ckks_keygen(uint64_t** sk, uint64_t** pk0, uint64_t* scratch, uint32_t poly_size, uint64_t sk_seed,
+				 uint64_t* pk1_seeds, uint8_t num_moduli, uint32_t* ntt_modulus_rom_indices,
+				 uint32_t* rns_modulus_rom_indices, uint32_t* qm, uint32_t* log_q)
+{
+	uint64_t* zero = scratch;
+	uint64_t* constant = scratch + poly_size;
+
+	if(!validNttIndices(ntt_modulus_rom_indices, num_moduli))
+		return;
+	fillPoly(zero, 0, poly_size);
+	setPk0Region(0);
+	int32_t log_scale = runEncode(zero, poly_size, sk_seed, 0);
+
+	for(uint8_t modulus_index = 0; modulus_index < num_moduli; ++modulus_index)
+	{
+		uint64_t q = modulusValue(qm[modulus_index], log_q[modulus_index]);
+		uint64_t r2 = pow2Mod(2*MONT_LOG_R, q);
+		int ntt_constants, rns_constants;
+
+		selectConstants(modulus_index, ntt_modulus_rom_indices, rns_modulus_rom_indices, &ntt_constants, &rns_constants);
+		sendEncryptProgram(ntt_constants, rns_constants, log_scale, qm[modulus_index], log_q[modulus_index]);
+		exeInsWithParameter(pk1_seeds[modulus_index]);
+		cdmaBRAMtoDDR((size_t)pk0[modulus_index], NTT_KEY_BRAM_ID, poly_size*sizeof(uint64_t));
+		cdmaWaitForIdle();
+
+		fillPoly(constant, r2, poly_size);
+		runPwm(sk[modulus_index], NULL, constant, zero, poly_size, qm[modulus_index], log_q[modulus_index]);
+		fillPoly(constant, q - r2, poly_size);
+		runPwm(pk0[modulus_index], pk0[modulus_index], constant, zero, poly_size, qm[modulus_index], log_q[modulus_index]);
+	}
+}
+
+// Returns the Galois element 3^steps mod 2N that rotates the slots by steps
+// (to the left for positive steps), see Expand.sv.
+uint32_t ckks_galois_element(int32_t steps)
+{
+	uint32_t two_n = 2u << (13+configured_current_n);
+	uint32_t order = two_n/4; // order of 3 modulo 2N
+	uint32_t e = (uint32_t)((steps % (int32_t)order) + (int32_t)order) % order;
+	uint32_t galois = 1;
+	for(uint32_t i = 0; i < e; ++i)
+		galois = (galois*3) & (two_n - 1);
+	return galois;
+}
+
+// Applies the automorphism X -> X^galois to input and stores it in result.
+// The accelerator reads the message BRAM and writes the key BRAM (region 0).
+// @param galois: odd Galois element < 2N (see ckks_galois_element, 2N-1 conjugates)
+// @param ntt_domain: 1 if input is in the NTT domain (e.g., a ciphertext or key
+//					  residue), 0 for the coefficient domain
+// @param qm, log_q: the modulus of input
+void ckks_automorphism(uint64_t* result, const uint64_t* input, uint32_t poly_size, uint32_t galois,
+					   uint8_t ntt_domain, uint32_t qm, uint32_t log_q)
+{
+	instructions_automorphism[1] = getAutomorphismInstructionWord(galois, ntt_domain, log_q, qm, configured_current_n);
+	setPk0Region(0);
+	cdmaDDRtoBRAM(NTT_MSG_BRAM_ID, (size_t)input, poly_size*sizeof(uint64_t), configured_current_n);
+	sendInstructions(instructions_automorphism, INS_BUFFER_SIZE);
+	cdmaWaitForIdle();
+
+	exeIns();
+
+	cdmaBRAMtoDDR((size_t)result, NTT_KEY_BRAM_ID, poly_size*sizeof(uint64_t));
+	cdmaWaitForIdle();
+}
+
+// Runs the 2^15-point NTT of one tile of the four-step NTT on the message BRAM
+// and copies it to result. NULL keeps the content of the BRAM as input.
+static void runTileNtt(uint64_t* result, const uint64_t* tile, uint8_t inverse, uint8_t ntt_constants, uint32_t qm,
+					   uint32_t log_q)
+{
+	instructions_ntt[1] = getNTTTransformationInstructionWord(inverse, log_q, ntt_constants, qm,
+															  FOUR_STEP_TILE_CURRENT_N);
+	sendInstructions(instructions_ntt, INS_BUFFER_SIZE);
+	if(tile)
+		cdmaDDRtoBRAM(NTT_MSG_BRAM_ID, (size_t)tile, FOUR_STEP_TILE_SIZE*sizeof(uint64_t), FOUR_STEP_TILE_CURRENT_N);
+	cdmaWaitForIdle();
+
+	exeIns();
+
+	cdmaBRAMtoDDR((size_t)result, NTT_MSG_BRAM_ID, FOUR_STEP_TILE_SIZE*sizeof(uint64_t));
+	cdmaWaitForIdle();
+}
+
+// Computes the twiddle polynomials of ckks_ntt_four_step for the root psi on
+// the CPU. This takes four modular multiplications per coefficient, which are
+// bit-serial on the MicroBlaze, so it is meant to run once per modulus.
+// @param twiddles: Array with FOUR_STEP_TWIDDLE_POLYS pointers to 2^15 words in DDR
+// @param psi, qm, log_q: as in ckks_ntt_four_step
+void ckks_four_step_twiddles(uint64_t** twiddles, uint64_t psi, uint32_t qm, uint32_t log_q)
+{
+	fourStepTwiddles(twiddles, psi, modulusValue(qm, log_q));
+}
+
+// Forward or inverse NTT of a polynomial with N = 2^16 coefficients, which
+// does not fit into the BRAMs, as four-step NTT with two tiles of 2^15
+// coefficients (see fourStep.c). All steps run on the accelerator with the
+// instructions of N = 2^15: two PWMs with the twiddle polynomials compute the
+// 2-point column transform and the twist of each tile, and the regular NTT of
+// the ROM computes the 2^15-point transform of the tile. The result has the
+// order of the hardware NTT, i.e., tile k is block k of the 2^16-point NTT,
+// and the inverse includes the scaling by 1/N. Per transform, 3 MiB (forward)
+// or 4 MiB (inverse) move over the DMA. The key BRAM is overwritten.
+// @param poly: 2^16 words in DDR, reduced modulo q and transformed in place
+// @param inverse: 0 for the forward NTT, 1 for the inverse NTT
+// @param ntt_modulus_rom_index: NTT constants index of the 2^15-point transform (as in ckks_decrypt)
+// @param psi: primitive 2^17-th root of unity modulo q whose square is the root of the
+//			   2^15-point forward NTT constants (see Aloha-HE_Host/fourStepNtt)
+// @param twiddles: the twiddle polynomials of psi (see ckks_four_step_twiddles)
+// All other parameters as in ckks_decrypt. Returns 0 if ntt_modulus_rom_index
+// is out of range, psi is no primitive 2^17-th root of unity or its square is
+// not the root of the constants.
+int ckks_ntt_four_step(uint64_t* poly, uint8_t inverse, uint32_t qm, uint32_t log_q, uint8_t ntt_modulus_rom_index,
+					   uint64_t psi, uint64_t** twiddles)
+{
+	uint64_t q = modulusValue(qm, log_q);
+	uint32_t ntt_index = ntt_modulus_rom_index;
+	uint64_t* hi = poly + FOUR_STEP_TILE_SIZE;
+	uint64_t* tmp;
+
+	if(!validNttIndices(&ntt_index, 1))
+		return 0;
+	uint8_t ntt_constants = ntt_slots[stream_blocks ? 0 : ntt_index][inverse ? 1 : 0];
+	if(stream_blocks)
+	{
+		loadStreamedConstants(0);
+		ntt_constants = STREAM_NTT_SLOT + (inverse ? 1 : 0);
+	}
+	if(!fourStepCheckRoot(psi, q, ntt_root_constants[ntt_constants], inverse) ||
+	   !(tmp = dmaPoolAlloc(FOUR_STEP_TILE_SIZE)))
+		return 0;
+	setPk0Region(0);
+
+	if(!inverse)
+	{
+		// tile k = NTT(lo*FWD_LO(k) + hi*FWD_HI(k)), tile 0 is buffered until lo is read
+		for(uint32_t k = 0; k < 2; ++k)
+		{
+			runPwmInBram(poly, twiddles[FOUR_STEP_FWD_LO(k)], twiddles[FOUR_STEP_ZERO], FOUR_STEP_TILE_SIZE, qm, log_q,
+						 FOUR_STEP_TILE_CURRENT_N);
+			runPwmInBram(hi, twiddles[FOUR_STEP_FWD_HI(k)], NULL, FOUR_STEP_TILE_SIZE, qm, log_q,
+						 FOUR_STEP_TILE_CURRENT_N);
+			runTileNtt(k ? hi : tmp, NULL, 0, ntt_constants, qm, log_q);
+		}
+	}
+	else
+	{
+		// half k = INTT(tile 0)*INV_T0(k) + INTT(tile 1)*INV_T1(k), half 0 is buffered until tile 0 is read
+		runTileNtt(poly, poly, 1, ntt_constants, qm, log_q);
+		runTileNtt(hi, hi, 1, ntt_constants, qm, log_q);
+		for(uint32_t k = 0; k < 2; ++k)
+		{
+			runPwmInBram(poly, twiddles[FOUR_STEP_INV_T0(k)], twiddles[FOUR_STEP_ZERO], FOUR_STEP_TILE_SIZE, qm, log_q,
+						 FOUR_STEP_TILE_CURRENT_N);
+			runPwmInBram(hi, twiddles[FOUR_STEP_INV_T1(k)], NULL, FOUR_STEP_TILE_SIZE, qm, log_q,
+						 FOUR_STEP_TILE_CURRENT_N);
+			cdmaBRAMtoDDR((size_t)(k ? hi : tmp), NTT_MSG_BRAM_ID, FOUR_STEP_TILE_SIZE*sizeof(uint64_t));
+			cdmaWaitForIdle();
+		}
+	}
+	memcpy(poly, tmp, FOUR_STEP_TILE_SIZE*sizeof(uint64_t));
+	dmaPoolFree(tmp, FOUR_STEP_TILE_SIZE);
+	return 1;
+}
+
+// Generates a key switching key from s^2 (galois == 0) or from s(X^galois)
+// to the secret key s of ckks_keygen, with one digit per
+// modulus (RNS gadget, no special modulus):
+//   b_i = -a_i*s + e_i + g_i*t,  g_i = 1 mod q_i and 0 mod q_j for j != i,
+// with t = s^2 or t = s(X^galois). Residue j of a_i is a = pk1*R^-1 with pk1
+// sampled from seeds[i*num_moduli+j] and e_i is the e1 that the encode program
+// samples from error_seeds[i]. For each digit and modulus, the encryption
+// program samples e1 and pk1 and a PWM with V = -NTT(s) and key = sk gives
+// e1 - NTT(s)*a in the key BRAM and -NTT(s)^2 in the message BRAM. -NTT(t)
+// of the automorphism is computed before the encryption program.
+static void switchKeygen(uint64_t** ksk, uint64_t** sk, uint64_t* scratch, uint32_t poly_size, uint64_t* error_seeds,
+						 uint64_t* seeds, uint8_t num_moduli, uint32_t* ntt_modulus_rom_indices,
+						 uint32_t* rns_modulus_rom_indices, uint32_t* qm, uint32_t* log_q, uint32_t galois)
+{
+	uint64_t* zero = scratch;
+	uint64_t* tmp = scratch + poly_size;
+	uint64_t* neg_s = scratch + 2*poly_size; // -NTT(s) of each modulus
+
+	if(!validNttIndices(ntt_modulus_rom_indices, num_moduli))
+		return;
+	fillPoly(zero, 0, poly_size);
+	setPk0Region(0);
+	for(uint8_t j = 0; j < num_moduli; ++j)
+	{
+		fillPoly(tmp, modulusValue(qm[j], log_q[j]) - 1, poly_size);
+		runPwm(neg_s + j*poly_size, sk[j], tmp, zero, poly_size, qm[j], log_q[j]);
+	}
+
+	for(uint8_t i = 0; i < num_moduli; ++i)
+	{
+		int32_t log_scale = runEncode(zero, poly_size, error_seeds[i], 0);
+		for(uint8_t j = 0; j < num_moduli; ++j)
+		{
+			uint64_t* b = ksk[i*num_moduli + j];
+			int ntt_constants, rns_constants;
+
+			if(i == j && galois)
+				ckks_automorphism(tmp, neg_s + j*poly_size, poly_size, galois, 1, qm[j], log_q[j]);
+
+			selectConstants(j, ntt_modulus_rom_indices, rns_modulus_rom_indices, &ntt_constants, &rns_constants);
+			sendEncryptProgram(ntt_constants, rns_constants, log_scale, qm[j], log_q[j]);
+			exeInsWithParameter(seeds[i*num_moduli + j]);
+
+			// tmp keeps -NTT(t) of the automorphism, b is overwritten below
+			runPwm(galois ? b : tmp, neg_s + j*poly_size, sk[j], zero, poly_size, qm[j], log_q[j]);
+			cdmaBRAMtoDDR((size_t)b, NTT_KEY_BRAM_ID, poly_size*sizeof(uint64_t));
+			cdmaWaitForIdle();
+			if(i == j)
+			{
+				uint64_t q = modulusValue(qm[j], log_q[j]);
+				for(uint32_t k = 0; k < poly_size; ++k)
+					b[k] = b[k] >= tmp[k] ? b[k] - tmp[k] : b[k] + q - tmp[k];
+			}
+		}
+	}
+}
+
+// Generates the relinearization key (t = s^2, see switchKeygen) of the secret
+// key of ckks_keygen on the accelerator.
+// @param rlk: Array with num_moduli*num_moduli pointers, rlk[i*num_moduli+j] receives
+//			   residue j of b_i (poly_size words, NTT domain).
+// @param sk: the num_moduli residues of the secret key (see ckks_keygen)
+// @param scratch: (2+num_moduli)*poly_size words in DDR
+// @param rlk_error_seeds: num_moduli seeds of the errors e_i
+// @param rlk_seeds: num_moduli*num_moduli seeds of the a_i residues
+// All other parameters as in ckks_keygen.
+void ckks_rlkgen(uint64_t** rlk, uint64_t** sk, uint64_t* scratch, uint32_t poly_size, uint64_t* rlk_error_seeds,
+				 uint64_t* rlk_seeds, uint8_t num_moduli, uint32_t* ntt_modulus_rom_indices,
+				 uint32_t* rns_modulus_rom_indices, uint32_t* qm, uint32_t* log_q)
+{
+	switchKeygen(rlk, sk, scratch, poly_size, rlk_error_seeds, rlk_seeds, num_moduli, ntt_modulus_rom_indices,
+				 rns_modulus_rom_indices, qm, log_q, 0);
+}
+
+// Generates the Galois key of galois (t = s(X^galois), see switchKeygen) of
+// the secret key of ckks_keygen on the accelerator. The parameters are the
+// ones of ckks_rlkgen.
+void ckks_galkgen(uint64_t** gk, uint64_t** sk, uint64_t* scratch, uint32_t poly_size, uint64_t* gk_error_seeds,
+				  uint64_t* gk_seeds, uint8_t num_moduli, uint32_t* ntt_modulus_rom_indices,
+				  uint32_t* rns_modulus_rom_indices, uint32_t* qm, uint32_t* log_q, uint32_t galois)
+{
+	switchKeygen(gk, sk, scratch, poly_size, gk_error_seeds, gk_seeds, num_moduli, ntt_modulus_rom_indices,
+				 rns_modulus_rom_indices, qm, log_q, galois);
 }
@@ -2,6 +2,8 @@
 #define SRC_CKKS_ACCELERATOR_H_
 
 #include <stdint.h>
+#include "communication.h"
+#include "ciphertext.h"
 
 void ckks_encrypt(uint64_t** ciphertext0, uint64_t** ciphertext1, uint64_t* plaintext, uint32_t poly_size, uint64_t error_polys_seed,
 				  uint64_t* pk1_seeds, uint8_t num_moduli, uint32_t* ntt_modulus_rom_indices,
@@ -9,6 +11,39 @@ void ckks_encrypt(uint64_t** ciphertext0, uint64_t** ciphertext1, uint64_t* plai
 				  uint32_t* log_q);
 void ckks_decrypt(uint64_t* c0, uint64_t* c1, uint64_t* sk, uint64_t* plaintext, uint32_t poly_size, uint32_t qm, uint8_t log_q,
 		          uint8_t ntt_modulus_rom_index, int32_t log_scale);
+void ckks_encrypt_ct(CtHeader* ct, uint64_t* plaintext, uint64_t error_polys_seed, uint64_t* pk1_seeds,
+					 uint32_t* ntt_modulus_rom_indices, uint32_t* rns_modulus_rom_indices, uint64_t** pk0);
+void ckks_decrypt_ct(const CtHeader* ct, uint64_t* sk, uint64_t* plaintext, uint8_t ntt_modulus_rom_index);
+void ckks_keygen(uint64_t** sk, uint64_t** pk0, uint64_t* scratch, uint32_t poly_size, uint64_t sk_seed,
+				 uint64_t* pk1_seeds, uint8_t num_moduli, uint32_t* ntt_modulus_rom_indices,
+				 uint32_t* rns_modulus_rom_indices, uint32_t* qm, uint32_t* log_q);
+void ckks_rlkgen(uint64_t** rlk, uint64_t** sk, uint64_t* scratch, uint32_t poly_size, uint64_t* rlk_error_seeds,
+				 uint64_t* rlk_seeds, uint8_t num_moduli, uint32_t* ntt_modulus_rom_indices,
+				 uint32_t* rns_modulus_rom_indices, uint32_t* qm, uint32_t* log_q);
+void ckks_galkgen(uint64_t** gk, uint64_t** sk, uint64_t* scratch, uint32_t poly_size, uint64_t* gk_error_seeds,
+				  uint64_t* gk_seeds, uint8_t num_moduli, uint32_t* ntt_modulus_rom_indices,
+				  uint32_t* rns_modulus_rom_indices, uint32_t* qm, uint32_t* log_q, uint32_t galois);
+uint32_t ckks_galois_element(int32_t steps);
+void ckks_automorphism(uint64_t* result, const uint64_t* input, uint32_t poly_size, uint32_t galois,
+					   uint8_t ntt_domain, uint32_t qm, uint32_t log_q);
+void ckks_four_step_twiddles(uint64_t** twiddles, uint64_t psi, uint32_t qm, uint32_t log_q);
+int ckks_ntt_four_step(uint64_t* poly, uint8_t inverse, uint32_t qm, uint32_t log_q, uint8_t ntt_modulus_rom_index,
+					   uint64_t psi, uint64_t** twiddles);
 void ckks_init(uint8_t current_n);
+int ckks_set_slots(uint32_t num_slots);
+void ckks_load_constants(const uint64_t* lines, uint32_t first_line, uint32_t num_lines);
+int ckks_set_ntt_slots(uint8_t ntt_index, uint8_t forward_slot, uint8_t inverse_slot);
+
+// Constants streaming (see ckks_stream_constants): words per modulus
+#define CKKS_STREAM_BLOCK_WORDS (2*(RNS_CONSTANT_LINES + NTT_CONSTANT_LINES))
+void ckks_stream_constants(const uint64_t* blocks);
+
+// pk0 cache (see ckks_pk0_cache_use):
+#define PK0_CACHE_NO_KEY  0xffffffff // ckks_pk0_cache_use: do not cache the pk0 residues
+#define PK0_CACHE_ALL     0xffffffff // ckks_pk0_cache_invalidate: invalidate all keys
+void ckks_pk0_cache_use(uint32_t key_id);
+void ckks_pk0_cache_invalidate(uint32_t key_id);
+void ckks_pk0_cache_stats(uint64_t* hits, uint64_t* misses, uint64_t* bytes_saved);
+uint8_t ckks_load_resident_pk0(uint64_t** pk0, uint8_t num_moduli);
 
 #endif /* SRC_CKKS_ACCELERATOR_H_ */
@@ -8,43 +8,74 @@
 
 #ifndef SRC_COMMUNICATION_C_
 #define SRC_COMMUNICATION_C_
-#include "xparameters.h"
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include "communication.h"
+#include "dmaPool.h"
+#ifdef __linux__
+#include "linuxDevice.h"
+#else
+#include "xparameters.h"
 #include "xil_io.h"
 #include "xil_cache.h"
+#endif
 
 extern volatile uint32_t * axi_address_base;
 
 #define MAX_POLY_SIZE (1<<15)
 
-// DMA control port:
-#define CDMACR   0x0	//CDMA control register
-#define CDMASR   0x4	//CDMA status register
-#define CDMA_SA  0x18  	//CDMA source address register
-#define CDMA_DA  0x20  	//CDMA destination address register
-#define CDMA_BTT 0x28  	//CDMA bytes to transfer. Writing to this initiates the transaction
+// Register access of the CDMA, AXI address of a buffer in DDR, physically
+// contiguous bytes of a buffer and cache maintenance of the transferred bytes.
+// On Linux, the registers are mapped through UIO and the buffers must be
+// allocated by linuxDmaAlloc (see linuxDevice.c).
+#ifdef __linux__
+#define CDMA_READ(reg)          linuxCdmaRead(reg)
+#define CDMA_WRITE(reg, val)    linuxCdmaWrite(reg, val)
+#define DDR_AXI_ADDR(addr, num_bytes) linuxDmaAddress(addr, num_bytes)
+#define DDR_CONTIGUOUS_BYTES(addr, num_bytes) linuxDmaContiguousBytes(addr, num_bytes)
+#define CACHE_FLUSH(addr, num_bytes)      linuxCacheFlush(addr, num_bytes)
+#define CACHE_INVALIDATE(addr, num_bytes) linuxCacheInvalidate(addr, num_bytes)
+#else
+#define CDMA_READ(reg)          Xil_In32(XPAR_AXI_CDMA_0_BASEADDR + (reg))
+#define CDMA_WRITE(reg, val)    Xil_Out32(XPAR_AXI_CDMA_0_BASEADDR + (reg), val)
+#define DDR_AXI_ADDR(addr, num_bytes) ((addr) | 0x80000000)
+#define DDR_CONTIGUOUS_BYTES(addr, num_bytes) (num_bytes)
+#define CACHE_FLUSH(addr, num_bytes)      Xil_DCacheFlushRange(addr, num_bytes)
+#define CACHE_INVALIDATE(addr, num_bytes) Xil_DCacheInvalidateRange(addr, num_bytes)
+#endif
+
+// DDR range written by the pending transfer of cdmaBRAMtoDDR. It is
+// invalidated in the cache when the transfer is completed (see cdmaWaitForIdle).
+static size_t pending_invalidate_addr;
+static uint32_t pending_invalidate_bytes;
 
-// DMA data port memory layout:
-#define BRAM_CTRL_AXI_BASE 0xC0000000
-#define BRAM_CTRL_MSG_ADDR (BRAM_CTRL_AXI_BASE + 0*MAX_POLY_SIZE*sizeof(uint64_t))
-#define BRAM_CTRL_KEY_ADDR (BRAM_CTRL_AXI_BASE + 1*MAX_POLY_SIZE*sizeof(uint64_t))
-#define BRAM_CTRL_V_ADDR   (BRAM_CTRL_AXI_BASE + 2*MAX_POLY_SIZE*sizeof(uint64_t))
-#define BRAM_CTRL_FFT_ADDR (BRAM_CTRL_AXI_BASE + 3*MAX_POLY_SIZE*sizeof(uint64_t))
+// control_low_word bits selecting the plaintext format (see setPlaintextFormat)
+static uint32_t plaintext_format_bits = 0;
+static uint8_t plaintext_format = PT_FORMAT_DOUBLE;
+// control_high_word bits selecting sparse packing (see setSparseShift)
+static uint32_t sparse_shift_bits = 0;
+// control_high_word bits selecting the key BRAM region of pk0 (see setPk0Region)
+static uint32_t pk0_region_bits = 0;
 
 // set this to 1 for verbose debug and status output
 #define DEBUG 0
 // undefine this to obtain cycle counts of each instruction execution
 #define PERFORMANCE
+// set this to 1 to print the execution trace after each program execution
+#define TRACE 0
+// set this to 0 for bitstreams that cannot load programs via DMA (see
+// sendInstructions), then programs are sent by send64
+#define INS_UPLOAD_DMA 1
 
 
-// This function blocks until the DMA is idle
+// This function blocks until the DMA is idle. The destination of a completed
+// cdmaBRAMtoDDR is invalidated in the cache, so the CPU reads the new data.
 void cdmaWaitForIdle()
 {
 	while(1)
 	{
-		uint32_t read_val = Xil_In32(XPAR_AXI_CDMA_0_BASEADDR + CDMASR);
+		uint32_t read_val = CDMA_READ(CDMASR);
 		if(read_val & (1<<1))
 		{
 			if(DEBUG) printf("CDMA: IDLE bit is set\n");
@@ -55,6 +86,11 @@ void cdmaWaitForIdle()
 			if(DEBUG) printf("CDMA: IDLE bit is NOT set!!!!\n");
 		}
 	}
+	if(pending_invalidate_bytes)
+	{
+		CACHE_INVALIDATE(pending_invalidate_addr, pending_invalidate_bytes);
+		pending_invalidate_bytes = 0;
+	}
 }
 
 // This function initiates a DMA transaction. DMA copies num_bytes many bytes from src_addr to
@@ -68,24 +104,24 @@ void cdma_transaction(size_t dest_addr, size_t src_addr, size_t num_bytes, uint8
 	// void cdmaWaitForIdle();
 
 	//set interrupt bits if needed. Requires adaption of block design
-	//read_val = Xil_In32(XPAR_AXI_CDMA_0_BASEADDR + CDMACR);
+	//read_val = CDMA_READ(CDMACR);
 	// read_val |= (1<<12); // interrupt on transfer completion
 	// read_val |= (1<<14); // interrupt on error
-	//Xil_Out32(XPAR_AXI_CDMA_0_BASEADDR + CDMACR, read_val);
-	if(DEBUG) printf("CDMA: setting cr to %lx\n",read_val);
+	//CDMA_WRITE(CDMACR, read_val);
+	if(DEBUG) printf("CDMA: setting cr to %" PRIx32 "\n",read_val);
 
 	//set source address:
 	if(DEBUG) printf("CDMA: setting source address to %zx (%zu bytes)\n",src_addr,sizeof(size_t));
-	Xil_Out32(XPAR_AXI_CDMA_0_BASEADDR + CDMA_SA, (size_t)src_addr);
-	if(DEBUG) printf("                             is 0x%lx\n",Xil_In32(XPAR_AXI_CDMA_0_BASEADDR + CDMA_SA));
+	CDMA_WRITE(CDMA_SA, (size_t)src_addr);
+	if(DEBUG) printf("                             is 0x%" PRIx32 "\n",CDMA_READ(CDMA_SA));
 
 	//set dest address:
 	if(DEBUG) printf("CDMA: setting dest address to   %zx\n",dest_addr);
-	Xil_Out32(XPAR_AXI_CDMA_0_BASEADDR + CDMA_DA, dest_addr);
-	if(DEBUG) printf("                           is   0x%lx\n",Xil_In32(XPAR_AXI_CDMA_0_BASEADDR + CDMA_DA));
+	CDMA_WRITE(CDMA_DA, dest_addr);
+	if(DEBUG) printf("                           is   0x%" PRIx32 "\n",CDMA_READ(CDMA_DA));
 
 	//set number of transferred bytes. This also starts the transfer:
-	Xil_Out32(XPAR_AXI_CDMA_0_BASEADDR + CDMA_BTT, num_bytes);
+	CDMA_WRITE(CDMA_BTT, num_bytes);
 	if(DEBUG) printf("CDMA: done sending num_bytes\n");
 
 	if(!block)
@@ -94,14 +130,35 @@ void cdma_transaction(size_t dest_addr, size_t src_addr, size_t num_bytes, uint8
 	if(DEBUG) printf("CDMA: waiting for completion of the transfer...\n");
 	do
 	{
-		read_val = Xil_In32(XPAR_AXI_CDMA_0_BASEADDR + CDMASR);
+		read_val = CDMA_READ(CDMASR);
 	} while(!(read_val & (1<<1)));
 
 	if(DEBUG) printf("CDMA: done waiting\n");
 }
 
+// Copies num_bytes between the BRAM at the AXI address bram_addr and the DDR
+// buffer at ddr_addr (to the BRAM if to_bram != 0). A buffer that is not
+// physically contiguous (e.g., a ciphertext across hugepages on Linux) is
+// transferred in chunks, i.e., the DMA is chained by software: every chunk but
+// the last blocks until it is completed. The last one does not block.
+static void cdmaChain(size_t bram_addr, size_t ddr_addr, uint32_t num_bytes, uint8_t to_bram)
+{
+	while(num_bytes)
+	{
+		uint32_t chunk = DDR_CONTIGUOUS_BYTES(ddr_addr, num_bytes);
+		size_t ddr_axi_addr = DDR_AXI_ADDR(ddr_addr, chunk);
+		if(to_bram)
+			cdma_transaction(bram_addr, ddr_axi_addr, chunk, chunk < num_bytes);
+		else
+			cdma_transaction(ddr_axi_addr, bram_addr, chunk, chunk < num_bytes);
+		bram_addr += chunk;
+		ddr_addr += chunk;
+		num_bytes -= chunk;
+	}
+}
+
 // This function copies num_bytes many bytes from source_address (which is a physical address in RAM) to
-// the BRAM with the id dest_bram_id. 
+// the BRAM with the id dest_bram_id. The source bytes are flushed from the cache.
 // This function does not block until transaction is completed.
 void cdmaDDRtoBRAM(size_t dest_bram_id, size_t source_addr, uint32_t num_bytes, uint8_t current_n)
 {
@@ -111,7 +168,7 @@ void cdmaDDRtoBRAM(size_t dest_bram_id, size_t source_addr, uint32_t num_bytes,
 	case FFT_BRAM_ID:
 	{
 		dest_addr = BRAM_CTRL_FFT_ADDR;
-		axi_address_base[0] = ((uint32_t)current_n) << 27;
+		axi_address_base[0] = plaintext_format_bits | (((uint32_t)current_n) << 27);
 		break;
 	}
 	case NTT_MSG_BRAM_ID: dest_addr = BRAM_CTRL_MSG_ADDR; break;
@@ -120,25 +177,88 @@ void cdmaDDRtoBRAM(size_t dest_bram_id, size_t source_addr, uint32_t num_bytes,
 	default:
 		return;
 	}
-	cdma_transaction(dest_addr, source_addr | 0x80000000, num_bytes, 0);
+	CACHE_FLUSH(source_addr, num_bytes);
+	cdmaChain(dest_addr, source_addr, num_bytes, 1);
+}
+
+// This function copies one polynomial of num_bytes bytes (N coefficients)
+// from source_addr to the given region of the key BRAM (see setPk0Region).
+// Regions beyond the first 2^15 coefficients are reached via the key page
+// (control_high_word[9:8]), hence this function blocks until the transaction
+// is completed and restores page 0.
+void cdmaDDRtoKeyRegion(size_t source_addr, uint32_t num_bytes, uint32_t region)
+{
+	const uint32_t page_bytes = MAX_POLY_SIZE*sizeof(uint64_t);
+	uint32_t offset = region*num_bytes;
+
+	axi_address_base[1] = (offset / page_bytes) << 8;
+	CACHE_FLUSH(source_addr, num_bytes);
+	cdmaChain(BRAM_CTRL_KEY_ADDR + offset % page_bytes, source_addr, num_bytes, 1);
+	cdmaWaitForIdle();
+	axi_address_base[1] = 0;
+}
+
+// This function overwrites num_lines lines of the constants cache, starting
+// at first_line, with the data at source_addr (two 64-bit words per line,
+// the lower half first). The DMA is redirected to the cache while
+// control_high_word[10] is set, hence this function blocks until the
+// transaction is completed. No program may run meanwhile.
+void cdmaDDRtoConstants(size_t source_addr, uint32_t first_line, uint32_t num_lines)
+{
+	axi_address_base[1] = 1 << 10;
+	CACHE_FLUSH(source_addr, num_lines*2*sizeof(uint64_t));
+	cdmaChain(BRAM_CTRL_MSG_ADDR + first_line*2*sizeof(uint64_t), source_addr, num_lines*2*sizeof(uint64_t), 1);
+	cdmaWaitForIdle();
+	axi_address_base[1] = 0;
+}
+
+// This function overwrites the first num_words instructions of the instruction
+// memory with the data at source_addr. The DMA is redirected to the
+// instruction memory while control_high_word[11] is set, hence this function
+// blocks until the transaction is completed. No program may run meanwhile.
+void cdmaDDRtoInstructions(size_t source_addr, uint32_t num_words)
+{
+	axi_address_base[1] = 1 << 11;
+	CACHE_FLUSH(source_addr, num_words*sizeof(uint64_t));
+	cdmaChain(BRAM_CTRL_MSG_ADDR, source_addr, num_words*sizeof(uint64_t), 1);
+	cdmaWaitForIdle();
+	axi_address_base[1] = 0;
 }
 
 // This function copies num_bytes many bytes from the source BRAM with ID source_bram_id to
-// dest_addr (which is a physical address in RAM). 
+// dest_addr (which is a physical address in RAM). The E1, Imag and Error BRAMs
+// can be read but not written via DMA. Dirty lines of the destination
+// are written back before and the destination is invalidated once the transfer
+// is completed (see cdmaWaitForIdle).
 // This function does not block until transaction is completed.
 void cdmaBRAMtoDDR(size_t dest_addr, size_t source_bram_id, uint32_t num_bytes)
 {
 	size_t src_addr;
+
+	// the range of a previous transfer is invalidated once it is completed
+	if(pending_invalidate_bytes)
+		cdmaWaitForIdle();
 	switch(source_bram_id)
 	{
-	case FFT_BRAM_ID:     src_addr = BRAM_CTRL_FFT_ADDR; break;
-	case NTT_MSG_BRAM_ID: src_addr = BRAM_CTRL_MSG_ADDR; break;
-	case NTT_V_BRAM_ID:   src_addr = BRAM_CTRL_V_ADDR;   break;
-	case NTT_KEY_BRAM_ID: src_addr = BRAM_CTRL_KEY_ADDR; break;
+	case FFT_BRAM_ID:
+	{
+		src_addr = BRAM_CTRL_FFT_ADDR;
+		axi_address_base[0] = plaintext_format_bits;
+		break;
+	}
+	case NTT_MSG_BRAM_ID: src_addr = BRAM_CTRL_MSG_ADDR;   break;
+	case NTT_V_BRAM_ID:   src_addr = BRAM_CTRL_V_ADDR;     break;
+	case NTT_KEY_BRAM_ID: src_addr = BRAM_CTRL_KEY_ADDR;   break;
+	case NTT_E1_BRAM_ID:  src_addr = BRAM_CTRL_E1_ADDR;    break;
+	case FFT_IM_BRAM_ID:  src_addr = BRAM_CTRL_IM_ADDR;    break;
+	case ERROR_BRAM_ID:   src_addr = BRAM_CTRL_ERROR_ADDR; break;
 	default:
 		return;
 	}
-	cdma_transaction(dest_addr | 0x80000000, src_addr, num_bytes, 0);
+	CACHE_FLUSH(dest_addr, num_bytes);
+	pending_invalidate_addr = dest_addr;
+	pending_invalidate_bytes = num_bytes;
+	cdmaChain(src_addr, dest_addr, num_bytes, 0);
 }
 
 // computes and returns the bit-reverse of x.
@@ -182,6 +302,29 @@ void send64(uint64_t *p, uint32_t num_words, uint32_t INS_flag, uint32_t bram_se
 	axi_address_base[0] = 0;
 }
 
+// This function loads a program of num_words instructions (at most
+// INS_BUFFER_SIZE) into the instruction memory. The program is copied to a
+// staging buffer of the DMA pool (see dmaStagingBuffer) and loaded by a single
+// DMA burst (see cdmaDDRtoInstructions) instead of four AXI-Lite writes per
+// instruction. It waits for a pending DMA transfer first. Without
+// INS_UPLOAD_DMA or a staging buffer, or for more than DMA_STAGING_WORDS
+// words, send64 is used.
+void sendInstructions(uint64_t *p, uint32_t num_words)
+{
+#if INS_UPLOAD_DMA
+	uint64_t* staging = num_words <= DMA_STAGING_WORDS ? dmaStagingBuffer() : NULL;
+	if(staging)
+	{
+		for(uint32_t i = 0; i < num_words; ++i)
+			staging[i] = p[i];
+		cdmaWaitForIdle();
+		cdmaDDRtoInstructions((size_t)staging, num_words);
+		return;
+	}
+#endif
+	send64(p, num_words, 1, 0);
+}
+
 void send64Expand(uint64_t *p, uint32_t num_words, uint32_t INS_flag, uint32_t bram_sel, uint8_t current_n)
 {
 	uint32_t i;
@@ -204,6 +347,67 @@ void send64Expand(uint64_t *p, uint32_t num_words, uint32_t INS_flag, uint32_t b
 	}
 	axi_address_base[0] = 0;
 }
+// Selects the plaintext format (PT_FORMAT_*) of all following transfers of
+// the Complex BRAM via DMA and send64ExpandPacked. frac_bits (0..31) is the
+// number of fractional bits of PT_FORMAT_FIXED32. The hardware converts
+// to and from doubles, so packed formats halve the plaintext transfers.
+void setPlaintextFormat(uint8_t format, uint8_t frac_bits)
+{
+	plaintext_format = format;
+	plaintext_format_bits = (((uint32_t)format & 0x3) << 20) | (((uint32_t)frac_bits & 0x1f) << 22);
+}
+
+// Selects sparse packing for all following programs: the FFTs, expand and
+// project run on N>>sparse_shift (at least 2^13) coefficients, RNS places
+// FFT coefficient j at position j<<sparse_shift and I2F converts these
+// positions only. 0 selects the full packing.
+void setSparseShift(uint8_t sparse_shift)
+{
+	sparse_shift_bits = ((uint32_t)sparse_shift & 0x3) << 2;
+}
+
+// Selects the region of the key BRAM the PWM of all following programs reads
+// pk0 (or c1 in the decryption) from. The key BRAM holds
+// 2^(15+KEY_STORE_LOG_POLYS)/N regions of N coefficients (see
+// cdmaDDRtoKeyRegion). The PWM writes its result to region 0, hence the
+// other regions keep their content across programs.
+void setPk0Region(uint8_t region)
+{
+	pk0_region_bits = ((uint32_t)region & 0xf) << 4;
+}
+
+// Returns the number of bytes of a plaintext (poly_size/2 complex values)
+// in the selected format.
+uint32_t plaintextBytes(uint32_t poly_size)
+{
+	return plaintext_format == PT_FORMAT_DOUBLE ? poly_size*sizeof(uint64_t) : poly_size/2*sizeof(uint64_t);
+}
+
+// This function sends num_values many complex values in the packed plaintext
+// format selected by setPlaintextFormat to the Complex BRAM with expand.
+// It is the counterpart of send64Expand for packed formats, i.e., p holds one
+// complex value per 64-bit word. Sending data via this function is for testing
+// purpose only. The hardware must have the PROVIDE_DEBUG_IO set to 1 (ComputeCore.v).
+void send64ExpandPacked(uint64_t *p, uint32_t num_values, uint8_t current_n)
+{
+	uint32_t i;
+
+	uint32_t control_low;
+	const uint32_t control_low_const_part = (FFT_BRAM_EXPAND_ID << 29) | (((uint32_t)current_n) << 27) | plaintext_format_bits | (1<<18) | (1<<16);
+
+	for(i=0; i<num_values; i++)
+	{
+		control_low = control_low_const_part | i;
+
+		*(uint64_t*)&(axi_address_base[2]) = p[i];
+		axi_address_base[0] = control_low;
+
+		control_low &= ~(1<<16);
+		axi_address_base[0] = control_low;
+	}
+	axi_address_base[0] = 0;
+}
+
 // This function receives num_words many 64-bit words from the co-processor.
 // It is used for receiving data from BRAMs with bram_sel defining the desitination BRAM. 
 // Receiving data via this function is for testing purpose only. The hardware must
@@ -235,6 +439,23 @@ void receive64(uint64_t *p, uint32_t num_words, uint32_t bram_sel)
   axi_address_base[0] = 0;
 }
 
+// This function receives num_words many 64-bit words from the BRAM bram_sel like
+// receive64, but via DMA and without PROVIDE_DEBUG_IO (ComputeCore.v): every
+// BRAM except the Complex BRAM has a DMA window. The Complex BRAM is read
+// by receive64. p must be a DMA buffer (see dmaPool.c). Blocks until the
+// words are received.
+void receive64DMA(uint64_t *p, uint32_t num_words, uint32_t bram_sel)
+{
+	if(bram_sel == FFT_BRAM_ID || bram_sel == FFT_BRAM_EXPAND_ID)
+	{
+		receive64(p, num_words, bram_sel);
+		return;
+	}
+	cdmaWaitForIdle();
+	cdmaBRAMtoDDR((size_t)p, bram_sel, num_words*sizeof(uint64_t));
+	cdmaWaitForIdle();
+}
+
 // This computes the index_map[] array containing the indices for reordering
 // during CKKS projection. This function is called once at startup and used
 // for testing purposes only.
@@ -266,9 +487,12 @@ void initIndexMap()
 // This function is used for testing purposes only.
 void receive64Project(uint64_t *p, uint8_t current_n)
 {
-	uint64_t temp_array[1<<(13+current_n)];
+	uint64_t* temp_array = dmaPolyAlloc(current_n);
+	if(!temp_array)
+		return;
 	receive64(temp_array, 1<<(13+current_n), FFT_BRAM_ID);
 	swProject(p, temp_array, current_n);
+	dmaPolyFree(temp_array, current_n);
 }
 
 // This function takes the polynomial input with POLY_SIZE elements and
@@ -298,6 +522,64 @@ void swProject(uint64_t* result, uint64_t* input, uint8_t current_n)
 }
 
 
+// This function reads the execution trace of the last program from the co-processor.
+// Each entry has the layout
+// {IR index[63:60], opcode[59:57], OP1[56:55], valid[54], start cycle[53:27], end cycle[26:0]}
+// At most INS_TRACE_SIZE entries are stored at *entries. The number of valid
+// entries is returned.
+uint32_t receiveTrace(uint64_t *entries)
+{
+	uint32_t i;
+	uint32_t num_entries = 0;
+	uint32_t dina_low, dina_high;
+
+	for(i=0; i<INS_TRACE_SIZE; i++)
+	{
+		axi_address_base[0] = (1<<19) + i;
+		dina_low = axi_address_base[4];
+		dina_high = axi_address_base[5];
+
+		entries[i] = ((uint64_t)dina_high << 32) | dina_low;
+		if(entries[i] & (1ull<<54))
+			num_entries++;
+	}
+	axi_address_base[0] = 0;
+	return num_entries;
+}
+
+// This function prints the execution trace of the last program with one
+// line per instruction in the format
+// TRACE,<program>,<IR index>,<opcode>,<OP1[1:0]>,<start cycle>,<end cycle>
+// The output can be converted by Aloha-HE_Host/traceToChrome.
+void printTrace()
+{
+	static uint32_t program = 0;
+	uint64_t entries[INS_TRACE_SIZE];
+	uint32_t num_entries = receiveTrace(entries);
+
+	for(uint32_t i=0; i<num_entries; i++)
+	{
+		printf("TRACE,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n", program,
+			(uint32_t)(entries[i] >> 60) & 0xF,
+			(uint32_t)(entries[i] >> 57) & 0x7,
+			(uint32_t)(entries[i] >> 55) & 0x3,
+			(uint32_t)(entries[i] >> 27) & 0x7FFFFFF,
+			(uint32_t)entries[i] & 0x7FFFFFF);
+	}
+	program++;
+}
+
+// co-processor clock cycles of all programs executed so far
+static uint64_t coproc_cycles = 0;
+
+// Returns the number of co-processor clock cycles spent in all programs
+// executed since startup. Together with the elapsed CPU time, this gives
+// the compute time in the co-processor clock domain.
+uint64_t coprocCycles()
+{
+	return coproc_cycles;
+}
+
 // This function starts the execution of the instruction memory's content.
 // It blocks until all instructions are finished and resets the co-processor
 // after it has finished. The function returns the number of clock cycles
@@ -314,6 +596,7 @@ uint32_t exeIns()
 	// status             (axi_address_base[6])
 
 	uint32_t cycle_count = 0;
+	uint32_t status;
 
 	// Reset Processor
 	// control_low = 0; control_high=1;
@@ -321,13 +604,16 @@ uint32_t exeIns()
 	axi_address_base[1] = 1;
 
 
-	// control_high=2;
-	axi_address_base[1] = 2;
+	// control_high=2; (bits 3:2 select sparse packing, bits 7:4 the pk0 region)
+	axi_address_base[1] = 2 | sparse_shift_bits | pk0_region_bits;
 
 
-	while((axi_address_base[6] & 0x1) == 0){
+	while(((status = axi_address_base[6]) & 0x1) == 0){
 	}
 
+	// the last poll already holds the final cycle count, so counting does not
+	// cost an additional AXI read
+	coproc_cycles += (status>>2);
 
 #ifndef PERFORMANCE
 	cycle_count = (uint32_t) axi_address_base[6];
@@ -344,6 +630,7 @@ uint32_t exeIns()
 	// control_high=0;
 	axi_address_base[1] = 0;
 
+	if(TRACE) printTrace();
 
 	return cycle_count;
 }
@@ -357,7 +644,7 @@ uint32_t exeInsWithParameter(uint64_t param)
 }
 
 uint32_t delay(uint32_t d){
-	uint32_t i, j;
+	uint32_t i, j = 0;
 
 	for(i=0; i<d; i++)
 		j += i;
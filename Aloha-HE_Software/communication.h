@@ -16,18 +16,79 @@
 #define FFT_BRAM_EXPAND_ID  6	// Complex BRAM with expand when writing to it
 #define FFT_IM_BRAM_ID      7	// "Imag BRAM" (imaginary parts of complex BRAM)
 
+// Plaintext formats of the Complex BRAM DMA and of send64ExpandPacked.
+// This must comply with hardware (see PT_FORMAT_* in CommonDefinitions.vh).
+// Except for double, a 64-bit word holds one complex value with the real
+// part in the lower and the imaginary part in the upper 32 bits.
+#define PT_FORMAT_DOUBLE    0	// two 64-bit words (double) per complex value
+#define PT_FORMAT_FLOAT32   1	// IEEE-754 single precision
+#define PT_FORMAT_FIXED32   2	// int32 with frac_bits fractional bits
+
+// The key BRAM holds 2^KEY_STORE_LOG_POLYS polynomials of 2^15 coefficients.
+// This must comply with hardware (see CommonDefinitions.vh).
+#define KEY_STORE_LOG_POLYS 0
+
+// Constants cache (twiddle factor cache and RNS constants, see FFTTw_RNS_ROM.v):
+// lines of 128 bits and NTT constant slots (constants_sel). An RNS slot has
+// RNS_CONSTANT_LINES lines, a pair of NTT slots NTT_CONSTANT_LINES lines from
+// NTT_CONSTANTS_BASE.
+#define CONSTANTS_CACHE_LINES 1024
+#define NTT_CONSTANT_SLOTS    18
+#define RNS_CONSTANT_LINES    16
+#define NTT_CONSTANTS_BASE    256
+#define NTT_CONSTANT_LINES    71
+
+// CDMA registers (AXI CDMA, simple mode):
+#define CDMACR   0x0	//CDMA control register
+#define CDMASR   0x4	//CDMA status register
+#define CDMA_SA  0x18  	//CDMA source address register
+#define CDMA_DA  0x20  	//CDMA destination address register
+#define CDMA_BTT 0x28  	//CDMA bytes to transfer. Writing to this initiates the transaction
+
+// AXI addresses of the BRAMs in the address space of the CDMA, one window of
+// 2^15 words per BRAM. This must comply with hardware (see dma_bram_sel in
+// ComputeCore.v).
+#define BRAM_CTRL_AXI_BASE     0xC0000000
+#define BRAM_CTRL_WINDOW_BYTES ((1<<15)*sizeof(uint64_t))
+#define BRAM_CTRL_WINDOWS      8
+#define BRAM_CTRL_MSG_ADDR (BRAM_CTRL_AXI_BASE + 0*BRAM_CTRL_WINDOW_BYTES)
+#define BRAM_CTRL_KEY_ADDR (BRAM_CTRL_AXI_BASE + 1*BRAM_CTRL_WINDOW_BYTES)
+#define BRAM_CTRL_V_ADDR   (BRAM_CTRL_AXI_BASE + 2*BRAM_CTRL_WINDOW_BYTES)
+#define BRAM_CTRL_FFT_ADDR (BRAM_CTRL_AXI_BASE + 3*BRAM_CTRL_WINDOW_BYTES)
+// read-only windows
+#define BRAM_CTRL_E1_ADDR    (BRAM_CTRL_AXI_BASE + 4*BRAM_CTRL_WINDOW_BYTES)
+#define BRAM_CTRL_IM_ADDR    (BRAM_CTRL_AXI_BASE + 5*BRAM_CTRL_WINDOW_BYTES)
+#define BRAM_CTRL_ERROR_ADDR (BRAM_CTRL_AXI_BASE + 6*BRAM_CTRL_WINDOW_BYTES)
+
+// Number of entries of the execution trace (see ISA_control.v)
+#define INS_TRACE_SIZE      16
+
 void send64(uint64_t *p, uint32_t num_words, uint32_t INS_flag, uint32_t bram_sel);
+void sendInstructions(uint64_t *p, uint32_t num_words);
 void send64Expand(uint64_t *p, uint32_t num_words, uint32_t INS_flag, uint32_t bram_sel, uint8_t current_n);
+void send64ExpandPacked(uint64_t *p, uint32_t num_values, uint8_t current_n);
+void setPlaintextFormat(uint8_t format, uint8_t frac_bits);
+void setSparseShift(uint8_t sparse_shift);
+void setPk0Region(uint8_t region);
+uint32_t plaintextBytes(uint32_t poly_size);
 void receive64(uint64_t *p, uint32_t num_words, uint32_t bram_sel);
+void receive64DMA(uint64_t *p, uint32_t num_words, uint32_t bram_sel);
 void receive64Project(uint64_t *p, uint8_t current_n);
 void swProject(uint64_t* result, uint64_t* input, uint8_t current_n);
 
 void cdmaWaitForIdle();
 void cdmaDDRtoBRAM(size_t dest_bram_id, size_t source_addr, uint32_t num_bytes, uint8_t current_n);
+void cdmaDDRtoKeyRegion(size_t source_addr, uint32_t num_bytes, uint32_t region);
+void cdmaDDRtoConstants(size_t source_addr, uint32_t first_line, uint32_t num_lines);
+void cdmaDDRtoInstructions(size_t source_addr, uint32_t num_words);
 void cdmaBRAMtoDDR(size_t dest_addr, size_t source_bram_id, uint32_t num_bytes);
 
+uint32_t receiveTrace(uint64_t *entries);
+void printTrace();
+
 uint32_t exeIns();
 uint32_t exeInsWithParameter(uint64_t param);
+uint64_t coprocCycles();
 
 uint32_t delay(uint32_t d);
 
@@ -0,0 +1,130 @@
+/*********************************************
+ * Pool of DMA buffers for polynomials. Each
+ * buffer belongs to a size class (a power of
+ * two from 2^13 to 2^16 words) and is aligned
+ * to 32 KB. Freed buffers are kept in a free
+ * list per class and handed out again, so
+ * the hot path neither allocates on the stack
+ * nor fragments the arena.
+ *
+ * On the board, the buffers are carved from a
+ * static arena of DMA_POOL_BYTES in DDR. On
+ * Linux, they come from the hugepages of
+ * linuxDmaAlloc (see linuxDevice.c).
+ *
+ * The cache maintenance of the DMA transfers
+ * is done by communication.c on the
+ * transferred bytes only.
+*********************************************/
+
+#include <stddef.h>
+#include "dmaPool.h"
+#ifdef __linux__
+#include "linuxDevice.h"
+#endif
+
+#define DMA_POOL_ALIGNMENT (1<<15)
+
+// Free buffers of each class. The first word of a free buffer links to the
+// next free buffer of its class.
+static uint64_t* free_lists[DMA_POOL_CLASSES];
+
+#ifndef __linux__
+static uint8_t arena[DMA_POOL_BYTES] __attribute__((aligned(DMA_POOL_ALIGNMENT)));
+static size_t arena_used;
+static uint64_t staging[DMA_STAGING_WORDS] __attribute__((aligned(64)));
+#else
+static uint64_t* staging;
+#endif
+
+// Returns the size class of num_words or -1 if it exceeds the largest class.
+static int sizeClass(uint32_t num_words)
+{
+	for(int i = 0; i < DMA_POOL_CLASSES; ++i)
+		if(num_words <= (1u << (DMA_POOL_LOG_MIN_WORDS + i)))
+			return i;
+	return -1;
+}
+
+// Takes a new buffer of num_bytes from the arena, NULL if it is exhausted.
+static uint64_t* arenaAlloc(size_t num_bytes)
+{
+#ifdef __linux__
+	return (uint64_t*)linuxDmaAlloc(num_bytes);
+#else
+	if(num_bytes > DMA_POOL_BYTES - arena_used)
+		return NULL;
+	uint64_t* p = (uint64_t*)(arena + arena_used);
+	arena_used += (num_bytes + DMA_POOL_ALIGNMENT - 1) / DMA_POOL_ALIGNMENT * DMA_POOL_ALIGNMENT;
+	return p;
+#endif
+}
+
+// Returns a DMA buffer of at least num_words 64-bit words (up to 2^16),
+// aligned to 32 KB, or NULL if the pool is exhausted. The content is
+// undefined.
+uint64_t* dmaPoolAlloc(uint32_t num_words)
+{
+	int c = sizeClass(num_words);
+	uint64_t* p;
+
+	if(c < 0)
+		return NULL;
+	p = free_lists[c];
+	if(p)
+	{
+		free_lists[c] = (uint64_t*)(size_t)p[0];
+		return p;
+	}
+	return arenaAlloc((size_t)sizeof(uint64_t) << (DMA_POOL_LOG_MIN_WORDS + c));
+}
+
+// Returns the buffer p of dmaPoolAlloc(num_words) to the pool.
+void dmaPoolFree(uint64_t* p, uint32_t num_words)
+{
+	int c = sizeClass(num_words);
+
+	if(!p || c < 0)
+		return;
+	p[0] = (uint64_t)(size_t)free_lists[c];
+	free_lists[c] = p;
+}
+
+// Returns a DMA buffer for a polynomial of N=2^(13+current_n) coefficients.
+uint64_t* dmaPolyAlloc(uint8_t current_n)
+{
+	return dmaPoolAlloc(1u << (13+current_n));
+}
+
+void dmaPolyFree(uint64_t* p, uint8_t current_n)
+{
+	dmaPoolFree(p, 1u << (13+current_n));
+}
+
+// Returns all buffers to the arena, e.g., when the Linux DMA buffers are
+// unmapped (see linuxDeviceClose). Buffers allocated before must not be used
+// anymore.
+void dmaPoolReset()
+{
+	for(int i = 0; i < DMA_POOL_CLASSES; ++i)
+		free_lists[i] = NULL;
+#ifdef __linux__
+	staging = NULL;
+#else
+	arena_used = 0;
+#endif
+}
+
+// Returns the persistent DMA buffer of DMA_STAGING_WORDS words for small
+// transfers, e.g., the instruction uploads of sendInstructions, or NULL if no
+// DMA buffer is left. It is reused by every call, so a small transfer does not
+// take a buffer of the smallest size class. On Linux, it is allocated by the
+// first call after the DMA buffers are mapped.
+uint64_t* dmaStagingBuffer()
+{
+#ifdef __linux__
+	if(!staging)
+		staging = (uint64_t*)linuxDmaAlloc(DMA_STAGING_WORDS*sizeof(uint64_t));
+#endif
+	return staging;
+}
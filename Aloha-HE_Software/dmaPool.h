@@ -0,0 +1,25 @@
+#ifndef SRC_DMA_POOL_H_
+#define SRC_DMA_POOL_H_
+
+#include <stdint.h>
+
+// Size classes of the pool: 2^(DMA_POOL_LOG_MIN_WORDS+i) words for
+// i < DMA_POOL_CLASSES, i.e., a polynomial of N=2^13..2^15 and the complex
+// (2N-word) buffer of N=2^15.
+#define DMA_POOL_LOG_MIN_WORDS  13
+#define DMA_POOL_CLASSES        4
+
+// Bytes of the arena on the board (see dmaPool.c)
+#define DMA_POOL_BYTES          (8<<20)
+
+// Words of the staging buffer for small transfers (see dmaStagingBuffer)
+#define DMA_STAGING_WORDS       16
+
+uint64_t* dmaPoolAlloc(uint32_t num_words);
+void dmaPoolFree(uint64_t* p, uint32_t num_words);
+uint64_t* dmaPolyAlloc(uint8_t current_n);
+void dmaPolyFree(uint64_t* p, uint8_t current_n);
+void dmaPoolReset();
+uint64_t* dmaStagingBuffer();
+
+#endif /* SRC_DMA_POOL_H_ */
@@ -0,0 +1,124 @@
+/*********************************************
+ * Precomputation of the four-step NTT for
+ * N = 2^16 = 2 * 2^15 (see ckks_ntt_four_step).
+ *
+ * With psi a primitive 2^17-th root of unity
+ * modulo q and i = psi^(2^15), a square root
+ * of -1, the forward transform of a polynomial
+ * a with the halves lo = a[0..2^15-1] and
+ * hi = a[2^15..2^16-1] is:
+ * 1. Column step and twist: coefficient j of
+ *    tile 0 is (lo + i*hi)*psi^-j, i.e.,
+ *    a mod (X^(2^15) - i) mapped to Y^(2^15) + 1,
+ *    and of tile 1 (lo - i*hi)*psi^j.
+ * 2. Row step: the 2^15-point NTT of each
+ *    tile with root psi^2.
+ * Tile k is then block k of the 2^16-point NTT
+ * in the order of the hardware, i.e.,
+ * a^_j = a(psi^(2BR(j)+1)). The inverse runs
+ * the inverse 2^15-point NTTs t0 and t1 of the
+ * tiles (scaled by 2^-15) and then
+ *   lo = (t0*psi^j + t1*psi^-j)/2
+ *   hi = -i*(t0*psi^j - t1*psi^-j)/2.
+ *
+ * Each tile of step 1 and each half of the
+ * inverse is the sum of two coefficient-wise
+ * products, which the accelerator computes
+ * with two PWMs (c + a*b*R^-1). This file
+ * computes the factors b (times R = 2^72) on
+ * the CPU, once per modulus.
+ *
+ * The dataflow is validated with the tile
+ * NTTs of the reference model by
+ * Aloha-HE_Host/fourStepNtt.
+*********************************************/
+
+#include "fourStep.h"
+
+#define MONT_LOG_R 72
+
+// Returns a*b mod q for q < 2^62. Without 128-bit arithmetic (MicroBlaze),
+// it doubles and adds bit by bit.
+static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t q)
+{
+#ifdef __SIZEOF_INT128__
+	return (uint64_t)((unsigned __int128)a * b % q);
+#else
+	uint64_t r = 0;
+	for(int i = 63; i >= 0; --i)
+	{
+		r <<= 1;
+		if(r >= q)
+			r -= q;
+		if((b >> i) & 1)
+		{
+			r += a;
+			if(r >= q)
+				r -= q;
+		}
+	}
+	return r;
+#endif
+}
+
+static uint64_t powMod(uint64_t a, uint64_t e, uint64_t q)
+{
+	uint64_t r = 1;
+	for(; e; e >>= 1, a = mulMod(a, a, q))
+		if(e & 1)
+			r = mulMod(r, a, q);
+	return r;
+}
+
+// Returns a/2 mod q for odd q
+static uint64_t halfMod(uint64_t a, uint64_t q)
+{
+	return (a & 1) ? (a + q) >> 1 : a >> 1;
+}
+
+static uint64_t negMod(uint64_t a, uint64_t q)
+{
+	return a ? q - a : 0;
+}
+
+// Returns 1 if psi is a primitive 2N-th root of unity modulo q (N = 2^16)
+// whose square is the root of the 2^15-point transform of the tiles.
+// tile_root is constant 0 of the NTT constants slot of the tiles, i.e., the
+// root times R mod q, of the inverse root if inverse.
+int fourStepCheckRoot(uint64_t psi, uint64_t q, uint64_t tile_root, uint8_t inverse)
+{
+	uint64_t root = mulMod(psi, psi, q);
+
+	if(psi >= q || powMod(psi, 1ull << FOUR_STEP_LOG_N, q) != q - 1)
+		return 0;
+	if(inverse)
+		root = powMod(root, q - 2, q);
+	return mulMod(root, powMod(2, MONT_LOG_R, q), q) == tile_root;
+}
+
+// Fills the FOUR_STEP_TWIDDLE_POLYS polynomials of FOUR_STEP_TILE_SIZE words
+// (see fourStep.h) for the root psi. It takes four modular multiplications
+// per coefficient.
+void fourStepTwiddles(uint64_t** twiddles, uint64_t psi, uint64_t q)
+{
+	uint64_t i_root = powMod(psi, FOUR_STEP_TILE_SIZE, q);
+	uint64_t psi_inv = powMod(psi, (2ull << FOUR_STEP_LOG_N) - 1, q);
+	uint64_t w = powMod(2, MONT_LOG_R, q), w_inv = w; // psi^j*R and psi^-j*R
+
+	for(uint32_t j = 0; j < FOUR_STEP_TILE_SIZE; ++j)
+	{
+		uint64_t i_w = mulMod(w, i_root, q), i_w_inv = mulMod(w_inv, i_root, q);
+
+		twiddles[FOUR_STEP_FWD_LO(0)][j] = w_inv;
+		twiddles[FOUR_STEP_FWD_HI(0)][j] = i_w_inv;
+		twiddles[FOUR_STEP_FWD_LO(1)][j] = w;
+		twiddles[FOUR_STEP_FWD_HI(1)][j] = negMod(i_w, q);
+		twiddles[FOUR_STEP_INV_T0(0)][j] = halfMod(w, q);
+		twiddles[FOUR_STEP_INV_T1(0)][j] = halfMod(w_inv, q);
+		twiddles[FOUR_STEP_INV_T0(1)][j] = halfMod(negMod(i_w, q), q);
+		twiddles[FOUR_STEP_INV_T1(1)][j] = halfMod(i_w_inv, q);
+		twiddles[FOUR_STEP_ZERO][j] = 0;
+		w = mulMod(w, psi, q);
+		w_inv = mulMod(w_inv, psi_inv, q);
+	}
+}
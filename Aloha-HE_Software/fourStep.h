@@ -0,0 +1,29 @@
+#ifndef SRC_FOUR_STEP_H_
+#define SRC_FOUR_STEP_H_
+
+#include <stdint.h>
+
+// Four-step NTT of N = 2^16 coefficients with two tiles of 2^15 coefficients
+// (see fourStep.c and ckks_ntt_four_step). The tiles are transformed by the
+// regular instructions of N = 2^15 (FOUR_STEP_TILE_CURRENT_N).
+#define FOUR_STEP_LOG_N          16
+#define FOUR_STEP_TILE_SIZE      (1u << (FOUR_STEP_LOG_N-1))
+#define FOUR_STEP_TILE_CURRENT_N 2
+
+// Twiddle polynomials of fourStepTwiddles, FOUR_STEP_TILE_SIZE words each in
+// Montgomery form. With the halves lo and hi of the input, tile k of the
+// forward transform is lo*FWD_LO(k) + hi*FWD_HI(k) (before its 2^15-point
+// NTT). With the inverse 2^15-point NTTs t0 and t1 of the tiles, half k of the
+// inverse transform is t0*INV_T0(k) + t1*INV_T1(k). FOUR_STEP_ZERO is the zero
+// polynomial the first product is added to.
+#define FOUR_STEP_FWD_LO(k)      (2*(k))
+#define FOUR_STEP_FWD_HI(k)      (2*(k) + 1)
+#define FOUR_STEP_INV_T0(k)      (4 + 2*(k))
+#define FOUR_STEP_INV_T1(k)      (5 + 2*(k))
+#define FOUR_STEP_ZERO           8
+#define FOUR_STEP_TWIDDLE_POLYS  9
+
+int fourStepCheckRoot(uint64_t psi, uint64_t q, uint64_t tile_root, uint8_t inverse);
+void fourStepTwiddles(uint64_t** twiddles, uint64_t psi, uint64_t q);
+
+#endif /* SRC_FOUR_STEP_H_ */
@@ -16,6 +16,7 @@
 #define OPC_I2F            (3)
 #define OPC_PWM            (4)
 #define OPC_PROJECT		   (5)
+#define OPC_AUTOMORPHISM   (6)
 
 // Switch this for debug functionality:
 //#define assert(x) while(!(x)) { printf("ERROR: Assertion violation!\n"); }
@@ -43,6 +44,7 @@ uint64_t getNTTTransformationInstructionWord(uint8_t isDIF, uint8_t log_q, uint8
 	assert(log_q < (1<<4));
 	assert(modulus_rom_index < 18);
 	assert(qm < (1<<17));
+	assert(current_n <= CURRENT_N_MAX_BRAM);
 	qm = (-qm) & ((1<<17) - 1);
 	return (1ull<<42) | ((uint64_t)current_n << 40) | ((modulus_rom_index&0x10)<<26) | (qm<<13) | ((modulus_rom_index&0xf)<<9) | (log_q<<5) | (isDIF<<3) | OPC_TRANSFORMATION;
 }
@@ -101,12 +103,70 @@ uint64_t getPWMInstructionWord(uint8_t log_q, uint32_t qm, uint8_t current_n)
 	return (1ull<<42) | ((uint64_t)current_n << 40) | (qm<<13) | (log_q<<5) | OPC_PWM;
 }
 
+// Returns an instruction word to perform a forward NTT directly followed by the
+// PWM of the encryption (fused NTT+PWM). The PWM starts as soon as the last NTT
+// stage is written back, without an instruction turnaround in between.
+// @param log_q: Defines bit-width of modulus q.
+//				 A value of 0 corresponds to 46-bit modulus, 1 -> 47-bit, ..., 8 -> 54-bit modulus
+// @param modulus_rom_index: Offset of the twiddle factors within the modulus ROM (Twiddle factor cache)
+// @param qm: The 17-bit value of the modulus q = 2^(log_q[i]+46) - (qm << 24) + 1
+uint64_t getNTTPWMInstructionWord(uint8_t log_q, uint8_t modulus_rom_index, uint32_t qm, uint8_t current_n)
+{
+	return getNTTTransformationInstructionWord(0, log_q, modulus_rom_index, qm, current_n) | (1ull<<33);
+}
+
+// Returns an instruction word to perform an inverse NTT whose results are converted to
+// floating point on their write-back (fused INTT+I2F). The FFT BRAM holds the I2F result
+// as soon as the inverse NTT is done.
+// @param log_scale: The log2 of the scale (Delta) each input operand is divided by
+// @param log_q: Defines bit-width of modulus q.
+//				 A value of 0 corresponds to 46-bit modulus, 1 -> 47-bit, ..., 8 -> 54-bit modulus
+// @param modulus_rom_index: Offset of the inverse twiddle factors within the modulus ROM (Twiddle factor cache)
+// @param qm: The 17-bit value of the modulus q = 2^(log_q[i]+46) - (qm << 24) + 1
+uint64_t getINTTI2FInstructionWord(int16_t log_scale, uint8_t log_q, uint8_t modulus_rom_index, uint32_t qm, uint8_t current_n)
+{
+	assert(modulus_rom_index < 18);
+	return getI2FInstructionWord(log_scale, log_q, qm, current_n) | (1ull<<39) | ((uint64_t)(modulus_rom_index&0x10)<<34) | ((modulus_rom_index&0xf)<<9);
+}
+
+// Returns an instruction word to perform an inverse FFT whose last stage writes its
+// results to the projected positions (fused IFFT+Project).
+uint64_t getIFFTProjectInstructionWord(uint8_t current_n)
+{
+	return getFFTTransformationInstructionWord(0, current_n) | (1ull<<33);
+}
+
 // Returns an instruction word to perform Projection
 uint64_t getProjectInstructionWord(uint8_t current_n)
 {
 	return (1ull<<42) | ((uint64_t)current_n << 40) | OPC_PROJECT;
 }
 
+// Returns an instruction word to perform the automorphism X -> X^galois of the
+// polynomial in the message BRAM. The result is written to the key BRAM.
+// @param galois: The Galois element, odd and smaller than 2N (e.g., 3^r mod 2N
+//				  rotates the slots by r, 2N-1 conjugates them)
+// @param ntt_domain: 1: the polynomial is in the NTT domain (permutation only)
+//					  0: the polynomial is in the coefficient domain (X^N = -1)
+// @param log_q, qm: The modulus, only used in the coefficient domain
+uint64_t getAutomorphismInstructionWord(uint32_t galois, uint8_t ntt_domain, uint8_t log_q, uint32_t qm, uint8_t current_n)
+{
+	assert(galois & 1);
+	assert(galois < (2u<<(13+current_n)));
+	assert(log_q < (1<<4));
+	assert(qm < (1<<17));
+
+	uint64_t galois_half = galois >> 1;
+	uint64_t galois_high, galois_mid, galois_low;
+	galois_high = galois_half >> 8;          // OP4[6:0]
+	galois_mid  = (galois_half >> 1) & 0x7f; // {OP1[9:6], OP3[9:7]}
+	galois_low  = galois_half & 0x1;         // OP1[1]
+
+	qm = (-qm) & ((1<<17) - 1);
+	return (1ull<<42) | ((uint64_t)current_n << 40) | (galois_high<<33) | ((galois_mid>>3)<<9) | ((galois_mid&0x7)<<30) |
+			(qm<<13) | (log_q<<5) | (galois_low<<4) | (ntt_domain<<3) | OPC_AUTOMORPHISM;
+}
+
 // This function gets ins_words, an array of num_instructions many instruction words
 // and prepares the array ins_buffer with INS_BUFFER_SIZE elements to be sent to the
 // co-processor. It essentially adds instructions to reset the co-processor.
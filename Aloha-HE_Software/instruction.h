@@ -1,15 +1,26 @@
 #ifndef SRC_INSTRUCTION_H_
 #define SRC_INSTRUCTION_H_
 
+#include <stdint.h>
+
 // Number of max number of instructions in the buffer.
 #define INS_BUFFER_SIZE 16
 
+// Ring size N = 2^(13+current_n). The instructions encode current_n up to
+// CURRENT_N_MAX_BRAM (whole polynomials in the BRAMs). ckks_ntt_four_step
+// transforms N = 2^16 as two tiles with the instructions of N = 2^15.
+#define CURRENT_N_MAX_BRAM 2
+
 uint64_t getFFTTransformationInstructionWord(uint8_t isDIF, uint8_t current_n);
 uint64_t getNTTTransformationInstructionWord(uint8_t isDIF, uint8_t log_q, uint8_t modulus_rom_index, uint32_t qm, uint8_t current_n);
 uint64_t getRNSInstructionWord(uint16_t log_scale, uint8_t log_q, uint8_t modulus_rom_index, uint32_t qm, uint8_t current_n);
 uint64_t getI2FInstructionWord(int16_t log_scale, uint8_t log_q, uint32_t qm, uint8_t current_n);
 uint64_t getPWMInstructionWord(uint8_t log_q, uint32_t qm, uint8_t current_n);
+uint64_t getNTTPWMInstructionWord(uint8_t log_q, uint8_t modulus_rom_index, uint32_t qm, uint8_t current_n);
+uint64_t getINTTI2FInstructionWord(int16_t log_scale, uint8_t log_q, uint8_t modulus_rom_index, uint32_t qm, uint8_t current_n);
+uint64_t getIFFTProjectInstructionWord(uint8_t current_n);
 uint64_t getProjectInstructionWord(uint8_t current_n);
+uint64_t getAutomorphismInstructionWord(uint32_t galois, uint8_t ntt_domain, uint8_t log_q, uint32_t qm, uint8_t current_n);
 void initInsBuffer(uint64_t* ins_buffer, uint64_t* ins_words, uint8_t num_instructions);
 
 #endif /* SRC_INSTRUCTION_H_ */
@@ -0,0 +1,387 @@
+/*********************************************
+ * Linux userspace backend of communication.c.
+ * The register windows of the AXI slave
+ * (AXISlave8Ports) and of the CDMA are mapped
+ * through UIO. Plaintexts, keys and
+ * ciphertexts live in hugepages that are
+ * physically contiguous, so the CDMA reads
+ * and writes them in place. A buffer across
+ * hugepages is transferred in physically
+ * contiguous chunks (see cdmaChain).
+ *
+ * If the register windows are regular files
+ * instead of UIO devices, a fake device is
+ * used: the CDMA copies between the DMA
+ * buffers and BRAM images in memory and every
+ * program finishes immediately. It runs on
+ * any Linux box and checks that every DMA
+ * address of the driver is a DMA buffer.
+ *
+ * The CDMA has 32-bit addresses, hence the
+ * hugepages must be below 4 GB. It does not
+ * snoop the CPU caches: on AArch64, the
+ * transferred lines are cleaned and
+ * invalidated from userspace. On other CPUs,
+ * the CDMA must be connected to a
+ * cache-coherent port (e.g., the ACP of a
+ * Zynq).
+*********************************************/
+
+#ifdef __linux__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "communication.h"
+#include "linuxDevice.h"
+#include "dmaPool.h"
+
+#define LINUX_WINDOW_BYTES  4096        // mapped bytes of each register window
+#define FAKE_DDR_AXI_BASE   0x80000000  // AXI address of the DMA buffers of the fake device
+#define DMA_ALIGNMENT       (1<<15)     // alignment of linuxDmaAlloc (as the buffers on the board)
+#define MAX_HUGEPAGES       512
+
+volatile uint32_t* axi_address_base;    // AXI slave registers (see exeIns)
+static volatile uint32_t* cdma_base;    // CDMA registers
+
+static int fake_device;
+static uint32_t fake_errors;
+static uint8_t* fake_brams;             // BRAM images of the fake device (BRAM_CTRL_WINDOWS windows)
+
+static uint8_t* dma_base;               // DMA buffers
+static size_t dma_bytes, dma_used;
+static size_t hugepage_bytes;
+static uint64_t hugepage_phys[MAX_HUGEPAGES]; // physical address of each hugepage
+
+// Returns the physical hugepage of the fake device that backs the hugepage i
+// of the DMA buffers (and vice versa).
+static size_t fakePage(size_t i)
+{
+	return (i ^ 1) < dma_bytes/hugepage_bytes ? i ^ 1 : i;
+}
+
+// Maps the first LINUX_WINDOW_BYTES of the UIO device or of the file at path.
+// A regular file is resized and selects the fake device (*is_file = 1).
+static volatile uint32_t* mapWindow(const char* path, int* is_file)
+{
+	struct stat st;
+	void* base;
+	int fd = open(path, O_RDWR | O_SYNC);
+
+	if(fd < 0 || fstat(fd, &st) < 0)
+	{
+		fprintf(stderr, "Cannot open %s\n", path);
+		if(fd >= 0)
+			close(fd);
+		return NULL;
+	}
+	*is_file = S_ISREG(st.st_mode);
+	if(*is_file && st.st_size < LINUX_WINDOW_BYTES && ftruncate(fd, LINUX_WINDOW_BYTES) < 0)
+	{
+		close(fd);
+		return NULL;
+	}
+	base = mmap(NULL, LINUX_WINDOW_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED)
+	{
+		fprintf(stderr, "Cannot map %s\n", path);
+		return NULL;
+	}
+	return (volatile uint32_t*)base;
+}
+
+// Returns the size of the default hugepages in bytes (0 if unknown).
+static size_t defaultHugepageBytes()
+{
+	char line[128];
+	size_t kb = 0;
+	FILE* f = fopen("/proc/meminfo", "r");
+
+	if(!f)
+		return 0;
+	while(fgets(line, sizeof(line), f))
+		if(sscanf(line, "Hugepagesize: %zu kB", &kb) == 1)
+			break;
+	fclose(f);
+	return kb*1024;
+}
+
+// Resolves the physical address of each hugepage of the DMA buffers via
+// /proc/self/pagemap (requires CAP_SYS_ADMIN). Returns 0 on failure.
+static int resolveHugepages()
+{
+	long page_bytes = sysconf(_SC_PAGESIZE);
+	int fd = open("/proc/self/pagemap", O_RDONLY);
+
+	if(fd < 0)
+		return 0;
+	for(size_t i = 0; i < dma_bytes/hugepage_bytes; ++i)
+	{
+		uint64_t entry = 0;
+		off_t offset = (off_t)((size_t)(dma_base + i*hugepage_bytes) / page_bytes * sizeof(uint64_t));
+		if(pread(fd, &entry, sizeof(entry), offset) != sizeof(entry) || !(entry >> 63))
+			break;
+		hugepage_phys[i] = (entry & ((1ull << 55) - 1)) * page_bytes;
+		if(!hugepage_phys[i] || hugepage_phys[i] + hugepage_bytes > (1ull << 32))
+		{
+			fprintf(stderr, "Hugepage %zu is not below 4 GB or its address is hidden (run as root)\n", i);
+			close(fd);
+			return 0;
+		}
+	}
+	close(fd);
+	return 1;
+}
+
+// Maps the register windows and allocates dma_bytes of DMA buffers (rounded up
+// to whole hugepages). regs_path and cdma_path are UIO devices (e.g.,
+// LINUX_REGS_DEVICE and LINUX_CDMA_DEVICE) or, for the fake device, regular
+// files. Returns 0 on failure.
+int linuxDeviceOpen(const char* regs_path, const char* cdma_path, size_t dma_bytes_requested)
+{
+	int regs_is_file, cdma_is_file;
+
+	axi_address_base = mapWindow(regs_path, &regs_is_file);
+	cdma_base = mapWindow(cdma_path, &cdma_is_file);
+	if(!axi_address_base || !cdma_base)
+	{
+		linuxDeviceClose();
+		return 0;
+	}
+	fake_device = regs_is_file && cdma_is_file;
+	if(regs_is_file != cdma_is_file)
+	{
+		fprintf(stderr, "Either both or none of the register windows must be files\n");
+		linuxDeviceClose();
+		return 0;
+	}
+
+	hugepage_bytes = defaultHugepageBytes();
+	if(!hugepage_bytes)
+		hugepage_bytes = 2 << 20;
+	dma_bytes = (dma_bytes_requested + hugepage_bytes - 1) / hugepage_bytes * hugepage_bytes;
+	dma_used = 0;
+	if(dma_bytes / hugepage_bytes > MAX_HUGEPAGES)
+	{
+		fprintf(stderr, "At most %u hugepages of DMA buffers are supported\n", MAX_HUGEPAGES);
+		linuxDeviceClose();
+		return 0;
+	}
+	dma_base = mmap(NULL, dma_bytes, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE | MAP_LOCKED, -1, 0);
+	if(dma_base == MAP_FAILED && fake_device) // the fake device does not need hugepages
+		dma_base = mmap(NULL, dma_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+	if(dma_base == MAP_FAILED)
+	{
+		fprintf(stderr, "Cannot allocate %zu bytes of hugepages (see /proc/sys/vm/nr_hugepages)\n", dma_bytes);
+		dma_base = NULL;
+		linuxDeviceClose();
+		return 0;
+	}
+
+	if(fake_device)
+	{
+		fake_errors = 0;
+		fake_brams = calloc(BRAM_CTRL_WINDOWS, BRAM_CTRL_WINDOW_BYTES);
+		if(!fake_brams)
+		{
+			linuxDeviceClose();
+			return 0;
+		}
+		// the hugepages of each pair are swapped, so buffers across hugepages
+		// are not physically contiguous as on a real system
+		for(uint32_t i = 0; i < dma_bytes/hugepage_bytes; ++i)
+			hugepage_phys[i] = FAKE_DDR_AXI_BASE + (uint64_t)fakePage(i)*hugepage_bytes;
+		axi_address_base[6] = 1;  // programs are done immediately
+		cdma_base[CDMASR/4] = 1<<1; // idle
+	}
+	else if(!resolveHugepages())
+	{
+		linuxDeviceClose();
+		return 0;
+	}
+	return 1;
+}
+
+// Unmaps the register windows and frees all DMA buffers.
+void linuxDeviceClose()
+{
+	if(axi_address_base)
+		munmap((void*)axi_address_base, LINUX_WINDOW_BYTES);
+	if(cdma_base)
+		munmap((void*)cdma_base, LINUX_WINDOW_BYTES);
+	if(dma_base)
+		munmap(dma_base, dma_bytes);
+	free(fake_brams);
+	dmaPoolReset();
+	axi_address_base = NULL;
+	cdma_base = NULL;
+	dma_base = NULL;
+	fake_brams = NULL;
+}
+
+// Returns 1 if the fake device is used.
+int linuxDeviceIsFake()
+{
+	return fake_device;
+}
+
+// Returns the number of transfers of the fake device with an AXI address
+// outside of the DMA buffers and BRAM windows.
+uint32_t linuxDeviceErrors()
+{
+	return fake_errors;
+}
+
+// Allocates num_bytes of DMA buffers (aligned to 32 KB). A buffer of up to a
+// hugepage is physically contiguous. A larger one (e.g., a contiguous
+// ciphertext) may span several hugepages and is transferred in chunks (see
+// linuxDmaContiguousBytes). The buffers are freed by linuxDeviceClose.
+// Returns NULL if the DMA buffers are exhausted.
+void* linuxDmaAlloc(size_t num_bytes)
+{
+	size_t start = (dma_used + DMA_ALIGNMENT - 1) / DMA_ALIGNMENT * DMA_ALIGNMENT;
+
+	// hugepages are not necessarily contiguous to each other
+	if(num_bytes <= hugepage_bytes && start / hugepage_bytes != (start + num_bytes - 1) / hugepage_bytes)
+		start = (start / hugepage_bytes + 1) * hugepage_bytes;
+	if(start + num_bytes > dma_bytes)
+		return NULL;
+	dma_used = start + num_bytes;
+	return dma_base + start;
+}
+
+// Returns 1 if the num_bytes from addr are inside the DMA buffers.
+static int isDmaBuffer(size_t addr, uint32_t num_bytes)
+{
+	return dma_base && addr >= (size_t)dma_base && addr - (size_t)dma_base + num_bytes <= dma_bytes;
+}
+
+// Returns how many of the num_bytes from the DMA buffer at addr are physically
+// contiguous, i.e., up to the first hugepage that does not physically follow
+// the previous one. Aborts the process if addr is not a DMA buffer.
+uint32_t linuxDmaContiguousBytes(size_t addr, uint32_t num_bytes)
+{
+	if(!isDmaBuffer(addr, num_bytes))
+	{
+		fprintf(stderr, "0x%zx (%u bytes) is not a DMA buffer (see linuxDmaAlloc)\n", addr, num_bytes);
+		abort();
+	}
+	size_t offset = addr - (size_t)dma_base;
+	size_t page = offset / hugepage_bytes;
+	size_t contiguous = hugepage_bytes - offset % hugepage_bytes;
+	while(contiguous < num_bytes && hugepage_phys[page + 1] == hugepage_phys[page] + hugepage_bytes)
+	{
+		contiguous += hugepage_bytes;
+		++page;
+	}
+	return contiguous < num_bytes ? (uint32_t)contiguous : num_bytes;
+}
+
+// Returns the AXI address of the DMA buffer at the virtual address addr. The
+// num_bytes from addr must be physically contiguous (see
+// linuxDmaContiguousBytes). Any other address would let the CDMA overwrite
+// arbitrary memory, hence the process is aborted.
+size_t linuxDmaAddress(size_t addr, uint32_t num_bytes)
+{
+	size_t offset = addr - (size_t)dma_base;
+
+	if(!isDmaBuffer(addr, num_bytes) || (num_bytes && linuxDmaContiguousBytes(addr, num_bytes) != num_bytes))
+	{
+		fprintf(stderr, "0x%zx (%u bytes) is not a contiguous DMA buffer (see linuxDmaAlloc)\n", addr, num_bytes);
+		abort();
+	}
+	return (size_t)(hugepage_phys[offset / hugepage_bytes] + offset % hugepage_bytes);
+}
+
+#if defined(__aarch64__)
+// Applies the data cache operation op ("cvac" or "civac") to every line of the
+// num_bytes from addr. Linux allows these operations at EL0.
+#define CACHE_RANGE_OP(op, addr, num_bytes) do { \
+		uint64_t ctr; \
+		__asm__ volatile("mrs %0, ctr_el0" : "=r"(ctr)); \
+		size_t line = 4 << ((ctr >> 16) & 0xf); \
+		for(size_t a = (addr) & ~(line - 1); a < (addr) + (num_bytes); a += line) \
+			__asm__ volatile("dc " op ", %0" : : "r"(a) : "memory"); \
+		__asm__ volatile("dsb sy" : : : "memory"); \
+	} while(0)
+#endif
+
+// Writes the dirty lines of the num_bytes from addr back to DDR before the
+// CDMA reads them (no-op on the fake device and without AArch64).
+void linuxCacheFlush(size_t addr, uint32_t num_bytes)
+{
+#if defined(__aarch64__)
+	if(!fake_device)
+		CACHE_RANGE_OP("cvac", addr, num_bytes);
+#else
+	(void)addr;
+	(void)num_bytes;
+#endif
+}
+
+// Invalidates the num_bytes from addr after the CDMA has written them.
+void linuxCacheInvalidate(size_t addr, uint32_t num_bytes)
+{
+#if defined(__aarch64__)
+	if(!fake_device)
+		CACHE_RANGE_OP("civac", addr, num_bytes);
+#else
+	(void)addr;
+	(void)num_bytes;
+#endif
+}
+
+// Returns the host pointer of the AXI address of the fake device or NULL if
+// the num_bytes from addr are neither in the DMA buffers (within one
+// hugepage) nor in a BRAM window.
+static uint8_t* fakeAddress(uint32_t addr, uint32_t num_bytes)
+{
+	if(addr >= BRAM_CTRL_AXI_BASE && addr - BRAM_CTRL_AXI_BASE + num_bytes <= BRAM_CTRL_WINDOWS*BRAM_CTRL_WINDOW_BYTES)
+		return fake_brams + (addr - BRAM_CTRL_AXI_BASE);
+	if(addr >= FAKE_DDR_AXI_BASE && addr - FAKE_DDR_AXI_BASE + num_bytes <= dma_bytes)
+	{
+		size_t offset = addr - FAKE_DDR_AXI_BASE;
+		if(offset % hugepage_bytes + num_bytes > hugepage_bytes)
+			return NULL;
+		return dma_base + fakePage(offset / hugepage_bytes)*hugepage_bytes + offset % hugepage_bytes;
+	}
+	return NULL;
+}
+
+uint32_t linuxCdmaRead(uint32_t reg)
+{
+	return cdma_base[reg/4];
+}
+
+// Writes a CDMA register. Writing CDMA_BTT starts the transfer; the fake
+// device copies the bytes right away and is idle again afterwards. Writes
+// redirected to the constants cache or the instruction memory
+// (control_high_word[10] or [11]) are checked but dropped, as the fake
+// device does not model these memories.
+void linuxCdmaWrite(uint32_t reg, uint32_t val)
+{
+	cdma_base[reg/4] = val;
+	if(fake_device && reg == CDMA_BTT)
+	{
+		uint8_t* dst = fakeAddress(cdma_base[CDMA_DA/4], val);
+		uint8_t* src = fakeAddress(cdma_base[CDMA_SA/4], val);
+		int redirected = (axi_address_base[1] & (3 << 10)) && cdma_base[CDMA_DA/4] >= BRAM_CTRL_AXI_BASE;
+		if(!dst || !src)
+		{
+			fprintf(stderr, "Fake CDMA: invalid transfer of %u bytes from 0x%x to 0x%x\n", val,
+					cdma_base[CDMA_SA/4], cdma_base[CDMA_DA/4]);
+			fake_errors++;
+		}
+		else if(!redirected)
+			memmove(dst, src, val);
+		cdma_base[CDMASR/4] = 1<<1;
+	}
+}
+
+#endif /* __linux__ */
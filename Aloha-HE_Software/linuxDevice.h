@@ -0,0 +1,30 @@
+#ifndef SRC_LINUX_DEVICE_H_
+#define SRC_LINUX_DEVICE_H_
+
+#ifdef __linux__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Default UIO devices of the AXI slave (AXISlave8Ports) and of the CDMA
+#define LINUX_REGS_DEVICE   "/dev/uio0"
+#define LINUX_CDMA_DEVICE   "/dev/uio1"
+
+int linuxDeviceOpen(const char* regs_path, const char* cdma_path, size_t dma_bytes);
+void linuxDeviceClose();
+int linuxDeviceIsFake();
+uint32_t linuxDeviceErrors();
+
+void* linuxDmaAlloc(size_t num_bytes);
+size_t linuxDmaAddress(size_t addr, uint32_t num_bytes);
+uint32_t linuxDmaContiguousBytes(size_t addr, uint32_t num_bytes);
+
+void linuxCacheFlush(size_t addr, uint32_t num_bytes);
+void linuxCacheInvalidate(size_t addr, uint32_t num_bytes);
+
+uint32_t linuxCdmaRead(uint32_t reg);
+void linuxCdmaWrite(uint32_t reg, uint32_t val);
+
+#endif /* __linux__ */
+
+#endif /* SRC_LINUX_DEVICE_H_ */
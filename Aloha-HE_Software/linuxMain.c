@@ -0,0 +1,319 @@
+/*********************************************
+ * Main file of the Linux userspace driver
+ * (see linuxDevice.c). It checks the DMA
+ * path and measures encode+encrypt and
+ * decrypt+decode with the driver API.
+ *
+ * Build: gcc -O2 -o alohaLinux linuxMain.c linuxDevice.c dmaPool.c
+ *            ciphertext.c communication.c instruction.c
+ *            ckksAccelerator.c fourStep.c
+ * Usage: alohaLinux [-r regs_uio] [-d cdma_uio] [-f]
+ *                   [-n log_n] [-m moduli] [-t trials]
+ *
+ * -r and -d select the UIO devices of the AXI
+ * slave and of the CDMA (/dev/uio0 and
+ * /dev/uio1 by default). -f runs on the fake
+ * device instead, with temporary files as
+ * register windows, so the driver can be
+ * tested on any Linux box (e.g., in CI).
+ *
+ * Each polynomial is DMA'd to the message and
+ * the key BRAM and back, and must be
+ * unchanged. Then encode+encrypt with 1..moduli
+ * moduli and decrypt+decode run trials times
+ * on buffers of the DMA pool (the latency of
+ * the fake device is the driver overhead
+ * only). Finally, a contiguous ciphertext
+ * (see ciphertext.h) with all moduli is
+ * encrypted, written to a file, read back
+ * into a DMA buffer and decrypted in place.
+ * A polynomial of N = 2^16 coefficients is
+ * transformed by the forward and the inverse
+ * four-step NTT and must be unchanged (not
+ * checked on the fake device, which does not
+ * compute).
+ * On the fake device, every DMA address must
+ * be in the DMA buffers or the BRAM windows,
+ * and c1 of each modulus is the DMA'd pk0
+ * residue.
+*********************************************/
+
+#ifdef __linux__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "communication.h"
+#include "ckksAccelerator.h"
+#include "linuxDevice.h"
+#include "dmaPool.h"
+#include "fourStep.h"
+
+#define MAX_MODULI      5
+#define COEFF_MASK      ((1ull << 54) - 1) // BRAM words of the modular ring BRAMs
+#define DMA_BYTES       (32 << 20)
+
+// Modulus of NTT ROM index 15 (log_q 8, qm 18) and the root of its four-step
+// NTT printed by Aloha-HE_Host/fourStepNtt -n 16 -t 15
+#define FOUR_STEP_QM    18
+#define FOUR_STEP_LOG_Q 8
+#define FOUR_STEP_ROM   15
+#define FOUR_STEP_PSI   0x3a2f83e80906f8ull
+
+static double elapsedUs(const struct timespec* start, const struct timespec* end)
+{
+	return (end->tv_sec - start->tv_sec)*1e6 + (end->tv_nsec - start->tv_nsec)*1e-3;
+}
+
+// Creates an empty temporary file as register window of the fake device.
+static int fakeWindow(char* path)
+{
+	strcpy(path, "/tmp/alohaLinuxXXXXXX");
+	int fd = mkstemp(path);
+	if(fd < 0)
+		return 0;
+	close(fd);
+	return 1;
+}
+
+// DMAs a polynomial to the BRAM bram_id and back, returns 1 if it is unchanged.
+static int loopback(uint32_t bram_id, uint64_t* src, uint64_t* dst, uint8_t current_n)
+{
+	uint32_t poly_size = 1<<(13+current_n);
+
+	for(uint32_t i = 0; i < poly_size; ++i)
+	{
+		src[i] = ((i + 1) * 0x9E3779B97F4A7C15ull + bram_id) & COEFF_MASK;
+		dst[i] = 0;
+	}
+	cdmaDDRtoBRAM(bram_id, (size_t)src, poly_size*sizeof(uint64_t), current_n);
+	cdmaWaitForIdle();
+	cdmaBRAMtoDDR((size_t)dst, bram_id, poly_size*sizeof(uint64_t));
+	cdmaWaitForIdle();
+	return !memcmp(src, dst, poly_size*sizeof(uint64_t));
+}
+
+// Encrypts into a contiguous ciphertext, writes it to a temporary file, reads
+// it back into another DMA buffer and decrypts it in place. Returns 1 if the
+// ciphertext is unchanged (and, on the fake device, c1 of each modulus is the
+// pk0 residue).
+static int contiguousCiphertext(uint64_t* plaintext, uint64_t* sk, uint64_t** pk0, uint8_t current_n,
+								uint32_t num_moduli, uint32_t* qm, uint32_t* log_q, int32_t log_scale)
+{
+	uint64_t pk1_seeds[MAX_MODULI] = {1, 2, 3, 4, 5};
+	uint32_t rom_indices[MAX_MODULI] = {0, 1, 2, 3, 4};
+	uint32_t poly_size = 1<<(13+current_n);
+	size_t num_bytes = ctBytes(13+current_n, num_moduli);
+	void* buffers[2] = {linuxDmaAlloc(num_bytes), linuxDmaAlloc(num_bytes)};
+	char path[32];
+	int ok;
+
+	if(!buffers[0] || !buffers[1] || !fakeWindow(path))
+	{
+		fprintf(stderr, "Cannot allocate the contiguous ciphertexts\n");
+		return 0;
+	}
+	for(uint32_t i = 0; i < num_moduli; ++i)
+		for(uint32_t j = 0; j < poly_size; ++j)
+			pk0[i][j] = ((j + 1) * 0x9E3779B97F4A7C15ull + i) & COEFF_MASK;
+
+	CtHeader* ct = ctInit(buffers[0], 13+current_n, num_moduli, qm, log_q, log_scale);
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ckks_encrypt_ct(ct, plaintext, 0, pk1_seeds, rom_indices, rom_indices, pk0);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	int fd = open(path, O_RDWR);
+	unlink(path);
+	ok = fd >= 0 && ctWrite(ct, fd) && lseek(fd, 0, SEEK_SET) == 0;
+	const CtHeader* read_ct = ok ? ctRead(fd, buffers[1], num_bytes) : NULL;
+	if(fd >= 0)
+		close(fd);
+	ok = read_ct && !memcmp(ct, read_ct, num_bytes);
+	if(ok)
+		ckks_decrypt_ct(read_ct, sk, plaintext, rom_indices[0]);
+	if(ok && linuxDeviceIsFake())
+		for(uint32_t i = 0; i < num_moduli; ++i)
+			ok &= !memcmp(ctC1(ct, i), pk0[i], poly_size*sizeof(uint64_t));
+	printf("Contiguous ciphertext of %u moduli (%zu bytes, encrypt_us %.1f): %s\n", num_moduli, num_bytes,
+		   elapsedUs(&start, &end), ok ? "ok" : "FAILED");
+	return ok;
+}
+
+// Runs the forward and the inverse four-step NTT of N = 2^16 on a DMA buffer
+// and returns 1 if the polynomial is unchanged. The fake device does not
+// compute PWMs and NTTs, so there it only checks that the transforms run with
+// valid DMAs and that a root whose square is not the ROM root is rejected
+// (Aloha-HE_Host/fourStepNtt checks the values of the same dataflow).
+static int fourStepRoundtrip()
+{
+	uint32_t n = 1u << FOUR_STEP_LOG_N;
+	uint64_t q = (1ull << (46+FOUR_STEP_LOG_Q)) - ((uint64_t)FOUR_STEP_QM << 24) + 1;
+	uint64_t* poly = dmaPoolAlloc(n);
+	uint64_t* expected = malloc(n*sizeof(uint64_t));
+	uint64_t* twiddles[FOUR_STEP_TWIDDLE_POLYS];
+	uint32_t errors = linuxDeviceErrors();
+	struct timespec start, end, twiddles_end;
+	int ok = poly && expected;
+
+	for(uint32_t i = 0; i < FOUR_STEP_TWIDDLE_POLYS; ++i)
+		ok &= (twiddles[i] = dmaPoolAlloc(FOUR_STEP_TILE_SIZE)) != NULL;
+	if(!ok)
+	{
+		fprintf(stderr, "Cannot allocate the four-step NTT buffers\n");
+		free(expected);
+		return 0;
+	}
+	for(uint32_t i = 0; i < n; ++i)
+		expected[i] = poly[i] = ((i + 1) * 0x9E3779B97F4A7C15ull) % q;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ckks_four_step_twiddles(twiddles, FOUR_STEP_PSI, FOUR_STEP_QM, FOUR_STEP_LOG_Q);
+	clock_gettime(CLOCK_MONOTONIC, &twiddles_end);
+	ok = ckks_ntt_four_step(poly, 0, FOUR_STEP_QM, FOUR_STEP_LOG_Q, FOUR_STEP_ROM, FOUR_STEP_PSI, twiddles);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	ok = ok && ckks_ntt_four_step(poly, 1, FOUR_STEP_QM, FOUR_STEP_LOG_Q, FOUR_STEP_ROM, FOUR_STEP_PSI, twiddles);
+	// psi^3 is a primitive 2^17-th root as well, but psi^6 is not the ROM root
+	ok = ok && !ckks_ntt_four_step(poly, 0, FOUR_STEP_QM, FOUR_STEP_LOG_Q, FOUR_STEP_ROM,
+								   (uint64_t)((unsigned __int128)FOUR_STEP_PSI * FOUR_STEP_PSI % q * FOUR_STEP_PSI % q),
+								   twiddles);
+	if(linuxDeviceIsFake())
+		ok = ok && linuxDeviceErrors() == errors;
+	else
+		ok = ok && !memcmp(poly, expected, n*sizeof(uint64_t));
+	printf("Four-step NTT of N = 2^%u (twiddles_us %.1f, forward_us %.1f): %s%s\n", FOUR_STEP_LOG_N,
+		   elapsedUs(&start, &twiddles_end), elapsedUs(&twiddles_end, &end), ok ? "ok" : "FAILED",
+		   linuxDeviceIsFake() ? " (values not computed by the fake device)" : "");
+	for(uint32_t i = 0; i < FOUR_STEP_TWIDDLE_POLYS; ++i)
+		dmaPoolFree(twiddles[i], FOUR_STEP_TILE_SIZE);
+	dmaPoolFree(poly, n);
+	free(expected);
+	return ok;
+}
+
+int main(int argc, char** argv)
+{
+	const char* regs_path = LINUX_REGS_DEVICE;
+	const char* cdma_path = LINUX_CDMA_DEVICE;
+	char fake_regs[32], fake_cdma[32];
+	uint32_t log_n = 15, max_moduli = MAX_MODULI, trials = 100;
+	int fake = 0, failed = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-r") && i + 1 < argc)
+			regs_path = argv[++i];
+		else if(!strcmp(argv[i], "-d") && i + 1 < argc)
+			cdma_path = argv[++i];
+		else if(!strcmp(argv[i], "-f"))
+			fake = 1;
+		else if(!strcmp(argv[i], "-n") && i + 1 < argc)
+			log_n = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-m") && i + 1 < argc)
+			max_moduli = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-t") && i + 1 < argc)
+			trials = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: %s [-r regs_uio] [-d cdma_uio] [-f] [-n log_n] [-m moduli] [-t trials]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(log_n < 13 || log_n > 15 || max_moduli < 1 || max_moduli > MAX_MODULI || !trials)
+	{
+		fprintf(stderr, "log_n must be in [13, 15], moduli in [1, %u] and trials positive\n", MAX_MODULI);
+		return 1;
+	}
+	if(fake)
+	{
+		if(!fakeWindow(fake_regs) || !fakeWindow(fake_cdma))
+		{
+			fprintf(stderr, "Cannot create the register windows of the fake device\n");
+			return 1;
+		}
+		regs_path = fake_regs;
+		cdma_path = fake_cdma;
+	}
+	int opened = linuxDeviceOpen(regs_path, cdma_path, DMA_BYTES);
+	if(fake)
+	{
+		unlink(fake_regs);
+		unlink(fake_cdma);
+	}
+	if(!opened)
+		return 1;
+
+	uint8_t current_n = log_n - 13;
+	uint32_t poly_size = 1<<log_n;
+	uint64_t* plaintext = dmaPolyAlloc(current_n);
+	uint64_t* sk = dmaPolyAlloc(current_n);
+	uint64_t *c0[MAX_MODULI], *c1[MAX_MODULI], *pk0[MAX_MODULI];
+	int allocated = plaintext && sk;
+	for(uint32_t i = 0; i < MAX_MODULI; ++i)
+	{
+		c0[i] = dmaPolyAlloc(current_n);
+		c1[i] = dmaPolyAlloc(current_n);
+		pk0[i] = dmaPolyAlloc(current_n);
+		allocated &= c0[i] && c1[i] && pk0[i];
+	}
+	if(!allocated)
+	{
+		fprintf(stderr, "Not enough DMA buffers\n");
+		linuxDeviceClose();
+		return 1;
+	}
+	// as in benchmark.c: the latency does not depend on the operand values
+	uint64_t pk1_seeds[MAX_MODULI] = {1, 2, 3, 4, 5};
+	uint32_t rom_indices[MAX_MODULI] = {0, 1, 2, 3, 4};
+	uint32_t qm[MAX_MODULI] = {1, 2, 3, 4, 5};
+	uint32_t log_q[MAX_MODULI] = {8, 8, 8, 8, 8};
+	const int32_t log_scale = 40;
+
+	printf("%s device, N = 2^%u, %u trials\n", linuxDeviceIsFake() ? "Fake" : "UIO", log_n, trials);
+	ckks_init(current_n);
+	for(uint32_t i = 0; i < 2; ++i)
+	{
+		uint32_t bram_id = i ? NTT_KEY_BRAM_ID : NTT_MSG_BRAM_ID;
+		int ok = loopback(bram_id, c0[0], c1[0], current_n);
+		failed += !ok;
+		printf("DMA loopback of the %s BRAM: %s\n", i ? "key" : "message", ok ? "ok" : "FAILED");
+	}
+
+	memset(plaintext, 0, poly_size*sizeof(uint64_t));
+	memset(sk, 0, poly_size*sizeof(uint64_t));
+	printf("%7s %14s\n", "moduli", "encrypt_us");
+	for(uint32_t num_moduli = 1; num_moduli <= max_moduli; ++num_moduli)
+	{
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for(uint32_t t = 0; t < trials; ++t)
+			ckks_encrypt(c0, c1, plaintext, poly_size, 0, pk1_seeds, num_moduli, rom_indices, rom_indices, pk0,
+						 log_scale, qm, log_q);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		printf("%7u %14.1f\n", num_moduli, elapsedUs(&start, &end)/trials);
+	}
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(uint32_t t = 0; t < trials; ++t)
+		ckks_decrypt(c0[0], c1[0], sk, plaintext, poly_size, qm[0], log_q[0], rom_indices[0], -log_scale);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	printf("decrypt_us %.1f\n", elapsedUs(&start, &end)/trials);
+
+	failed += !contiguousCiphertext(plaintext, sk, pk0, current_n, max_moduli, qm, log_q, log_scale);
+	failed += !fourStepRoundtrip();
+
+	if(linuxDeviceIsFake())
+	{
+		printf("Fake device: %u invalid DMA transfers\n", linuxDeviceErrors());
+		failed += linuxDeviceErrors() != 0;
+	}
+	linuxDeviceClose();
+	printf("%s\n", failed ? "FAILED" : "ok");
+	return failed != 0;
+}
+
+#endif /* __linux__ */
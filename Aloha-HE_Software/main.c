@@ -12,6 +12,7 @@
 #include "ckksAccelerator.h"
 #include "communication.h"
 #include "Testing/ckksTest.h"
+#include "Testing/benchmark.h"
 #include "xtime_l.h"
 
 volatile uint32_t* axi_address_base;
@@ -35,7 +36,7 @@ int main()
 	printf("******************************************************************\n");
 
 
-  printf("Type of test [0: Run Demo, 1: Test, 2: Time check, 3:End] : ");
+  printf("Type of test [0: Run Demo, 1: Test, 2: Time check, 3:End, 4: Benchmark] : ");
   scanf("%d", &test_type);
   printf("\n");
 
@@ -47,10 +48,12 @@ int main()
 			test_hardware();
     else if(test_type == 2)
 			test_timing();
+		else if(test_type == 4)
+			benchmark();
 		else
 			break;
 
-		printf("Type of test [0: Run Demo, 1: Test, 2: Time check, 3:End] : ");
+		printf("Type of test [0: Run Demo, 1: Test, 2: Time check, 3:End, 4: Benchmark] : ");
 		scanf("%d", &test_type);
     printf("\n");
 	}